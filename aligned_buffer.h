@@ -0,0 +1,78 @@
+/**
+ * Aligned Buffer
+ * Cache-line aligned storage for design matrices and kernel workspaces
+ */
+
+#ifndef ALIGNED_BUFFER_H
+#define ALIGNED_BUFFER_H
+
+#include <cstdlib>
+#include <cstddef>
+#include <cstring>
+#include <new>
+
+const size_t CACHE_LINE_BYTES = 64;
+
+// Array of trivially copyable T starting on a cache-line boundary.
+// resize() does not preserve contents.
+template <typename T>
+class AlignedBuffer {
+private:
+    T* ptr;
+    size_t count;
+
+public:
+    AlignedBuffer() : ptr(0), count(0) {}
+    explicit AlignedBuffer(size_t n) : ptr(0), count(0) { resize(n); }
+    ~AlignedBuffer() { std::free(ptr); }
+
+    AlignedBuffer(const AlignedBuffer& other) : ptr(0), count(0) {
+        resize(other.count);
+        if (count) std::memcpy(ptr, other.ptr, count * sizeof(T));
+    }
+
+    AlignedBuffer& operator=(const AlignedBuffer& other) {
+        if (this != &other) {
+            resize(other.count);
+            if (count) std::memcpy(ptr, other.ptr, count * sizeof(T));
+        }
+        return *this;
+    }
+
+    AlignedBuffer(AlignedBuffer&& other) noexcept : ptr(other.ptr), count(other.count) {
+        other.ptr = 0;
+        other.count = 0;
+    }
+
+    AlignedBuffer& operator=(AlignedBuffer&& other) noexcept {
+        if (this != &other) {
+            std::free(ptr);
+            ptr = other.ptr;
+            count = other.count;
+            other.ptr = 0;
+            other.count = 0;
+        }
+        return *this;
+    }
+
+    void resize(size_t n) {
+        if (n == count) return;
+        std::free(ptr);
+        ptr = 0;
+        count = 0;
+        if (n == 0) return;
+        void* mem = 0;
+        if (posix_memalign(&mem, CACHE_LINE_BYTES, n * sizeof(T)) != 0) throw std::bad_alloc();
+        ptr = static_cast<T*>(mem);
+        count = n;
+    }
+
+    T* data() { return ptr; }
+    const T* data() const { return ptr; }
+    size_t size() const { return count; }
+    bool empty() const { return count == 0; }
+    T& operator[](size_t i) { return ptr[i]; }
+    const T& operator[](size_t i) const { return ptr[i]; }
+};
+
+#endif
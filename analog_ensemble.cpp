@@ -0,0 +1,184 @@
+/**
+ * Analog Ensemble Driver
+ * Indexes decades of encoded solar days from many sites, then forecasts
+ * held-out days from their nearest analogs: query latency and recall per
+ * probe count, and P10/P50/P90 skill against persistence. Held-out days are
+ * queried with simulateWeather() forecasts, not their recorded weather.
+ *
+ * Usage: ./analog_ensemble [sites] [years] [--threads n]
+ */
+
+#include <iostream>
+#include <iomanip>
+#include <chrono>
+#include <vector>
+#include <string>
+#include <cmath>
+#include <cstdlib>
+#include <algorithm>
+
+#include "energy_data.h"
+#include "analog_ensemble.h"
+#include "forecast_service.h"
+#include "aligned_buffer.h"
+#include "thread_pool.h"
+
+using namespace std;
+
+const int QUERY_SITES = 2;
+const int QUERY_DAYS = 365;
+
+double elapsedMs(chrono::steady_clock::time_point start) {
+    return chrono::duration<double, milli>(chrono::steady_clock::now() - start).count();
+}
+
+// Encoded days and outcomes of `sites` synthetic solar histories; with
+// forecast_weather each day is encoded as a query, from the weather forecast
+// issued for it instead of the weather that was recorded
+struct EncodedDays {
+    AlignedBuffer<float> vectors;               // [day][ANALOG_DIM]
+    vector<float> outcomes;                     // [day][ANALOG_HORIZON]
+    vector<float> persistence;                  // previous day's profile
+    size_t count;
+};
+
+void encodeSites(ThreadPool& pool, const AnalogEncoder& encoder, int sites, int days, unsigned seed,
+                 bool forecast_weather, EncodedDays& out) {
+    size_t first = encoder.firstDay(), per_site = days - first;
+    out.count = per_site * sites;
+    out.vectors.resize(out.count * ANALOG_DIM);
+    out.outcomes.resize(out.count * ANALOG_HORIZON);
+    out.persistence.resize(out.count * ANALOG_HORIZON);
+    pool.parallelFor(sites, 1, [&](size_t begin, size_t end, size_t) {
+        for (size_t s = begin; s < end; s++) {
+            EnergyHistory h = generateSyntheticHistory(days, seed + (unsigned)s);
+            for (size_t d = first; d < (size_t)days; d++) {
+                size_t row = s * per_site + (d - first);
+                float* vector = &out.vectors[row * ANALOG_DIM];
+                if (forecast_weather) {
+                    size_t t0 = d * 24;
+                    WeatherForecast w = simulateWeather((int)(seed + s), h.hour_of_day[t0], h.day_of_year[t0]);
+                    WeatherColumns cols = { &w.hour_of_day[0], &w.day_of_year[0], &w.temperature[0],
+                                            &w.cloud_cover[0], &w.wind_speed[0], (size_t)FORECAST_HOURS };
+                    encoder.encode(h.solar_capacity, d, cols, vector);
+                } else {
+                    encoder.encode(h, h.solar_capacity, d, vector);
+                }
+                for (int k = 0; k < ANALOG_HORIZON; k++) {
+                    out.outcomes[row * ANALOG_HORIZON + k] = (float)h.solar_capacity[d * 24 + k];
+                    out.persistence[row * ANALOG_HORIZON + k] = (float)h.solar_capacity[d * 24 - 24 + k];
+                }
+            }
+        }
+    });
+}
+
+int main(int argc, char** argv) {
+    int n_sites = 20, years = 25;
+    int n_threads = 0;
+    int positional = 0;
+    for (int i = 1; i < argc; i++) {
+        string arg = argv[i];
+        if (arg == "--threads" && i + 1 < argc) n_threads = atoi(argv[++i]);
+        else if (arg[0] != '-' && positional == 0) { n_sites = max(1, atoi(argv[i])); positional++; }
+        else if (arg[0] != '-' && positional == 1) { years = max(1, atoi(argv[i])); positional++; }
+        else {
+            cerr << "Usage: " << argv[0] << " [sites] [years] [--threads n]" << endl;
+            return 1;
+        }
+    }
+
+    cout << "========================================" << endl;
+    cout << "ANALOG ENSEMBLE FORECASTS" << endl;
+#ifdef ANALOG_ENSEMBLE_AVX2
+    cout << "IVF index, AVX2 distances" << endl;
+#else
+    cout << "IVF index, scalar distances" << endl;
+#endif
+    cout << "========================================" << endl;
+
+    ThreadPool pool(n_threads > 0 ? n_threads : 0);
+    AnalogConfig config = defaultAnalogConfig();
+    AnalogEncoder encoder(config);
+
+    EncodedDays history, queries;
+    auto start = chrono::steady_clock::now();
+    encodeSites(pool, encoder, n_sites, years * 365, 100, false, history);
+    encodeSites(pool, encoder, QUERY_SITES, QUERY_DAYS, 9000, true, queries);
+    cout << "\n[1] " << history.count << " indexed days (" << n_sites << " sites x " << years << " years), "
+         << queries.count << " held-out query days (forecast weather)" << endl;
+    cout << "  Generated and encoded in " << fixed << setprecision(1) << elapsedMs(start) / 1000.0 << " s ("
+         << ANALOG_DIM << " floats per day)" << endl;
+
+    AnalogIndex index(config);
+    start = chrono::steady_clock::now();
+    index.build(pool, history.vectors.data(), &history.outcomes[0], history.count);
+    size_t largest = 0;
+    for (size_t l = 0; l < index.listCount(); l++) largest = max(largest, index.listSize(l));
+    cout << "\n[2] Index: " << index.listCount() << " lists (largest " << largest << " days), built in "
+         << setprecision(0) << elapsedMs(start) << " ms on " << pool.size() << " threads" << endl;
+
+    // Exact neighbours for recall
+    int k = config.neighbours;
+    vector<vector<pair<float, uint32_t> > > exact(queries.count);
+    start = chrono::steady_clock::now();
+    for (size_t q = 0; q < queries.count; q++) exact[q] = index.search(&queries.vectors[q * ANALOG_DIM], k, 0);
+    double exact_us = elapsedMs(start) * 1000.0 / queries.count;
+
+    cout << "\n[3] Query latency and recall@" << k << endl;
+    cout << "-----------------------------------" << endl;
+    cout << "  Probes     Mean (us)    p99 (us)    Recall" << endl;
+    int probe_counts[5] = { 1, 4, 8, 16, 32 };
+    vector<double> latency(queries.count);
+    for (int c = 0; c < 5; c++) {
+        double hits = 0.0;
+        for (size_t q = 0; q < queries.count; q++) {
+            auto t = chrono::steady_clock::now();
+            vector<pair<float, uint32_t> > found = index.search(&queries.vectors[q * ANALOG_DIM], k,
+                                                                probe_counts[c]);
+            latency[q] = elapsedMs(t) * 1000.0;
+            for (size_t j = 0; j < found.size(); j++) {
+                for (size_t e = 0; e < exact[q].size(); e++) hits += found[j].second == exact[q][e].second;
+            }
+        }
+        double mean = 0.0;
+        for (size_t q = 0; q < queries.count; q++) mean += latency[q] / queries.count;
+        sort(latency.begin(), latency.end());
+        cout << "  " << setw(6) << probe_counts[c] << setprecision(1) << setw(14) << mean << setw(12)
+             << latency[(size_t)(0.99 * (queries.count - 1))] << setprecision(3) << setw(10)
+             << hits / ((double)queries.count * k) << endl;
+    }
+    cout << "  Exact" << setprecision(1) << setw(15) << exact_us << endl;
+
+    // Ensemble skill on the held-out days
+    double mae = 0.0, persistence = 0.0, covered = 0.0, width = 0.0;
+    size_t scored = 0;
+    AnalogForecast f;
+    start = chrono::steady_clock::now();
+    for (size_t q = 0; q < queries.count; q++) {
+        if (!index.forecast(&queries.vectors[q * ANALOG_DIM], f)) continue;
+        scored++;
+        for (int h = 0; h < ANALOG_HORIZON; h++) {
+            double y = queries.outcomes[q * ANALOG_HORIZON + h];
+            mae += fabs(f.p50[h] - y);
+            persistence += fabs(queries.persistence[q * ANALOG_HORIZON + h] - y);
+            covered += y >= f.p10[h] && y <= f.p90[h];
+            width += f.p90[h] - f.p10[h];
+        }
+    }
+    double forecast_us = elapsedMs(start) * 1000.0 / queries.count;
+    double points = (double)scored * ANALOG_HORIZON;
+    cout << "\n[4] Next-day solar from " << k << " analogs (" << config.probes << " probes, " << setprecision(1)
+         << forecast_us << " us per forecast)" << endl;
+    cout << "-----------------------------------" << endl;
+    cout << setprecision(4) << "  P50 MAE " << mae / points << "  (persistence " << persistence / points << ")"
+         << endl;
+    cout << setprecision(1) << "  P10-P90 coverage " << 100.0 * covered / points << "%, mean width "
+         << setprecision(3) << width / points << endl;
+
+    cout << "\n========================================" << endl;
+    cout << "ANALYSIS COMPLETE" << endl;
+    cout << "========================================" << endl;
+
+    return 0;
+}
@@ -0,0 +1,336 @@
+/**
+ * Analog Ensemble
+ * Forecasts a day from the outcomes of the most similar past days
+ *
+ * Every historical day is encoded as a fixed-length float vector:
+ *   - the target's profile over the previous 24 hours,
+ *   - the day's weather as 3-hour means of cloud cover, wind speed and
+ *     temperature (recorded for indexed days; a query passes the weather
+ *     forecast issued for its day, e.g. simulateWeather()),
+ *   - the dominant frequencies and amplitudes that FourierTransform finds in
+ *     the trailing spectral_window hours,
+ * each group scaled by its weight and zero-padded to ANALOG_DIM floats. The
+ * day's own 24 hourly values are stored as its outcome.
+ *
+ * The index is an inverted file (IVF): k-means splits the vectors into
+ * about sqrt(N) lists stored contiguously, and a query scans only the lists
+ * of its `probes` nearest centroids, with AVX2 squared-L2 distances when
+ * available. The k nearest analogs' outcomes give an empirical P10/P50/P90
+ * per hour.
+ */
+
+#ifndef ANALOG_ENSEMBLE_H
+#define ANALOG_ENSEMBLE_H
+
+#include <vector>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <utility>
+#include <stdexcept>
+#include <algorithm>
+
+#include "aligned_buffer.h"
+#include "energy_data.h"
+#include "feature_builder.h"
+#include "fourier_transform.h"
+#include "thread_pool.h"
+
+#if defined(__AVX2__) && defined(__FMA__)
+#include <immintrin.h>
+#define ANALOG_ENSEMBLE_AVX2 1
+#endif
+
+const int ANALOG_DIM = 64;                      // floats per encoded day (one cache line pair)
+const int ANALOG_HORIZON = 24;                  // outcome hours per day
+const int ANALOG_WEATHER_BLOCKS = 8;            // 3-hour weather means
+const int ANALOG_MAX_PEAKS = 8;
+
+struct AnalogConfig {
+    double profile_weight, weather_weight, spectral_weight;
+    int spectral_window;                        // hours before the day given to FourierTransform
+    int spectral_peaks;                         // dominant frequencies kept, <= ANALOG_MAX_PEAKS
+    int lists;                                  // IVF lists; 0 = sqrt(days)
+    int probes;                                 // lists scanned per query
+    int neighbours;                             // analogs per forecast
+    int kmeans_iterations;
+    int training_per_list;                      // k-means sample size per list
+};
+
+inline AnalogConfig defaultAnalogConfig() {
+    AnalogConfig c = { 1.0, 1.0, 0.5, 128, 4, 0, 16, 25, 8, 64 };
+    return c;
+}
+
+struct AnalogForecast {
+    double p10[ANALOG_HORIZON], p50[ANALOG_HORIZON], p90[ANALOG_HORIZON];
+};
+
+// Squared Euclidean distance between two ANALOG_DIM vectors (32-byte aligned)
+inline float analogDistance(const float* a, const float* b) {
+#ifdef ANALOG_ENSEMBLE_AVX2
+    __m256 acc0 = _mm256_setzero_ps(), acc1 = _mm256_setzero_ps();
+    for (int i = 0; i < ANALOG_DIM; i += 16) {
+        __m256 d0 = _mm256_sub_ps(_mm256_load_ps(a + i), _mm256_load_ps(b + i));
+        __m256 d1 = _mm256_sub_ps(_mm256_load_ps(a + i + 8), _mm256_load_ps(b + i + 8));
+        acc0 = _mm256_fmadd_ps(d0, d0, acc0);
+        acc1 = _mm256_fmadd_ps(d1, d1, acc1);
+    }
+    __m256 acc = _mm256_add_ps(acc0, acc1);
+    __m128 s = _mm_add_ps(_mm256_castps256_ps128(acc), _mm256_extractf128_ps(acc, 1));
+    s = _mm_add_ps(s, _mm_movehl_ps(s, s));
+    s = _mm_add_ss(s, _mm_movehdup_ps(s));
+    return _mm_cvtss_f32(s);
+#else
+    float sum = 0.0f;
+    for (int i = 0; i < ANALOG_DIM; i++) sum += (a[i] - b[i]) * (a[i] - b[i]);
+    return sum;
+#endif
+}
+
+class AnalogEncoder {
+private:
+    AnalogConfig config;
+
+public:
+    explicit AnalogEncoder(const AnalogConfig& c = defaultAnalogConfig()) : config(c) {
+        if (c.spectral_window < 24 || c.spectral_peaks < 0 || c.spectral_peaks > ANALOG_MAX_PEAKS) {
+            throw std::invalid_argument("AnalogEncoder: spectral_window >= 24, spectral_peaks <= ANALOG_MAX_PEAKS");
+        }
+    }
+
+    // First day with a full previous day and spectral window
+    size_t firstDay() const { return (size_t)(std::max(24, config.spectral_window) + 23) / 24; }
+
+    // Encode day `day` of h for the hourly target series (h.solar_capacity or
+    // h.wind_capacity) with the day's recorded weather, as stored in the
+    // index; out holds ANALOG_DIM floats. False before firstDay() or past the
+    // end of the history.
+    bool encode(const EnergyHistory& h, const std::vector<double>& target, size_t day, float* out) const {
+        size_t start = day * 24;
+        if (start + 24 > h.size() || target.size() < start + 24) return false;
+        WeatherColumns recorded = weatherColumns(h);
+        recorded.hour_of_day += start;
+        recorded.day_of_year += start;
+        recorded.temperature += start;
+        recorded.cloud_cover += start;
+        recorded.wind_speed += start;
+        recorded.n = 24;
+        return encode(target, day, recorded, out);
+    }
+
+    // Encode a query for day `day` of the target series, which needs only the
+    // hours before it, with `weather` (at least 24 hours from the day's start)
+    // in place of the unknown recorded weather
+    bool encode(const std::vector<double>& target, size_t day, const WeatherColumns& weather, float* out) const {
+        size_t start = day * 24;
+        if (day < firstDay() || weather.n < 24 || target.size() < start) return false;
+        std::fill(out, out + ANALOG_DIM, 0.0f);
+        int c = 0;
+
+        for (int k = 0; k < 24; k++) out[c++] = (float)(config.profile_weight * target[start - 24 + k]);
+
+        for (int b = 0; b < ANALOG_WEATHER_BLOCKS; b++) {
+            double cloud = 0.0, wind = 0.0, temperature = 0.0;
+            for (int k = 0; k < 3; k++) {
+                size_t i = 3 * b + k;
+                cloud += weather.cloud_cover[i] / 3.0;
+                wind += weather.wind_speed[i] / 30.0;
+                temperature += weather.temperature[i] / 120.0;
+            }
+            out[c++] = (float)(config.weather_weight * cloud);
+            out[c++] = (float)(config.weather_weight * wind);
+            out[c++] = (float)(config.weather_weight * temperature);
+        }
+
+        // Mean-removed trailing window; peaks as (cycles per sample x 2, amplitude)
+        size_t n = (size_t)config.spectral_window;
+        std::vector<double> window(target.begin() + (start - n), target.begin() + start);
+        double mean = 0.0;
+        for (size_t i = 0; i < n; i++) mean += window[i] / n;
+        for (size_t i = 0; i < n; i++) window[i] -= mean;
+        FourierTransform ft(window);
+        ft.compute();
+        std::vector<std::pair<int, double> > peaks = ft.getDominantFrequencies(config.spectral_peaks);
+        size_t padded = 1;
+        while (padded < n) padded *= 2;
+        for (size_t j = 0; j < peaks.size(); j++) {
+            out[c++] = (float)(config.spectral_weight * 2.0 * peaks[j].first / padded);
+            out[c++] = (float)(config.spectral_weight * 2.0 * peaks[j].second / n);
+        }
+        return true;
+    }
+};
+
+class AnalogIndex {
+private:
+    AnalogConfig config;
+    size_t count, list_count;
+    AlignedBuffer<float> centroids;             // [list][ANALOG_DIM]
+    AlignedBuffer<float> vectors;               // [position][ANALOG_DIM], grouped by list
+    std::vector<float> outcomes;                // [position][ANALOG_HORIZON]
+    std::vector<uint32_t> ids;                  // position -> caller's day index
+    std::vector<size_t> offsets;                // list -> first position, plus the end
+
+    size_t nearestCentroid(const float* v) const {
+        size_t best = 0;
+        float best_d = std::numeric_limits<float>::infinity();
+        for (size_t l = 0; l < list_count; l++) {
+            float d = analogDistance(v, &centroids[l * ANALOG_DIM]);
+            if (d < best_d) {
+                best_d = d;
+                best = l;
+            }
+        }
+        return best;
+    }
+
+    // Nearest centroid of each vector
+    void assign(ThreadPool& pool, const float* data, size_t n, std::vector<uint32_t>& label) const {
+        label.resize(n);
+        pool.parallelFor(n, 256, [&](size_t begin, size_t end, size_t) {
+            for (size_t i = begin; i < end; i++) label[i] = (uint32_t)nearestCentroid(data + i * ANALOG_DIM);
+        });
+    }
+
+    void train(ThreadPool& pool, const float* data, size_t n) {
+        size_t samples = std::min(n, list_count * (size_t)config.training_per_list);
+        AlignedBuffer<float> sample(samples * ANALOG_DIM);
+        for (size_t s = 0; s < samples; s++) {
+            const float* v = data + (s * n / samples) * ANALOG_DIM;
+            std::copy(v, v + ANALOG_DIM, &sample[s * ANALOG_DIM]);
+        }
+        // Initial centroids spread evenly over the sample
+        centroids.resize(list_count * ANALOG_DIM);
+        for (size_t l = 0; l < list_count; l++) {
+            const float* v = &sample[(l * samples / list_count) * ANALOG_DIM];
+            std::copy(v, v + ANALOG_DIM, &centroids[l * ANALOG_DIM]);
+        }
+        // Serial sums, so the centroids do not depend on the thread count
+        std::vector<uint32_t> label;
+        std::vector<double> sum(list_count * ANALOG_DIM);
+        std::vector<size_t> members(list_count);
+        for (int it = 0; it < config.kmeans_iterations; it++) {
+            assign(pool, sample.data(), samples, label);
+            std::fill(sum.begin(), sum.end(), 0.0);
+            std::fill(members.begin(), members.end(), 0);
+            for (size_t s = 0; s < samples; s++) {
+                members[label[s]]++;
+                for (int d = 0; d < ANALOG_DIM; d++) sum[label[s] * ANALOG_DIM + d] += sample[s * ANALOG_DIM + d];
+            }
+            // An empty list keeps its centroid
+            for (size_t l = 0; l < list_count; l++) {
+                if (members[l] == 0) continue;
+                for (int d = 0; d < ANALOG_DIM; d++) {
+                    centroids[l * ANALOG_DIM + d] = (float)(sum[l * ANALOG_DIM + d] / members[l]);
+                }
+            }
+        }
+    }
+
+public:
+    explicit AnalogIndex(const AnalogConfig& c = defaultAnalogConfig()) : config(c), count(0), list_count(0) {
+        if (c.lists < 0 || c.probes < 1 || c.neighbours < 1 || c.kmeans_iterations < 0 || c.training_per_list < 1) {
+            throw std::invalid_argument("AnalogIndex: probes, neighbours, training_per_list >= 1");
+        }
+    }
+
+    const AnalogConfig& settings() const { return config; }
+    size_t size() const { return count; }
+    size_t listCount() const { return list_count; }
+    size_t listSize(size_t l) const { return offsets[l + 1] - offsets[l]; }
+
+    // Index n encoded days (n x ANALOG_DIM) with their outcomes
+    // (n x ANALOG_HORIZON); search results refer to rows of these arrays
+    void build(ThreadPool& pool, const float* data, const float* day_outcomes, size_t n) {
+        if (n == 0) throw std::invalid_argument("AnalogIndex::build: no days");
+        count = n;
+        list_count = config.lists > 0 ? (size_t)config.lists : (size_t)std::max(1.0, std::sqrt((double)n));
+        list_count = std::min(list_count, n);
+        AlignedBuffer<float> aligned(n * ANALOG_DIM);
+        std::copy(data, data + n * ANALOG_DIM, aligned.data());
+        train(pool, aligned.data(), n);
+
+        // Counting sort of all days into their lists
+        std::vector<uint32_t> label;
+        assign(pool, aligned.data(), n, label);
+        offsets.assign(list_count + 1, 0);
+        for (size_t i = 0; i < n; i++) offsets[label[i] + 1]++;
+        for (size_t l = 0; l < list_count; l++) offsets[l + 1] += offsets[l];
+        std::vector<size_t> next(offsets.begin(), offsets.end() - 1);
+        vectors.resize(n * ANALOG_DIM);
+        outcomes.resize(n * ANALOG_HORIZON);
+        ids.resize(n);
+        for (size_t i = 0; i < n; i++) {
+            size_t p = next[label[i]]++;
+            std::copy(&aligned[i * ANALOG_DIM], &aligned[i * ANALOG_DIM] + ANALOG_DIM, &vectors[p * ANALOG_DIM]);
+            std::copy(day_outcomes + i * ANALOG_HORIZON, day_outcomes + (i + 1) * ANALOG_HORIZON,
+                      &outcomes[p * ANALOG_HORIZON]);
+            ids[p] = (uint32_t)i;
+        }
+    }
+
+    // k nearest indexed days to query (ANALOG_DIM floats, 32-byte aligned),
+    // nearest first, scanning `probes` lists (0 = all: exact search). Returns
+    // (squared distance, position) pairs; see dayOf() / outcomeOf().
+    std::vector<std::pair<float, uint32_t> > search(const float* query, int k, int probes) const {
+        std::vector<std::pair<float, uint32_t> > lists(list_count);
+        for (size_t l = 0; l < list_count; l++) {
+            lists[l] = std::make_pair(analogDistance(query, &centroids[l * ANALOG_DIM]), (uint32_t)l);
+        }
+        size_t scan = probes > 0 ? std::min((size_t)probes, list_count) : list_count;
+        std::partial_sort(lists.begin(), lists.begin() + scan, lists.end());
+
+        // Max-heap of the best k so far
+        std::vector<std::pair<float, uint32_t> > best;
+        best.reserve(k + 1);
+        float bound = std::numeric_limits<float>::infinity();
+        for (size_t j = 0; j < scan; j++) {
+            size_t l = lists[j].second;
+            for (size_t p = offsets[l]; p < offsets[l + 1]; p++) {
+                float d = analogDistance(query, &vectors[p * ANALOG_DIM]);
+                if (d >= bound) continue;
+                best.push_back(std::make_pair(d, (uint32_t)p));
+                std::push_heap(best.begin(), best.end());
+                if (best.size() > (size_t)k) {
+                    std::pop_heap(best.begin(), best.end());
+                    best.pop_back();
+                }
+                if (best.size() == (size_t)k) bound = best.front().first;
+            }
+        }
+        std::sort_heap(best.begin(), best.end());
+        return best;
+    }
+
+    size_t dayOf(uint32_t position) const { return ids[position]; }
+    const float* outcomeOf(uint32_t position) const { return &outcomes[(size_t)position * ANALOG_HORIZON]; }
+
+    // Empirical P10/P50/P90 per hour over the analogs' outcomes (linear
+    // interpolation between order statistics); false if the index is empty or
+    // every probed list is
+    bool forecast(const float* query, AnalogForecast& out, int k = 0, int probes = 0) const {
+        if (count == 0) return false;
+        std::vector<std::pair<float, uint32_t> > analogs =
+            search(query, k > 0 ? k : config.neighbours, probes > 0 ? probes : config.probes);
+        size_t m = analogs.size();
+        if (m == 0) return false;
+        std::vector<double> values(m);
+        for (int h = 0; h < ANALOG_HORIZON; h++) {
+            for (size_t j = 0; j < m; j++) values[j] = outcomeOf(analogs[j].second)[h];
+            std::sort(values.begin(), values.end());
+            double* targets[3] = { &out.p10[h], &out.p50[h], &out.p90[h] };
+            const double levels[3] = { 0.1, 0.5, 0.9 };
+            for (int q = 0; q < 3; q++) {
+                double pos = levels[q] * (m - 1);
+                size_t lo = (size_t)pos;
+                size_t hi = std::min(lo + 1, m - 1);
+                *targets[q] = values[lo] + (pos - lo) * (values[hi] - values[lo]);
+            }
+        }
+        return true;
+    }
+};
+
+#endif
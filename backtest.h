@@ -0,0 +1,380 @@
+/**
+ * Rolling-Origin Backtester
+ * Day-ahead evaluation of the Beta regression, harmonic and Holt-Winters
+ * forecasters over many sites, into a columnar metrics table
+ *
+ * Each site's history is split into a training window and an evaluation
+ * period. Origins fall every origin_step hours of the evaluation period;
+ * at each one every forecaster issues a point forecast and a P10-P90 band
+ * for the next `horizon` hours of solar and wind capacity factor, using
+ * only samples before the origin. The Beta regression trains on recorded
+ * weather but forecasts from simulateWeather(), the weather forecast the
+ * day-ahead service (forecast_service.h) builds its horizon from, so it is
+ * not scored with the realized weather of the forecast hours.
+ *
+ * Models are refitted every refit_every origins on the trailing window and
+ * reused in between: Beta regression keeps its coefficients (refits warm
+ * start from them), the harmonic model is evaluated further past its window
+ * and Holt-Winters absorbs the new samples at its fitted smoothing
+ * parameters. Sites are spread over the pool; a worker builds a site's
+ * design matrix and the forecast-weather rows of all its origins once into
+ * its own buffers and runs every origin, target and forecaster on them. Row
+ * positions depend only on (site, target, model, origin), so the table does
+ * not depend on the thread count.
+ */
+
+#ifndef BACKTEST_H
+#define BACKTEST_H
+
+#include <vector>
+#include <string>
+#include <cmath>
+#include <cstdio>
+#include <cstddef>
+#include <cstdint>
+#include <chrono>
+#include <algorithm>
+#include <stdexcept>
+
+#include "energy_data.h"
+#include "feature_builder.h"
+#include "forecast_service.h"
+#include "beta_regression.h"
+#include "harmonic_forecast.h"
+#include "holt_winters.h"
+#include "thread_pool.h"
+
+enum BacktestTarget { BACKTEST_SOLAR = 0, BACKTEST_WIND = 1, BACKTEST_TARGETS = 2 };
+enum BacktestModel { BACKTEST_BETA = 0, BACKTEST_HARMONIC = 1, BACKTEST_ETS = 2, BACKTEST_MODELS = 3 };
+
+inline const char* backtestTargetName(int target) {
+    static const char* names[BACKTEST_TARGETS] = { "solar", "wind" };
+    return names[target];
+}
+
+inline const char* backtestModelName(int model) {
+    static const char* names[BACKTEST_MODELS] = { "beta", "harmonic", "ets" };
+    return names[model];
+}
+
+struct BacktestConfig {
+    int train_days;                             // trailing window each refit sees
+    int eval_days;
+    int horizon;                                // hours per forecast
+    int origin_step;                            // hours between origins
+    int refit_every;                            // origins per refit
+    double interval_z;                          // normal z of the P90 bound (harmonic, ETS bands)
+    unsigned seed;                              // site s uses generateSyntheticHistory(days, seed + s)
+};
+
+inline BacktestConfig defaultBacktestConfig() {
+    BacktestConfig c = { 60, 365, 24, 24, 7, 1.2816, 1000 };
+    return c;
+}
+
+// One row per (site, target, model, origin); metrics over the origin's horizon
+struct BacktestTable {
+    std::vector<uint32_t> site;
+    std::vector<uint32_t> origin;               // hours after the start of the evaluation period
+    std::vector<uint8_t> target;
+    std::vector<uint8_t> model;
+    std::vector<float> mae;
+    std::vector<float> rmse;
+    std::vector<float> coverage;                // fraction of hours inside [P10, P90]
+    std::vector<float> width;                   // mean P90 - P10
+
+    size_t rows() const { return site.size(); }
+
+    void resize(size_t n) {
+        site.resize(n);
+        origin.resize(n);
+        target.resize(n);
+        model.resize(n);
+        mae.resize(n);
+        rmse.resize(n);
+        coverage.resize(n);
+        width.resize(n);
+    }
+
+    bool writeCsv(const std::string& path) const {
+        FILE* f = std::fopen(path.c_str(), "w");
+        if (!f) return false;
+        std::fprintf(f, "site,origin,target,model,mae,rmse,coverage,width\n");
+        for (size_t i = 0; i < rows(); i++) {
+            std::fprintf(f, "%u,%u,%s,%s,%.6g,%.6g,%.6g,%.6g\n", site[i], origin[i], backtestTargetName(target[i]),
+                         backtestModelName(model[i]), mae[i], rmse[i], coverage[i], width[i]);
+        }
+        return std::fclose(f) == 0;
+    }
+};
+
+// Pooled metrics of one (target, model) cell
+struct BacktestSummary {
+    double mae, rmse, coverage, width;
+    size_t rows;
+};
+
+// Every origin covers the same number of hours, so the pooled RMSE is the
+// root of the mean row MSE
+inline void summarizeBacktest(const BacktestTable& table, BacktestSummary out[BACKTEST_TARGETS][BACKTEST_MODELS]) {
+    for (int t = 0; t < BACKTEST_TARGETS; t++) {
+        for (int m = 0; m < BACKTEST_MODELS; m++) out[t][m] = BacktestSummary();
+    }
+    for (size_t i = 0; i < table.rows(); i++) {
+        BacktestSummary& s = out[table.target[i]][table.model[i]];
+        s.mae += table.mae[i];
+        s.rmse += (double)table.rmse[i] * table.rmse[i];
+        s.coverage += table.coverage[i];
+        s.width += table.width[i];
+        s.rows++;
+    }
+    for (int t = 0; t < BACKTEST_TARGETS; t++) {
+        for (int m = 0; m < BACKTEST_MODELS; m++) {
+            BacktestSummary& s = out[t][m];
+            if (s.rows == 0) continue;
+            s.mae /= s.rows;
+            s.rmse = std::sqrt(s.rmse / s.rows);
+            s.coverage /= s.rows;
+            s.width /= s.rows;
+        }
+    }
+}
+
+// Worker time (ms, summed over workers) by stage
+struct BacktestTiming {
+    double data_ms;                             // history, design matrix and forecast-weather rows
+    double fit_ms[BACKTEST_MODELS];
+    double forecast_ms[BACKTEST_MODELS];        // forecasts, state updates and scoring
+};
+
+class Backtester {
+private:
+    typedef std::chrono::steady_clock Clock;
+
+    BacktestConfig config;
+    FeatureBuilder features;
+    HarmonicForecaster harmonic;
+    HoltWinters ets;
+
+    // Reused by every site a worker runs
+    struct Workspace {
+        AlignedBuffer<double> X;                // design matrix of the current site (recorded weather)
+        AlignedBuffer<double> horizon;          // forecast-weather rows, origins x horizon
+        BetaRegression beta;
+        HarmonicModel harmonic_model;
+        HoltWintersModel ets_model;
+        std::vector<double> point, lower, upper, quantiles;
+        BacktestTiming timing;
+    };
+
+    static double since(Clock::time_point start) {
+        return std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+    }
+
+    static HarmonicConfig capacityHarmonicConfig() {
+        HarmonicConfig c = defaultHarmonicConfig();
+        c.lower = 0.0;
+        c.upper = 1.0;
+        return c;
+    }
+
+    size_t trainHours() const { return (size_t)config.train_days * 24; }
+
+    size_t origins() const { return ((size_t)config.eval_days * 24 - 1) / config.origin_step + 1; }
+
+    int historyDays() const { return config.train_days + config.eval_days + (config.horizon + 23) / 24; }
+
+    void score(const double* actual, const Workspace& ws, size_t row, BacktestTable& table) const {
+        double abs_sum = 0.0, sq_sum = 0.0, covered = 0.0, width = 0.0;
+        for (int h = 0; h < config.horizon; h++) {
+            double e = ws.point[h] - actual[h];
+            abs_sum += std::fabs(e);
+            sq_sum += e * e;
+            covered += actual[h] >= ws.lower[h] && actual[h] <= ws.upper[h];
+            width += ws.upper[h] - ws.lower[h];
+        }
+        double n = config.horizon;
+        table.mae[row] = (float)(abs_sum / n);
+        table.rmse[row] = (float)std::sqrt(sq_sum / n);
+        table.coverage[row] = (float)(covered / n);
+        table.width[row] = (float)(width / n);
+    }
+
+    // point +/- z * sd[h], clamped to capacity-factor range
+    void bands(Workspace& ws, const double* sd) const {
+        for (int h = 0; h < config.horizon; h++) {
+            ws.point[h] = std::max(0.0, std::min(1.0, ws.point[h]));
+            ws.lower[h] = std::max(0.0, ws.point[h] - config.interval_z * sd[h]);
+            ws.upper[h] = std::min(1.0, ws.point[h] + config.interval_z * sd[h]);
+        }
+    }
+
+    // All origins of one (site, target): rows [first, first + origins * BACKTEST_MODELS)
+    void runTarget(size_t site, int target, const double* y, Workspace& ws, size_t first,
+                   BacktestTable& table) const {
+        const size_t p = features.featureCount(), train = trainHours(), n_origins = origins();
+        const int H = config.horizon;
+        const double levels[2] = { 0.1, 0.9 };
+        std::vector<double> sd(H);
+        size_t harmonic_origin = 0, ets_samples = 0, ets_end = 0;
+        bool harmonic_ok = false;
+
+        for (size_t o = 0; o < n_origins; o++) {
+            size_t t0 = train + o * config.origin_step;
+            const double* window = y + (t0 - train);
+            const double* X0 = ws.horizon.data() + o * H * p;
+
+            if (o % config.refit_every == 0) {
+                Clock::time_point start = Clock::now();
+                ws.beta.fit(ws.X.data() + (t0 - train) * p, window, train, p, o > 0);
+                ws.timing.fit_ms[BACKTEST_BETA] += since(start);
+
+                start = Clock::now();
+                harmonic_ok = harmonic.fit(y, t0, ws.harmonic_model);
+                harmonic_origin = t0;
+                ws.timing.fit_ms[BACKTEST_HARMONIC] += since(start);
+
+                start = Clock::now();
+                ets.fit(window, train, ws.ets_model);
+                ets_samples = train;
+                ets_end = t0;
+                ws.timing.fit_ms[BACKTEST_ETS] += since(start);
+            }
+
+            size_t rows[BACKTEST_MODELS];
+            for (int m = 0; m < BACKTEST_MODELS; m++) {
+                rows[m] = first + (size_t)m * n_origins + o;
+                table.site[rows[m]] = (uint32_t)site;
+                table.origin[rows[m]] = (uint32_t)(t0 - train);
+                table.target[rows[m]] = (uint8_t)target;
+                table.model[rows[m]] = (uint8_t)m;
+            }
+
+            // Beta regression on forecast weather: predictive mean and Beta P10/P90
+            Clock::time_point start = Clock::now();
+            ws.beta.predict(X0, H, &ws.point[0]);
+            ws.beta.predictQuantiles(X0, H, levels, 2, &ws.quantiles[0]);
+            for (int h = 0; h < H; h++) {
+                ws.lower[h] = ws.quantiles[2 * h];
+                ws.upper[h] = ws.quantiles[2 * h + 1];
+            }
+            score(y + t0, ws, rows[BACKTEST_BETA], table);
+            ws.timing.forecast_ms[BACKTEST_BETA] += since(start);
+
+            // Harmonic: the last fit, evaluated past its window; in-sample RMSE bands
+            start = Clock::now();
+            if (harmonic_ok) {
+                harmonic.evaluate(ws.harmonic_model, ws.harmonic_model.samples + (t0 - harmonic_origin), H,
+                                  &ws.point[0]);
+                std::fill(sd.begin(), sd.end(), ws.harmonic_model.rmse);
+            } else {
+                std::fill(ws.point.begin(), ws.point.end(), y[t0 - 1]);
+                std::fill(sd.begin(), sd.end(), 0.0);
+            }
+            bands(ws, &sd[0]);
+            score(y + t0, ws, rows[BACKTEST_HARMONIC], table);
+            ws.timing.forecast_ms[BACKTEST_HARMONIC] += since(start);
+
+            // Holt-Winters: absorb the samples since the last origin, then the
+            // ETS(A,A,A) h-step variance s^2 (1 + sum_{j<h} alpha^2 (1 + j beta)^2)
+            // (seasonal terms enter only past one period)
+            start = Clock::now();
+            if (ets_end < t0) {
+                ets.update(ws.ets_model, y + ets_end, t0 - ets_end);
+                ets_samples += t0 - ets_end;
+                ets_end = t0;
+            }
+            ets.forecast(ws.ets_model, H, &ws.point[0]);
+            const HoltWintersModel& em = ws.ets_model;
+            double s2 = em.sse / ets_samples, acc = 1.0;
+            for (int h = 0; h < H; h++) {
+                sd[h] = std::sqrt(s2 * acc);
+                double c = em.alpha * (1.0 + (h + 1) * em.beta);
+                acc += c * c;
+            }
+            bands(ws, &sd[0]);
+            score(y + t0, ws, rows[BACKTEST_ETS], table);
+            ws.timing.forecast_ms[BACKTEST_ETS] += since(start);
+        }
+    }
+
+    // Design rows of every origin's horizon from the simulated weather forecast
+    // issued for (site, hour, day) at the origin
+    void buildHorizons(size_t site, const EnergyHistory& h, Workspace& ws) const {
+        const size_t p = features.featureCount(), train = trainHours(), n_origins = origins();
+        const int H = config.horizon;
+        ws.horizon.resize(n_origins * H * p);
+        WeatherForecast w;
+        for (size_t o = 0; o < n_origins; o++) {
+            size_t t0 = train + o * config.origin_step;
+            for (int done = 0; done < H; done += FORECAST_HOURS) {
+                // Horizons past one day chain the next day's forecast
+                int hour = (h.hour_of_day[t0] + done) % 24, day = h.day_of_year[t0 + done];
+                w = simulateWeather((int)site, hour, day);
+                WeatherColumns cols = { &w.hour_of_day[0], &w.day_of_year[0], &w.temperature[0],
+                                        &w.cloud_cover[0], &w.wind_speed[0], (size_t)FORECAST_HOURS };
+                size_t rows = std::min(FORECAST_HOURS, H - done);
+                features.buildRows(cols, 0, rows, ws.horizon.data() + (o * H + done) * p);
+            }
+        }
+    }
+
+    void runSite(size_t site, Workspace& ws, BacktestTable& table) const {
+        Clock::time_point start = Clock::now();
+        EnergyHistory h = generateSyntheticHistory(historyDays(), config.seed + (unsigned)site);
+        features.build(h, ws.X);
+        buildHorizons(site, h, ws);
+        ws.timing.data_ms += since(start);
+
+        const double* series[BACKTEST_TARGETS] = { &h.solar_capacity[0], &h.wind_capacity[0] };
+        size_t per_target = origins() * BACKTEST_MODELS;
+        for (int t = 0; t < BACKTEST_TARGETS; t++) {
+            runTarget(site, t, series[t], ws, (site * BACKTEST_TARGETS + t) * per_target, table);
+        }
+    }
+
+public:
+    explicit Backtester(const BacktestConfig& c = defaultBacktestConfig())
+        : config(c), harmonic(capacityHarmonicConfig()), ets(defaultHoltWintersConfig()) {
+        if (c.train_days < 14 || c.eval_days < 1 || c.horizon < 1 || c.origin_step < 1 || c.refit_every < 1) {
+            throw std::invalid_argument("Backtester: train_days >= 14, eval_days, horizon, origin_step and "
+                                        "refit_every >= 1");
+        }
+    }
+
+    const BacktestConfig& settings() const { return config; }
+
+    size_t originCount() const { return origins(); }
+
+    size_t rowCount(size_t sites) const { return sites * BACKTEST_TARGETS * BACKTEST_MODELS * origins(); }
+
+    // Backtest sites [0, sites) into table (resized); timing, if given,
+    // receives the worker time per stage
+    void run(ThreadPool& pool, size_t sites, BacktestTable& table, BacktestTiming* timing = 0) const {
+        table.resize(rowCount(sites));
+        std::vector<Workspace> workspaces(pool.size());
+        for (size_t w = 0; w < workspaces.size(); w++) {
+            workspaces[w].point.resize(config.horizon);
+            workspaces[w].lower.resize(config.horizon);
+            workspaces[w].upper.resize(config.horizon);
+            workspaces[w].quantiles.resize(2 * config.horizon);
+            workspaces[w].timing = BacktestTiming();
+        }
+        pool.parallelFor(sites, 1, [&](size_t begin, size_t end, size_t worker) {
+            for (size_t s = begin; s < end; s++) runSite(s, workspaces[worker], table);
+        });
+        if (timing) {
+            *timing = BacktestTiming();
+            for (size_t w = 0; w < workspaces.size(); w++) {
+                const BacktestTiming& t = workspaces[w].timing;
+                timing->data_ms += t.data_ms;
+                for (int m = 0; m < BACKTEST_MODELS; m++) {
+                    timing->fit_ms[m] += t.fit_ms[m];
+                    timing->forecast_ms[m] += t.forecast_ms[m];
+                }
+            }
+        }
+    }
+};
+
+#endif
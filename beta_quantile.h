@@ -0,0 +1,179 @@
+/**
+ * Beta Quantile Function
+ * Regularized incomplete beta and batched inverse CDF for P10/P50/P90 grids
+ * Initial approximation plus bracketed Halley refinement
+ */
+
+#ifndef BETA_QUANTILE_H
+#define BETA_QUANTILE_H
+
+#include <cmath>
+#include <cstddef>
+#include <algorithm>
+
+#include "special_functions.h"
+
+// Continued fraction for the incomplete beta function (modified Lentz)
+inline double incompleteBetaFraction(double x, double a, double b) {
+    const double FPMIN = 1e-300;
+    const double EPS = 1e-15;
+    double qab = a + b, qap = a + 1.0, qam = a - 1.0;
+    double c = 1.0;
+    double d = 1.0 - qab * x / qap;
+    if (std::fabs(d) < FPMIN) d = FPMIN;
+    d = 1.0 / d;
+    double h = d;
+
+    for (int m = 1; m <= 300; m++) {
+        int m2 = 2 * m;
+        double aa = m * (b - m) * x / ((qam + m2) * (a + m2));
+        d = 1.0 + aa * d;
+        if (std::fabs(d) < FPMIN) d = FPMIN;
+        c = 1.0 + aa / c;
+        if (std::fabs(c) < FPMIN) c = FPMIN;
+        d = 1.0 / d;
+        h *= d * c;
+
+        aa = -(a + m) * (qab + m) * x / ((a + m2) * (qap + m2));
+        d = 1.0 + aa * d;
+        if (std::fabs(d) < FPMIN) d = FPMIN;
+        c = 1.0 + aa / c;
+        if (std::fabs(c) < FPMIN) c = FPMIN;
+        d = 1.0 / d;
+        double del = d * c;
+        h *= del;
+        if (std::fabs(del - 1.0) < EPS) break;
+    }
+    return h;
+}
+
+// Regularized incomplete beta I_x(a, b); log_beta = lgamma(a) + lgamma(b) - lgamma(a + b)
+inline double regularizedIncompleteBeta(double x, double a, double b, double log_beta) {
+    if (x <= 0.0) return 0.0;
+    if (x >= 1.0) return 1.0;
+    double front = std::exp(a * std::log(x) + b * std::log1p(-x) - log_beta);
+    if (x < (a + 1.0) / (a + b + 2.0)) {
+        return front * incompleteBetaFraction(x, a, b) / a;
+    }
+    return 1.0 - front * incompleteBetaFraction(1.0 - x, b, a) / b;
+}
+
+inline double regularizedIncompleteBeta(double x, double a, double b) {
+    return regularizedIncompleteBeta(x, a, b, logGamma(a) + logGamma(b) - logGamma(a + b));
+}
+
+// Starting point for the inverse: normal approximation when a, b >= 1,
+// otherwise the power-law tails of the density near 0 and 1
+inline double betaQuantileGuess(double p, double a, double b) {
+    double x;
+    if (a >= 1.0 && b >= 1.0) {
+        double pp = p < 0.5 ? p : 1.0 - p;
+        double t = std::sqrt(-2.0 * std::log(pp));
+        x = (2.30753 + t * 0.27061) / (1.0 + t * (0.99229 + t * 0.04481)) - t;
+        if (p < 0.5) x = -x;
+        double al = (x * x - 3.0) / 6.0;
+        double h = 2.0 / (1.0 / (2.0 * a - 1.0) + 1.0 / (2.0 * b - 1.0));
+        double w = x * std::sqrt(al + h) / h
+                 - (1.0 / (2.0 * b - 1.0) - 1.0 / (2.0 * a - 1.0)) * (al + 5.0 / 6.0 - 2.0 / (3.0 * h));
+        x = a / (a + b * std::exp(2.0 * w));
+    } else {
+        double lna = std::log(a / (a + b));
+        double lnb = std::log(b / (a + b));
+        double t = std::exp(a * lna) / a;
+        double u = std::exp(b * lnb) / b;
+        double w = t + u;
+        if (p < t / w) x = std::pow(a * w * p, 1.0 / a);
+        else x = 1.0 - std::pow(b * w * (1.0 - p), 1.0 / b);
+    }
+    return x;
+}
+
+// Bisection point of [lo, hi] in (0, 1): geometric near 0 and 1, where
+// quantiles of small-shape distributions sit many decades from the ends
+// (the roots are taken separately: lo * hi underflows below ~1e-308)
+inline double bracketMidpoint(double lo, double hi) {
+    if (hi <= 0.5) {
+        double floor = lo > 0.0 ? lo : std::min(1e-300, 0.5 * hi);
+        return std::sqrt(floor) * std::sqrt(hi);
+    }
+    if (lo >= 0.5) {
+        return 1.0 - std::sqrt((1.0 - lo) * std::max(1.0 - hi, 1e-17));
+    }
+    return 0.5 * (lo + hi);
+}
+
+// Inverse CDF of Beta(a, b) at probability p, with the root known to lie in [lo, hi]
+// (guess <= 0 selects the closed-form starting approximation)
+inline double betaQuantile(double p, double a, double b, double log_beta,
+                           double lo = 0.0, double hi = 1.0, double guess = 0.0) {
+    if (p <= 0.0) return 0.0;
+    if (p >= 1.0) return 1.0;
+
+    const double EPS = 1e-12;
+    double a1 = a - 1.0, b1 = b - 1.0;
+    double x = guess > 0.0 ? guess : betaQuantileGuess(p, a, b);
+    if (!(x > lo && x < hi)) x = bracketMidpoint(lo, hi);
+
+    double prev_err = 2.0;
+    for (int iter = 0; iter < 100; iter++) {
+        double err = regularizedIncompleteBeta(x, a, b, log_beta) - p;
+        if (err == 0.0) break;
+
+        // I_x is increasing in x, so the sign of err tightens the bracket
+        if (err < 0.0) lo = x;
+        else hi = x;
+
+        double pdf = std::exp(a1 * std::log(x) + b1 * std::log1p(-x) - log_beta);
+        double next = bracketMidpoint(lo, hi);
+        if (pdf > 0.0 && std::isfinite(pdf)) {
+            double u = err / pdf;
+            double step = u / (1.0 - 0.5 * std::min(1.0, u * (a1 / x - b1 / (1.0 - x))));
+            if (std::fabs(step) < EPS * std::min(x, 1.0 - x)) {
+                x = std::max(lo, std::min(hi, x - step));
+                break;
+            }
+            // Fall back to bisection when Halley leaves the bracket or stalls
+            // (far in the tails the density underflows and the steps shrink)
+            if (x - step > lo && x - step < hi && std::fabs(err) < 0.5 * std::fabs(prev_err)) {
+                next = x - step;
+            }
+        }
+        prev_err = err;
+        x = next;
+        if (hi - lo < EPS * std::min(x, 1.0 - x)) break;
+    }
+    return x;
+}
+
+inline double betaQuantile(double p, double a, double b) {
+    return betaQuantile(p, a, b, logGamma(a) + logGamma(b) - logGamma(a + b));
+}
+
+// Solve m quantile levels (ascending) for each of n Beta(alpha[i], beta[i])
+// distributions; out is row-major n x m. The log-beta normalizer is computed
+// once per element; each root brackets the next level from below and seeds it
+// with a Newton step, since I_x is known exactly at the previous root.
+inline void betaQuantiles(const double* alpha, const double* beta, size_t n,
+                          const double* levels, size_t m, double* out) {
+    for (size_t i = 0; i < n; i++) {
+        double a = alpha[i], b = beta[i];
+        double log_beta = logGamma(a) + logGamma(b) - logGamma(a + b);
+        double lo = 0.0, guess = 0.0;
+        for (size_t k = 0; k < m; k++) {
+            double q = betaQuantile(levels[k], a, b, log_beta, lo, 1.0, guess);
+            out[i * m + k] = q;
+            lo = 0.0;
+            guess = 0.0;
+            if (k + 1 < m && levels[k + 1] >= levels[k] && q > 0.0 && q < 1.0) {
+                // The seed must lie strictly inside (q, 1): with a tiny shape the
+                // density at q is so large that the Newton step rounds back to q
+                lo = q;
+                double pdf = std::exp((a - 1.0) * std::log(q) + (b - 1.0) * std::log1p(-q) - log_beta);
+                if (pdf > 0.0 && std::isfinite(pdf)) guess = q + (levels[k + 1] - levels[k]) / pdf;
+                if (!(guess > lo && guess < 1.0)) guess = bracketMidpoint(lo, 1.0);
+            }
+        }
+    }
+}
+
+#endif
@@ -0,0 +1,408 @@
+/**
+ * Beta Regression Engine
+ * Native maximum-likelihood fit for bounded (0, 1) capacity factors
+ * Fisher scoring with closed-form score and information matrix
+ */
+
+#ifndef BETA_REGRESSION_H
+#define BETA_REGRESSION_H
+
+#include <vector>
+#include <cmath>
+#include <cstddef>
+#include <algorithm>
+#include <stdexcept>
+
+#include "special_functions.h"
+#include "beta_quantile.h"
+#include "weighted_gram.h"
+
+// out = X * beta for row-major X (n x p); four rows at a time so the
+// per-row dot products run as independent FMA chains
+inline void linearPredictor(const double* X, size_t n, size_t p, const double* beta, double* out) {
+    size_t i = 0;
+    for (; i + 4 <= n; i += 4) {
+        const double* r0 = X + i * p;
+        const double* r1 = r0 + p;
+        const double* r2 = r1 + p;
+        const double* r3 = r2 + p;
+        double e0 = 0.0, e1 = 0.0, e2 = 0.0, e3 = 0.0;
+        for (size_t j = 0; j < p; j++) {
+            double bj = beta[j];
+            e0 += r0[j] * bj;
+            e1 += r1[j] * bj;
+            e2 += r2[j] * bj;
+            e3 += r3[j] * bj;
+        }
+        out[i] = e0;
+        out[i + 1] = e1;
+        out[i + 2] = e2;
+        out[i + 3] = e3;
+    }
+    for (; i < n; i++) {
+        const double* row = X + i * p;
+        double e = 0.0;
+        for (size_t j = 0; j < p; j++) e += row[j] * beta[j];
+        out[i] = e;
+    }
+}
+
+// Per-observation score and expected-information weights in (beta, log phi):
+// score = (u_beta * x, u_phi), info = [w x x', c x; c x', d]
+struct BetaRowTerms {
+    double u_beta, u_phi, w, c, d;
+};
+
+inline BetaRowTerms betaRowTerms(double mu, double phi, double log_y, double log_1my,
+                                 double psi_a, double psi_b, double tri_a, double tri_b,
+                                 double psi_phi, double tri_phi) {
+    BetaRowTerms t;
+    double dmu = mu * (1.0 - mu);
+    double phi2 = phi * phi;
+    double resid = (log_y - log_1my) - (psi_a - psi_b);
+    t.u_beta = phi * resid * dmu;
+    t.u_phi = phi * (mu * resid + log_1my - psi_b + psi_phi);
+    t.w = phi2 * (tri_a + tri_b) * dmu * dmu;
+    t.c = phi2 * (tri_a * mu - tri_b * (1.0 - mu)) * dmu;
+    t.d = phi2 * (tri_a * mu * mu + tri_b * (1.0 - mu) * (1.0 - mu) - tri_phi);
+    return t;
+}
+
+class BetaRegression {
+private:
+    std::vector<double> coefficients;
+    double phi;
+    double loglik;
+    int iterations;
+    bool converged;
+    int max_iterations;
+    double tolerance;
+
+    // Per-fit workspace, reused across calls so repeated fits do not reallocate
+    std::vector<double> log_y, log_1my, eta, mu;
+    size_t response_n;                          // rows of the setResponse() response
+    bool response_set;                          // log_y / log_1my hold that response
+    std::vector<double> info, score, step, trial;
+    std::vector<double> row_w, row_u, row_c, products;
+    WeightedGram gram_kernel;
+    ThreadPool* gram_pool;
+    std::vector<double> gram_scratch, partial_loglik;
+
+    // Row-block scratch for the special-function kernels (stays in L1)
+    enum { BLOCK = 256 };
+    double block_a[BLOCK], block_b[BLOCK];
+    double block_psi_a[BLOCK], block_psi_b[BLOCK];
+    double block_tri_a[BLOCK], block_tri_b[BLOCK];
+
+    static double logitInv(double x) {
+        return 1.0 / (1.0 + std::exp(-x));
+    }
+
+    static double clampMu(double m) {
+        return std::min(1.0 - 1e-12, std::max(1e-12, m));
+    }
+
+    // Log-likelihood terms of rows [begin, end) without the n * lgamma(phi)
+    // constant; fills eta and mu for those rows. Each BLOCK of rows runs the
+    // predictor, logistic and lgamma kernels while it is in L1; a, b, lg_a and
+    // lg_b are BLOCK-sized scratch.
+    double likelihoodRows(const double* X, size_t begin, size_t end, size_t p, const double* beta, double ph,
+                          double* a, double* b, double* lg_a, double* lg_b) {
+        double total = 0.0;
+        for (size_t start = begin; start < end; start += BLOCK) {
+            size_t len = std::min(static_cast<size_t>(BLOCK), end - start);
+            linearPredictor(X + start * p, len, p, beta, &eta[start]);
+            logisticArray(&eta[start], &mu[start], len);
+            for (size_t i = 0; i < len; i++) {
+                double m = clampMu(mu[start + i]);
+                mu[start + i] = m;
+                a[i] = m * ph;
+                b[i] = (1.0 - m) * ph;
+            }
+            logGammaArray(a, lg_a, len);
+            logGammaArray(b, lg_b, len);
+            for (size_t i = 0; i < len; i++) {
+                total += (a[i] - 1.0) * log_y[start + i] + (b[i] - 1.0) * log_1my[start + i]
+                       - lg_a[i] - lg_b[i];
+            }
+        }
+        return total;
+    }
+
+    // Log-likelihood at (beta, log phi); fills eta and mu for the caller.
+    // Long passes are split across the pool in fixed row ranges like the
+    // Gram passes, and the partial sums are added in order.
+    double logLikelihood(const double* X, size_t n, size_t p,
+                         const double* beta, double log_phi) {
+        double ph = std::exp(log_phi);
+        double total = n * logGamma(ph);
+        if (!splitsWeightedGram(gram_pool, n)) {
+            return total + likelihoodRows(X, 0, n, p, beta, ph, block_a, block_b, block_psi_a, block_psi_b);
+        }
+        size_t chunks = std::min(gram_pool->size() * 4, n / PARALLEL_GRAM_CHUNK_ROWS);
+        size_t chunk_rows = (n + chunks - 1) / chunks;
+        partial_loglik.assign(chunks, 0.0);
+        gram_pool->parallelFor(chunks, 1, [&](size_t begin, size_t end, size_t) {
+            double a[BLOCK], b[BLOCK], lg_a[BLOCK], lg_b[BLOCK];
+            for (size_t c = begin; c < end; c++) {
+                size_t lo = c * chunk_rows;
+                size_t hi = std::min(n, lo + chunk_rows);
+                if (lo < hi) partial_loglik[c] = likelihoodRows(X, lo, hi, p, beta, ph, a, b, lg_a, lg_b);
+            }
+        });
+        for (size_t c = 0; c < chunks; c++) total += partial_loglik[c];
+        return total;
+    }
+
+    // Clip y like the Python model and cache log(y), log(1 - y)
+    void prepareResponse(const double* y, size_t n) {
+        log_y.resize(n);
+        log_1my.resize(n);
+        eta.resize(n);
+        mu.resize(n);
+        row_w.resize(n);
+        row_u.resize(n);
+        row_c.resize(n);
+        for (size_t i = 0; i < n; i++) {
+            double yi = std::min(1.0 - 1e-6, std::max(1e-6, y[i]));
+            log_y[i] = yi;
+            log_1my[i] = 1.0 - yi;
+        }
+        logArray(&log_y[0], &log_y[0], n);
+        logArray(&log_1my[0], &log_1my[0], n);
+        response_set = false;
+    }
+
+    // Starting values: OLS on logit(y), precision from the moment estimate
+    void initialize(const double* X, const double* y, size_t n, size_t p) {
+        std::vector<double> gram(p * p, 0.0);
+        std::vector<double> rhs(p, 0.0);
+        for (size_t i = 0; i < n; i++) row_u[i] = log_y[i] - log_1my[i];
+        const double* logit_y = &row_u[0];
+        accumulateWeightedGram(gram_pool, gram_kernel, X, n, 0, &logit_y, 1, &gram[0], p, &rhs[0],
+                               gram_scratch);
+        for (size_t j = 0; j < p; j++) gram[j * p + j] += 1e-8;
+
+        coefficients.assign(p, 0.0);
+        if (choleskyDecompose(gram, p)) {
+            choleskySolve(gram, p, rhs);
+            coefficients = rhs;
+        }
+
+        double sum_var = 0.0, sum_sq = 0.0;
+        for (size_t i = 0; i < n; i++) {
+            const double* row = X + i * p;
+            double e = 0.0;
+            for (size_t j = 0; j < p; j++) e += row[j] * coefficients[j];
+            double m = clampMu(logitInv(e));
+            sum_var += m * (1.0 - m);
+            sum_sq += (y[i] - m) * (y[i] - m);
+        }
+        phi = sum_sq > 0.0 ? std::max(1.0, sum_var / sum_sq - 1.0) : 1.0;
+    }
+
+public:
+    BetaRegression(int max_iter = 100, double tol = 1e-10)
+        : phi(1.0), loglik(0.0), iterations(0), converged(false),
+          max_iterations(max_iter), tolerance(tol), response_n(0), response_set(false), gram_pool(0) {}
+
+    // Split the Gram and likelihood passes of long fits across pool (null = single thread)
+    void setThreadPool(ThreadPool* pool) { gram_pool = pool; }
+
+    // Cap on Fisher-scoring iterations (e.g. a few steps for warm refreshes)
+    void setMaxIterations(int max_iter) { max_iterations = max_iter; }
+    int getMaxIterations() const { return max_iterations; }
+
+    // Seed the next fit (warm start) with known coefficients and precision
+    void setParameters(const std::vector<double>& coefs, double precision) {
+        coefficients = coefs;
+        phi = precision;
+    }
+
+    // Fit on row-major X (n x p); returns true on convergence
+    bool fit(const double* X, const double* y, size_t n, size_t p, bool warm_start = false) {
+        if (n == 0 || p == 0) {
+            throw std::invalid_argument("BetaRegression::fit: empty design matrix");
+        }
+
+        size_t m = p + 1;
+        prepareResponse(y, n);
+        info.assign(m * m, 0.0);
+        score.assign(m, 0.0);
+        step.assign(m, 0.0);
+        trial.assign(m, 0.0);
+        products.assign(2 * p, 0.0);
+        gram_kernel.reset(p);
+
+        if (!warm_start || coefficients.size() != p || !(phi > 0.0)) {
+            initialize(X, y, n, p);
+        }
+
+        std::vector<double> theta(coefficients);
+        theta.push_back(std::log(phi));
+
+        loglik = logLikelihood(X, n, p, &theta[0], theta[p]);
+        converged = false;
+        iterations = 0;
+
+        while (iterations < max_iterations) {
+            iterations++;
+
+            // Score and expected information in (beta, log phi)
+            double ph = std::exp(theta[p]);
+            double psi_phi = digamma(ph);
+            double tri_phi = trigamma(ph);
+            std::fill(info.begin(), info.end(), 0.0);
+            std::fill(score.begin(), score.end(), 0.0);
+
+            for (size_t start = 0; start < n; start += BLOCK) {
+                size_t len = std::min(static_cast<size_t>(BLOCK), n - start);
+                for (size_t i = 0; i < len; i++) {
+                    block_a[i] = mu[start + i] * ph;
+                    block_b[i] = (1.0 - mu[start + i]) * ph;
+                }
+                digammaTrigammaArray(block_a, block_psi_a, block_tri_a, len);
+                digammaTrigammaArray(block_b, block_psi_b, block_tri_b, len);
+
+                for (size_t i = 0; i < len; i++) {
+                    size_t r = start + i;
+                    BetaRowTerms t = betaRowTerms(mu[r], ph, log_y[r], log_1my[r],
+                                                  block_psi_a[i], block_psi_b[i],
+                                                  block_tri_a[i], block_tri_b[i], psi_phi, tri_phi);
+                    row_w[r] = t.w;
+                    row_u[r] = t.u_beta;
+                    row_c[r] = t.c;
+                    score[p] += t.u_phi;
+                    info[p * m + p] += t.d;
+                }
+            }
+
+            // beta block X'WX plus X'u (score) and X'c (cross term) in one pass
+            const double* vectors[2] = { &row_u[0], &row_c[0] };
+            std::fill(products.begin(), products.end(), 0.0);
+            accumulateWeightedGram(gram_pool, gram_kernel, X, n, &row_w[0], vectors, 2, &info[0], m, &products[0],
+                                   gram_scratch);
+            for (size_t j = 0; j < p; j++) {
+                score[j] = products[j];
+                info[p * m + j] = products[p + j];
+            }
+            symmetrizeLower(&info[0], m, m);
+
+            step = score;
+            if (!choleskyDecompose(info, m)) break;
+            choleskySolve(info, m, step);
+
+            double decrement = 0.0;
+            for (size_t j = 0; j < m; j++) decrement += score[j] * step[j];
+
+            // Backtracking line search on the log-likelihood (Armijo condition)
+            double t = 1.0;
+            double candidate = loglik;
+            bool accepted = false;
+            for (int ls = 0; ls < 30; ls++) {
+                for (size_t j = 0; j < m; j++) trial[j] = theta[j] + t * step[j];
+                candidate = logLikelihood(X, n, p, &trial[0], trial[p]);
+                if (candidate >= loglik + 1e-4 * t * decrement) {
+                    accepted = true;
+                    break;
+                }
+                t *= 0.5;
+            }
+            if (!accepted) {
+                // No ascent possible from here; restore eta/mu at theta
+                logLikelihood(X, n, p, &theta[0], theta[p]);
+                converged = 0.5 * decrement <= 1e-6 * (1.0 + std::fabs(loglik));
+                break;
+            }
+
+            theta = trial;
+            loglik = candidate;
+
+            if (0.5 * decrement <= tolerance * (1.0 + std::fabs(loglik))) {
+                converged = true;
+                break;
+            }
+        }
+
+        coefficients.assign(theta.begin(), theta.begin() + p);
+        phi = std::exp(theta[p]);
+        return converged;
+    }
+
+    bool fit(const std::vector<double>& X, const std::vector<double>& y,
+             size_t n_features, bool warm_start = false) {
+        if (n_features == 0 || X.size() != y.size() * n_features) {
+            throw std::invalid_argument("BetaRegression::fit: X and y dimensions do not match");
+        }
+        return fit(&X[0], &y[0], y.size(), n_features, warm_start);
+    }
+
+    // Predict mean capacity factor for n rows of X
+    void predict(const double* X, size_t n, double* out) const {
+        linearPredictor(X, n, coefficients.size(), &coefficients[0], out);
+        logisticArray(out, out, n);
+    }
+
+    std::vector<double> predict(const std::vector<double>& X) const {
+        size_t p = coefficients.size();
+        std::vector<double> out(p ? X.size() / p : 0);
+        if (!out.empty()) predict(&X[0], out.size(), &out[0]);
+        return out;
+    }
+
+    // Predictive Beta(mu * phi, (1 - mu) * phi) shapes for n rows of X
+    void predictShapes(const double* X, size_t n, double* alpha, double* beta) const {
+        predict(X, n, alpha);
+        for (size_t i = 0; i < n; i++) {
+            double mi = clampMu(alpha[i]);
+            alpha[i] = mi * phi;
+            beta[i] = (1.0 - mi) * phi;
+        }
+    }
+
+    // Predict m quantile levels (ascending) per row; out is row-major n x m
+    void predictQuantiles(const double* X, size_t n, const double* levels, size_t m, double* out) const {
+        std::vector<double> alpha(n), beta(n);
+        predictShapes(X, n, &alpha[0], &beta[0]);
+        betaQuantiles(&alpha[0], &beta[0], n, levels, m, out);
+    }
+
+    std::vector<double> predictQuantile(const std::vector<double>& X, double quantile) const {
+        size_t p = coefficients.size();
+        std::vector<double> out(p ? X.size() / p : 0);
+        if (!out.empty()) predictQuantiles(&X[0], out.size(), &quantile, 1, &out[0]);
+        return out;
+    }
+
+    // Log-likelihood of (X, y) under the current parameters
+    double computeLogLikelihood(const double* X, const double* y, size_t n) {
+        prepareResponse(y, n);
+        return logLikelihood(X, n, coefficients.size(), &coefficients[0], std::log(phi));
+    }
+
+    // Keep log(y) and log(1 - y) of one response for repeated
+    // computeLogLikelihood(X, n) passes; call again whenever y changes.
+    // A later fit() or computeLogLikelihood(X, y, n) discards it.
+    void setResponse(const double* y, size_t n) {
+        prepareResponse(y, n);
+        response_n = n;
+        response_set = true;
+    }
+
+    // Log-likelihood of X against the setResponse() response
+    double computeLogLikelihood(const double* X, size_t n) {
+        if (!response_set || n != response_n) {
+            throw std::invalid_argument("BetaRegression::computeLogLikelihood: no response of this size set");
+        }
+        return logLikelihood(X, n, coefficients.size(), &coefficients[0], std::log(phi));
+    }
+
+    // Getters
+    const std::vector<double>& getCoefficients() const { return coefficients; }
+    double getPhi() const { return phi; }
+    double getLogLikelihood() const { return loglik; }
+    int getIterations() const { return iterations; }
+    bool hasConverged() const { return converged; }
+};
+
+#endif
@@ -0,0 +1,156 @@
+/**
+ * Counter-Based Random Numbers
+ * Philox4x32-10 (Salmon et al., "Parallel random numbers: as easy as 1, 2, 3")
+ *
+ * Every value is a pure function of (seed, stream, index), so any worker can
+ * generate any part of a sequence without shared state or skip-ahead, and
+ * results do not depend on how work is split across threads. Each 128-bit
+ * counter (64-bit block index, 64-bit stream) gives four 32-bit words. With
+ * AVX2 enabled, four counters are processed per step.
+ */
+
+#ifndef COUNTER_RNG_H
+#define COUNTER_RNG_H
+
+#include <cstdint>
+#include <cstddef>
+#include <cmath>
+
+#include "special_functions.h"
+
+#if defined(__AVX2__)
+#include <immintrin.h>
+#define COUNTER_RNG_AVX2 1
+#endif
+
+const uint32_t PHILOX_M0 = 0xD2511F53;
+const uint32_t PHILOX_M1 = 0xCD9E8D57;
+const uint32_t PHILOX_W0 = 0x9E3779B9;          // key schedule (golden ratio)
+const uint32_t PHILOX_W1 = 0xBB67AE85;          // key schedule (sqrt(3) - 1)
+const int PHILOX_ROUNDS = 10;
+
+// One Philox4x32-10 block: out = bijection_key(ctr)
+inline void philox4x32(const uint32_t ctr[4], const uint32_t key[2], uint32_t out[4]) {
+    uint32_t x0 = ctr[0], x1 = ctr[1], x2 = ctr[2], x3 = ctr[3];
+    uint32_t k0 = key[0], k1 = key[1];
+    for (int r = 0; r < PHILOX_ROUNDS; r++) {
+        uint64_t p0 = (uint64_t)PHILOX_M0 * x0;
+        uint64_t p1 = (uint64_t)PHILOX_M1 * x2;
+        uint32_t y0 = (uint32_t)(p1 >> 32) ^ x1 ^ k0;
+        uint32_t y2 = (uint32_t)(p0 >> 32) ^ x3 ^ k1;
+        x1 = (uint32_t)p1;
+        x3 = (uint32_t)p0;
+        x0 = y0;
+        x2 = y2;
+        k0 += PHILOX_W0;
+        k1 += PHILOX_W1;
+    }
+    out[0] = x0;
+    out[1] = x1;
+    out[2] = x2;
+    out[3] = x3;
+}
+
+// 32-bit word to a uniform in the open interval (0, 1)
+inline double uniformFromBits(uint32_t bits) {
+    return ((double)bits + 0.5) * (1.0 / 4294967296.0);
+}
+
+class CounterRng {
+private:
+    uint32_t key[2];
+
+    void counter(uint64_t block, uint64_t stream, uint32_t ctr[4]) const {
+        ctr[0] = (uint32_t)block;
+        ctr[1] = (uint32_t)(block >> 32);
+        ctr[2] = (uint32_t)stream;
+        ctr[3] = (uint32_t)(stream >> 32);
+    }
+
+#ifdef COUNTER_RNG_AVX2
+    // Uniforms of blocks [block, block + 4) of a stream, in sequence order
+    void uniforms4(uint64_t block, uint64_t stream, double* out) const {
+        const __m256i low = _mm256_set1_epi64x(0xFFFFFFFF);
+        const __m256i m0 = _mm256_set1_epi64x(PHILOX_M0);
+        const __m256i m1 = _mm256_set1_epi64x(PHILOX_M1);
+        // One counter per 64-bit lane, each word held in the low 32 bits
+        __m256i b = _mm256_add_epi64(_mm256_set1_epi64x((long long)block), _mm256_setr_epi64x(0, 1, 2, 3));
+        __m256i x0 = _mm256_and_si256(b, low);
+        __m256i x1 = _mm256_srli_epi64(b, 32);
+        __m256i x2 = _mm256_set1_epi64x((uint32_t)stream);
+        __m256i x3 = _mm256_set1_epi64x((uint32_t)(stream >> 32));
+        uint32_t k0 = key[0], k1 = key[1];
+        for (int r = 0; r < PHILOX_ROUNDS; r++) {
+            __m256i p0 = _mm256_mul_epu32(x0, m0);
+            __m256i p1 = _mm256_mul_epu32(x2, m1);
+            __m256i y0 = _mm256_xor_si256(_mm256_xor_si256(_mm256_srli_epi64(p1, 32), x1),
+                                          _mm256_set1_epi64x(k0));
+            __m256i y2 = _mm256_xor_si256(_mm256_xor_si256(_mm256_srli_epi64(p0, 32), x3),
+                                          _mm256_set1_epi64x(k1));
+            x1 = _mm256_and_si256(p1, low);
+            x3 = _mm256_and_si256(p0, low);
+            x0 = y0;
+            x2 = y2;
+            k0 += PHILOX_W0;
+            k1 += PHILOX_W1;
+        }
+
+        // Exact uint32 -> double via the 2^52 exponent trick, then (w + 0.5) / 2^32
+        const __m256i magic_bits = _mm256_set1_epi64x(0x4330000000000000LL);
+        const __m256d magic = _mm256_set1_pd(4503599627370496.0);
+        const __m256d half = _mm256_set1_pd(0.5);
+        const __m256d scale = _mm256_set1_pd(1.0 / 4294967296.0);
+        __m256i words[4] = { x0, x1, x2, x3 };
+        __m256d u[4];
+        for (int w = 0; w < 4; w++) {
+            __m256d v = _mm256_sub_pd(_mm256_castsi256_pd(_mm256_or_si256(words[w], magic_bits)), magic);
+            u[w] = _mm256_mul_pd(_mm256_add_pd(v, half), scale);
+        }
+
+        // Transpose word-major lanes to block-major order
+        __m256d t0 = _mm256_unpacklo_pd(u[0], u[1]);
+        __m256d t1 = _mm256_unpackhi_pd(u[0], u[1]);
+        __m256d t2 = _mm256_unpacklo_pd(u[2], u[3]);
+        __m256d t3 = _mm256_unpackhi_pd(u[2], u[3]);
+        _mm256_storeu_pd(out, _mm256_permute2f128_pd(t0, t2, 0x20));
+        _mm256_storeu_pd(out + 4, _mm256_permute2f128_pd(t1, t3, 0x20));
+        _mm256_storeu_pd(out + 8, _mm256_permute2f128_pd(t0, t2, 0x31));
+        _mm256_storeu_pd(out + 12, _mm256_permute2f128_pd(t1, t3, 0x31));
+    }
+#endif
+
+public:
+    explicit CounterRng(uint64_t seed = 0) {
+        key[0] = (uint32_t)seed;
+        key[1] = (uint32_t)(seed >> 32);
+    }
+
+    // The four words of one block
+    void block(uint64_t index, uint64_t stream, uint32_t out[4]) const {
+        uint32_t ctr[4];
+        counter(index, stream, ctr);
+        philox4x32(ctr, key, out);
+    }
+
+    // Values [4 * first_block, 4 * first_block + n) of a stream as uniforms in (0, 1)
+    void uniforms(uint64_t stream, uint64_t first_block, double* out, size_t n) const {
+        size_t i = 0;
+#ifdef COUNTER_RNG_AVX2
+        for (; i + 16 <= n; i += 16) uniforms4(first_block + i / 4, stream, out + i);
+#endif
+        for (; i < n; i += 4) {
+            uint32_t words[4];
+            block(first_block + i / 4, stream, words);
+            for (size_t w = 0; w < 4 && i + w < n; w++) out[i + w] = uniformFromBits(words[w]);
+        }
+    }
+
+    // Standard normals by inversion, one per uniform (so value i of the
+    // normal sequence is the image of uniform i)
+    void normals(uint64_t stream, uint64_t first_block, double* out, size_t n) const {
+        uniforms(stream, first_block, out, n);
+        normalQuantileArray(out, out, n);
+    }
+};
+
+#endif
@@ -0,0 +1,393 @@
+/**
+ * Battery Dispatch Optimizer
+ * Stochastic dynamic programming over a discretized state of charge
+ * Plans battery charge/discharge and backup activation over a 24-72h horizon
+ * of scenario forecasts, minimizing expected backup energy and curtailment
+ *
+ * Replaces the greedy thresholds of recommendAction() / generateRealtimeData()
+ * (discharge above 0.3, charge below 0.9, no lookahead). Each hour t, with
+ * net = generation - demand observed before dispatching it (as the control
+ * loop does) and later hours known only through their scenarios:
+ *
+ *   V_t(s) = E_w[ min_d  cost(net_t,w, d) + V_t+1(s + d) ]
+ *   cost   = backup_cost * max(0, -r) + curtailment_cost * max(0, r) + cycling_cost * |e|
+ *   r      = net - e / charge_efficiency  (e > 0, charging)
+ *            net - e * discharge_efficiency  (e < 0, discharging)
+ *
+ * where d is a step on the state-of-charge grid within the power limits and
+ * e = d * capacity / (soc_levels - 1). V at the end of the horizon credits
+ * stored energy at terminal_value. Scenarios of an hour are treated as
+ * equally likely and independent of the previous hour's (stage-wise
+ * independence); the plan statistics then follow each scenario path with the
+ * resulting policy.
+ *
+ * Values are single precision and scenarios are padded to lanes of 8, so with
+ * AVX2 enabled the minimum over steps runs over 8 scenarios at a time;
+ * infeasible steps read +inf from padding around each value row.
+ */
+
+#ifndef DISPATCH_OPTIMIZER_H
+#define DISPATCH_OPTIMIZER_H
+
+#include <vector>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <stdexcept>
+#include <algorithm>
+
+#include "grid_recommend.h"
+#include "thread_pool.h"
+
+#if defined(__AVX2__)
+#include <immintrin.h>
+#define DISPATCH_AVX2 1
+#endif
+
+const int DISPATCH_MAX_HOURS = 72;
+const int DISPATCH_LANES = 8;
+
+// Energies are in hours of unit net generation (the solar + wind - demand
+// scale of GridState); capacity 4 holds four hours of a unit deficit
+struct DispatchConfig {
+    int horizon;                                // hours planned, 1..DISPATCH_MAX_HOURS
+    int soc_levels;                             // state-of-charge grid points, empty to full
+    double capacity;                            // battery energy
+    double max_charge, max_discharge;           // battery-side energy per hour
+    double charge_efficiency, discharge_efficiency;
+    double backup_cost, curtailment_cost;       // per unit of energy
+    double cycling_cost;                        // per unit of energy moved in or out
+    double terminal_value;                      // credit per unit stored at the end
+};
+
+inline DispatchConfig defaultDispatchConfig() {
+    DispatchConfig c = { 48, 21, 4.0, 1.0, 1.0, 0.95, 0.95, 1.0, 0.2, 0.01, 0.5 };
+    return c;
+}
+
+// Scenario net generation, row-major [site][hour][scenario], hours >= horizon
+struct DispatchInputs {
+    const float* net;
+    const float* initial_soc;                   // per site, fraction of capacity
+    size_t sites;
+    int hours;
+    int scenarios;
+};
+
+// Per site and hour (row-major [site][hour]): means over scenario paths
+// following the optimal policy from the initial state of charge
+struct DispatchPlan {
+    size_t sites;
+    int hours;
+    int soc_levels;
+    std::vector<float> soc;                     // at the start of the hour, fraction of capacity
+    std::vector<float> flow;                    // battery-side energy, + charge / - discharge
+    std::vector<float> backup_probability;
+    std::vector<float> backup, curtailment;     // expected energy
+    std::vector<float> expected_cost;           // per site, V_0 at the initial level
+    std::vector<float> values;                  // [site][hour + 1][level] if kept, else empty
+};
+
+// One hour's decision for an observed net generation
+struct DispatchStep {
+    int step;                                   // state-of-charge grid steps, + charge
+    double flow, backup, curtailment, cost;
+    GridAction action;
+};
+
+class DispatchOptimizer {
+private:
+    DispatchConfig config;
+    double level_energy;
+    int max_up, max_down;                       // grid steps per hour
+    int actions;
+    std::vector<int> steps;                     // 0, -1, +1, -2, +2, ... (ties keep smaller moves)
+    std::vector<float> grid_draw;               // energy drawn from the net per step
+    std::vector<float> step_cost;               // cycling cost per step
+
+    struct Workspace {
+        std::vector<float> net;                 // one hour's scenarios, zero-padded to whole lanes
+        std::vector<float> immediate;           // [hour][action][lane]
+        std::vector<float> values;              // [hour + 1][max_down + level + max_up], padded with +inf
+        std::vector<float> best;
+        std::vector<int> level;                 // per scenario path in the forward pass
+    };
+
+    int row() const { return max_down + config.soc_levels + max_up; }
+
+    int lanes(int scenarios) const { return (scenarios + DISPATCH_LANES - 1) / DISPATCH_LANES * DISPATCH_LANES; }
+
+#ifdef DISPATCH_AVX2
+    static float horizontalSum(__m256 v) {
+        __m128 half = _mm_add_ps(_mm256_castps256_ps128(v), _mm256_extractf128_ps(v, 1));
+        half = _mm_add_ps(half, _mm_movehl_ps(half, half));
+        half = _mm_add_ss(half, _mm_shuffle_ps(half, half, 1));
+        return _mm_cvtss_f32(half);
+    }
+
+    // All ones on lanes w + k < scenarios
+    static __m256 realLanes(int w, int scenarios) {
+        __m256i lane = _mm256_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7);
+        return _mm256_castsi256_ps(_mm256_cmpgt_epi32(_mm256_set1_epi32(scenarios - w), lane));
+    }
+#endif
+
+    // Immediate cost of every step for one hour's (padded) scenarios
+    void immediateCosts(const float* net, int padded, float* out) const {
+        const float backup = (float)config.backup_cost, curtail = (float)config.curtailment_cost;
+        for (int a = 0; a < actions; a++) {
+            float* c = out + (size_t)a * padded;
+            int w = 0;
+#ifdef DISPATCH_AVX2
+            const __m256 zero = _mm256_setzero_ps();
+            const __m256 draw = _mm256_set1_ps(grid_draw[a]), fixed = _mm256_set1_ps(step_cost[a]);
+            const __m256 vb = _mm256_set1_ps(backup), vc = _mm256_set1_ps(curtail);
+            for (; w < padded; w += DISPATCH_LANES) {
+                __m256 r = _mm256_sub_ps(_mm256_loadu_ps(net + w), draw);
+                __m256 cost = _mm256_add_ps(_mm256_mul_ps(vb, _mm256_max_ps(zero, _mm256_sub_ps(zero, r))),
+                                            _mm256_mul_ps(vc, _mm256_max_ps(zero, r)));
+                _mm256_storeu_ps(c + w, _mm256_add_ps(cost, fixed));
+            }
+#endif
+            for (; w < padded; w++) {
+                float r = net[w] - grid_draw[a];
+                c[w] = backup * std::max(0.0f, -r) + curtail * std::max(0.0f, r) + step_cost[a];
+            }
+        }
+    }
+
+    // V_t from V_t+1 (both padded rows); weight is 1 / scenarios on real lanes
+    void backwardStep(const float* immediate, int scenarios, int padded, const float* next, float* current,
+                      float* best) const {
+        const float inf = std::numeric_limits<float>::infinity();
+        const float weight = 1.0f / scenarios;
+        for (int s = 0; s < config.soc_levels; s++) {
+            const float* v = next + max_down + s;
+            int w = 0;
+#ifdef DISPATCH_AVX2
+            (void)best;
+            __m256 sum = _mm256_setzero_ps();
+            for (; w < padded; w += DISPATCH_LANES) {
+                __m256 m = _mm256_set1_ps(inf);
+                for (int a = 0; a < actions; a++) {
+                    __m256 c = _mm256_add_ps(_mm256_loadu_ps(immediate + (size_t)a * padded + w),
+                                             _mm256_set1_ps(v[steps[a]]));
+                    m = _mm256_min_ps(m, c);
+                }
+                // Padding lanes sit past the last scenario; drop them from the sum
+                if (w + DISPATCH_LANES > scenarios) m = _mm256_and_ps(m, realLanes(w, scenarios));
+                sum = _mm256_add_ps(sum, m);
+            }
+            current[max_down + s] = horizontalSum(sum) * weight;
+#else
+            for (w = 0; w < scenarios; w++) best[w] = inf;
+            for (int a = 0; a < actions; a++) {
+                const float* c = immediate + (size_t)a * padded;
+                float next_value = v[steps[a]];
+                for (w = 0; w < scenarios; w++) best[w] = std::min(best[w], c[w] + next_value);
+            }
+            float sum = 0.0f;
+            for (w = 0; w < scenarios; w++) sum += best[w];
+            current[max_down + s] = sum * weight;
+#endif
+        }
+    }
+
+    // Follow every scenario path from the initial level with the optimal policy
+    void forwardPass(const DispatchInputs& in, size_t site, Workspace& ws, int padded, DispatchPlan& plan) const {
+        const int scenarios = in.scenarios, width = row();
+        const float weight = 1.0f / scenarios;
+        const float top = (float)(config.soc_levels - 1), energy = (float)level_energy;
+        const int start = levelOf(in.initial_soc[site]);
+        ws.level.assign(padded, start);
+        for (int t = 0; t < config.horizon; t++) {
+            const float* immediate = &ws.immediate[(size_t)t * actions * padded];
+            const float* next = &ws.values[(size_t)(t + 1) * width];
+            const float* net = in.net + (site * in.hours + t) * in.scenarios;
+            std::copy(net, net + scenarios, ws.net.begin());
+            float soc = 0.0f, flow = 0.0f, backup_paths = 0.0f, backup = 0.0f, curtail = 0.0f;
+            int w = 0;
+#ifdef DISPATCH_AVX2
+            const __m256 zero = _mm256_setzero_ps(), one = _mm256_set1_ps(1.0f);
+            const __m256 all = _mm256_castsi256_ps(_mm256_set1_epi32(-1));
+            __m256 soc_sum = zero, flow_sum = zero, paths_sum = zero, backup_sum = zero, curtail_sum = zero;
+            for (; w < padded; w += DISPATCH_LANES) {
+                // Best step per lane; value rows are gathered at max_down + level + step
+                __m256i s = _mm256_loadu_si256((const __m256i*)&ws.level[w]);
+                __m256i base = _mm256_add_epi32(s, _mm256_set1_epi32(max_down));
+                __m256 best = _mm256_add_ps(_mm256_loadu_ps(immediate + w),
+                                            _mm256_mask_i32gather_ps(zero, next, base, all, 4));
+                __m256i chosen = _mm256_setzero_si256();
+                __m256 draw = _mm256_set1_ps(grid_draw[0]);
+                for (int a = 1; a < actions; a++) {
+                    __m256i step = _mm256_set1_epi32(steps[a]);
+                    __m256 c = _mm256_add_ps(_mm256_loadu_ps(immediate + (size_t)a * padded + w),
+                                             _mm256_mask_i32gather_ps(zero, next, _mm256_add_epi32(base, step), all, 4));
+                    __m256 better = _mm256_cmp_ps(c, best, _CMP_LT_OQ);
+                    best = _mm256_blendv_ps(best, c, better);
+                    chosen = _mm256_castps_si256(_mm256_blendv_ps(_mm256_castsi256_ps(chosen),
+                                                                  _mm256_castsi256_ps(step), better));
+                    draw = _mm256_blendv_ps(draw, _mm256_set1_ps(grid_draw[a]), better);
+                }
+                __m256 keep = w + DISPATCH_LANES > scenarios ? realLanes(w, scenarios) : all;
+                __m256 r = _mm256_sub_ps(_mm256_loadu_ps(&ws.net[w]), draw);
+                soc_sum = _mm256_add_ps(soc_sum, _mm256_and_ps(keep, _mm256_cvtepi32_ps(s)));
+                flow_sum = _mm256_add_ps(flow_sum, _mm256_and_ps(keep, _mm256_cvtepi32_ps(chosen)));
+                paths_sum = _mm256_add_ps(paths_sum, _mm256_and_ps(keep, _mm256_and_ps(one, _mm256_cmp_ps(r, zero, _CMP_LT_OQ))));
+                backup_sum = _mm256_add_ps(backup_sum, _mm256_and_ps(keep, _mm256_max_ps(zero, _mm256_sub_ps(zero, r))));
+                curtail_sum = _mm256_add_ps(curtail_sum, _mm256_and_ps(keep, _mm256_max_ps(zero, r)));
+                _mm256_storeu_si256((__m256i*)&ws.level[w], _mm256_add_epi32(s, chosen));
+            }
+            soc = horizontalSum(soc_sum) / top;
+            flow = horizontalSum(flow_sum) * energy;
+            backup_paths = horizontalSum(paths_sum);
+            backup = horizontalSum(backup_sum);
+            curtail = horizontalSum(curtail_sum);
+#else
+            for (; w < scenarios; w++) {
+                int s = ws.level[w], chosen = 0;
+                float best = immediate[w] + next[max_down + s];
+                for (int a = 1; a < actions; a++) {
+                    float c = immediate[(size_t)a * padded + w] + next[max_down + s + steps[a]];
+                    if (c < best) {
+                        best = c;
+                        chosen = a;
+                    }
+                }
+                float r = net[w] - grid_draw[chosen];
+                soc += s / top;
+                flow += steps[chosen] * energy;
+                backup_paths += r < 0.0f;
+                backup += std::max(0.0f, -r);
+                curtail += std::max(0.0f, r);
+                ws.level[w] = s + steps[chosen];
+            }
+#endif
+            size_t k = site * plan.hours + t;
+            plan.soc[k] = soc * weight;
+            plan.flow[k] = flow * weight;
+            plan.backup_probability[k] = backup_paths * weight;
+            plan.backup[k] = backup * weight;
+            plan.curtailment[k] = curtail * weight;
+        }
+        plan.expected_cost[site] = ws.values[max_down + start];
+    }
+
+    void solveSite(const DispatchInputs& in, size_t site, Workspace& ws, DispatchPlan& plan) const {
+        const int padded = lanes(in.scenarios), width = row();
+        const float inf = std::numeric_limits<float>::infinity();
+        ws.immediate.resize((size_t)config.horizon * actions * padded);
+        ws.values.assign((size_t)(config.horizon + 1) * width, inf);
+        ws.best.resize(padded);
+        ws.net.assign(padded, 0.0f);
+
+        float* terminal = &ws.values[(size_t)config.horizon * width] + max_down;
+        for (int s = 0; s < config.soc_levels; s++) terminal[s] = (float)(-config.terminal_value * s * level_energy);
+
+        for (int t = config.horizon - 1; t >= 0; t--) {
+            float* immediate = &ws.immediate[(size_t)t * actions * padded];
+            const float* net = in.net + (site * in.hours + t) * in.scenarios;
+            std::copy(net, net + in.scenarios, ws.net.begin());
+            immediateCosts(&ws.net[0], padded, immediate);
+            backwardStep(immediate, in.scenarios, padded, &ws.values[(size_t)(t + 1) * width],
+                         &ws.values[(size_t)t * width], &ws.best[0]);
+        }
+        forwardPass(in, site, ws, padded, plan);
+
+        if (!plan.values.empty()) {
+            float* out = &plan.values[site * (config.horizon + 1) * config.soc_levels];
+            for (int t = 0; t <= config.horizon; t++) {
+                std::copy(&ws.values[(size_t)t * width + max_down],
+                          &ws.values[(size_t)t * width + max_down + config.soc_levels],
+                          out + (size_t)t * config.soc_levels);
+            }
+        }
+    }
+
+public:
+    explicit DispatchOptimizer(const DispatchConfig& c = defaultDispatchConfig()) : config(c) {
+        if (c.horizon < 1 || c.horizon > DISPATCH_MAX_HOURS || c.soc_levels < 2 || !(c.capacity > 0.0) ||
+            c.max_charge < 0.0 || c.max_discharge < 0.0 || !(c.charge_efficiency > 0.0) ||
+            !(c.discharge_efficiency > 0.0) || c.charge_efficiency > 1.0 || c.discharge_efficiency > 1.0) {
+            throw std::invalid_argument("DispatchOptimizer: invalid horizon, grid, capacity or efficiencies");
+        }
+        level_energy = c.capacity / (c.soc_levels - 1);
+        max_up = std::min(c.soc_levels - 1, (int)std::floor(c.max_charge / level_energy + 1e-9));
+        max_down = std::min(c.soc_levels - 1, (int)std::floor(c.max_discharge / level_energy + 1e-9));
+        steps.push_back(0);
+        for (int k = 1; k <= std::max(max_up, max_down); k++) {
+            if (k <= max_down) steps.push_back(-k);
+            if (k <= max_up) steps.push_back(k);
+        }
+        actions = (int)steps.size();
+        for (int a = 0; a < actions; a++) {
+            double e = steps[a] * level_energy;
+            grid_draw.push_back((float)(e > 0.0 ? e / c.charge_efficiency : e * c.discharge_efficiency));
+            step_cost.push_back((float)(c.cycling_cost * std::fabs(e)));
+        }
+    }
+
+    const DispatchConfig& settings() const { return config; }
+    int stepCount() const { return actions; }
+
+    // Nearest state-of-charge grid level of a fraction of capacity
+    int levelOf(double soc) const {
+        double x = std::min(1.0, std::max(0.0, soc));
+        return (int)std::floor(x * (config.soc_levels - 1) + 0.5);
+    }
+
+    // Best step from `level` for an observed net, given the next hour's values
+    // (a DispatchPlan::values row); used to act on a plan between refreshes
+    DispatchStep decide(const float* next_values, int level, double net) const {
+        DispatchStep best = { 0, 0.0, 0.0, 0.0, std::numeric_limits<double>::infinity(), ACTION_NOMINAL_OPERATION };
+        for (int a = 0; a < actions; a++) {
+            int s = level + steps[a];
+            if (s < 0 || s >= config.soc_levels) continue;
+            double r = net - grid_draw[a];
+            double cost = config.backup_cost * std::max(0.0, -r) + config.curtailment_cost * std::max(0.0, r) +
+                          step_cost[a] + next_values[s];
+            if (cost < best.cost) {
+                best.step = steps[a];
+                best.flow = steps[a] * level_energy;
+                best.backup = std::max(0.0, -r);
+                best.curtailment = std::max(0.0, r);
+                best.cost = cost;
+            }
+        }
+        // Backup outranks battery moves, as in the rule table of grid_recommend.h
+        best.action = best.backup > 0.0 ? ACTION_ACTIVATE_BACKUP
+                    : best.step < 0 ? ACTION_DISCHARGE_BATTERY
+                    : best.curtailment > 0.0 ? ACTION_CURTAIL_GENERATION
+                    : best.step > 0 ? ACTION_CHARGE_BATTERY
+                    : ACTION_NOMINAL_OPERATION;
+        return best;
+    }
+
+    // Solve every site; keep_values stores V for decide() (horizon + 1 rows of
+    // soc_levels floats per site)
+    void solve(ThreadPool& pool, const DispatchInputs& in, DispatchPlan& plan, bool keep_values = false) const {
+        if (in.scenarios < 1 || in.hours < config.horizon || (in.sites > 0 && (!in.net || !in.initial_soc))) {
+            throw std::invalid_argument("DispatchOptimizer::solve: need scenarios for every hour of the horizon");
+        }
+        size_t cells = in.sites * config.horizon;
+        plan.sites = in.sites;
+        plan.hours = config.horizon;
+        plan.soc_levels = config.soc_levels;
+        plan.soc.assign(cells, 0.0f);
+        plan.flow.assign(cells, 0.0f);
+        plan.backup_probability.assign(cells, 0.0f);
+        plan.backup.assign(cells, 0.0f);
+        plan.curtailment.assign(cells, 0.0f);
+        plan.expected_cost.assign(in.sites, 0.0f);
+        if (keep_values) plan.values.assign(in.sites * (config.horizon + 1) * config.soc_levels, 0.0f);
+        else plan.values.clear();
+
+        std::vector<Workspace> workspaces(pool.size());
+        pool.parallelFor(in.sites, 64, [&](size_t begin, size_t end, size_t worker) {
+            for (size_t site = begin; site < end; site++) solveSite(in, site, workspaces[worker], plan);
+        });
+    }
+};
+
+#endif
@@ -0,0 +1,802 @@
+/**
+ * Energy Addon
+ * Node.js N-API addon exposing FourierTransform, SeasonalDecomposition and
+ * ForecastEngine in-process, so server.js needs no child process or temp file
+ *
+ * Series are read in place from Float64Array/Float32Array arguments, and
+ * results are returned as typed arrays over the native result buffers (no
+ * copy in either direction). All heavy work runs on the libuv threadpool and
+ * resolves a Promise; inputs must not be modified until it settles.
+ *
+ *   const energy = require('./energy_addon.node');
+ *   const { magnitude, phase, dominant } = await energy.fft(series, 5);
+ *   const { trend, seasonal, residual, strength } = await energy.decompose(series, 24);
+ *   const { action, deficit, surplus, counts } = await energy.recommend({ solar, wind, demand, battery });
+ *   const engine = new energy.ForecastEngine();
+ *   await engine.train(0, 90);                  // or: await engine.loadStore('site_models.bin')
+ *   const f = await engine.forecast(0, 13, 289);  // f.solar.p50 is a Float64Array
+ *   const json = await engine.forecastJson(0, 13, 289);  // forecast_output.json shape
+ *   const grid = energy.gridState();           // shared-memory snapshot, synchronous
+ *   if (energy.gridStateVersion() !== grid.version) { ... }   // cheap change check
+ *
+ * Build: g++ -std=c++11 -O2 -march=native -shared -fPIC -pthread \
+ *          -I"$(node -p "require('path').resolve(process.execPath, '../../include/node')")" \
+ *          -o energy_addon.node energy_addon.cpp
+ */
+
+#include <string>
+#include <vector>
+#include <memory>
+#include <mutex>
+#include <map>
+#include <functional>
+#include <algorithm>
+#include <stdexcept>
+#include <cstddef>
+#include <cmath>
+#include <climits>
+
+#include <node_api.h>
+
+#include "energy_data.h"
+#include "fourier_transform.h"
+#include "forecast_service.h"
+#include "grid_state_shm.h"
+#include "grid_recommend.h"
+
+#define NAPI_CALL(env, call)                                              \
+    do {                                                                  \
+        if ((call) != napi_ok) {                                          \
+            napi_throw_error((env), 0, "N-API call failed: " #call);      \
+            return 0;                                                     \
+        }                                                                 \
+    } while (0)
+
+// Float64Array/Float32Array argument, borrowed for the lifetime of a job
+struct SeriesView {
+    const double* f64;
+    const float* f32;
+    size_t length;
+};
+
+// One Promise-returning unit of work: execute() runs on a libuv worker and
+// must not touch JS; complete() builds the resolution value on the main thread
+struct AsyncJob {
+    napi_async_work work;
+    napi_deferred deferred;
+    std::vector<napi_ref> keep_alive;
+    std::function<void()> execute;
+    std::function<napi_value(napi_env)> complete;
+    std::string error;
+};
+
+void executeJob(napi_env, void* data) {
+    AsyncJob* job = static_cast<AsyncJob*>(data);
+    try {
+        job->execute();
+    } catch (const std::exception& e) {
+        job->error = e.what();
+    }
+}
+
+void completeJob(napi_env env, napi_status status, void* data) {
+    AsyncJob* job = static_cast<AsyncJob*>(data);
+    napi_value result = 0;
+    if (status == napi_cancelled) job->error = "cancelled";
+    if (job->error.empty()) result = job->complete(env);
+
+    if (result) {
+        napi_resolve_deferred(env, job->deferred, result);
+    } else {
+        // complete() may have left a pending exception; reject with it
+        bool pending = false;
+        napi_value reason;
+        napi_is_exception_pending(env, &pending);
+        if (pending) {
+            napi_get_and_clear_last_exception(env, &reason);
+        } else {
+            napi_value message;
+            if (job->error.empty()) job->error = "unknown error";
+            napi_create_string_utf8(env, job->error.c_str(), job->error.size(), &message);
+            napi_create_error(env, 0, message, &reason);
+        }
+        napi_reject_deferred(env, job->deferred, reason);
+    }
+
+    for (size_t i = 0; i < job->keep_alive.size(); i++) napi_delete_reference(env, job->keep_alive[i]);
+    napi_delete_async_work(env, job->work);
+    delete job;
+}
+
+// Queue job and return its Promise; job is owned by the addon from here on
+napi_value queueJob(napi_env env, AsyncJob* job, const char* name) {
+    napi_value promise, resource_name;
+    if (napi_create_promise(env, &job->deferred, &promise) != napi_ok ||
+        napi_create_string_utf8(env, name, NAPI_AUTO_LENGTH, &resource_name) != napi_ok ||
+        napi_create_async_work(env, 0, resource_name, executeJob, completeJob, job, &job->work) != napi_ok ||
+        napi_queue_async_work(env, job->work) != napi_ok) {
+        for (size_t i = 0; i < job->keep_alive.size(); i++) napi_delete_reference(env, job->keep_alive[i]);
+        delete job;
+        napi_throw_error(env, 0, "Cannot queue native work");
+        return 0;
+    }
+    return promise;
+}
+
+bool keepAlive(napi_env env, AsyncJob* job, napi_value value) {
+    napi_ref ref;
+    if (napi_create_reference(env, value, 1, &ref) != napi_ok) return false;
+    job->keep_alive.push_back(ref);
+    return true;
+}
+
+bool getSeries(napi_env env, napi_value value, SeriesView& out) {
+    bool is_typed = false;
+    napi_is_typedarray(env, value, &is_typed);
+    napi_typedarray_type type;
+    void* data = 0;
+    if (!is_typed || napi_get_typedarray_info(env, value, &type, &out.length, &data, 0, 0) != napi_ok ||
+        (type != napi_float64_array && type != napi_float32_array)) {
+        napi_throw_type_error(env, 0, "Expected a Float64Array or Float32Array");
+        return false;
+    }
+    out.f64 = type == napi_float64_array ? static_cast<const double*>(data) : 0;
+    out.f32 = type == napi_float32_array ? static_cast<const float*>(data) : 0;
+    return true;
+}
+
+bool getNumber(napi_env env, napi_value value, double& out, const char* what) {
+    napi_valuetype type;
+    napi_typeof(env, value, &type);
+    if (type != napi_number || napi_get_value_double(env, value, &out) != napi_ok) {
+        std::string message = std::string("Expected a number for ") + what;
+        napi_throw_type_error(env, 0, message.c_str());
+        return false;
+    }
+    return true;
+}
+
+template <typename T>
+void deleteOwned(napi_env, void*, void* hint) {
+    delete static_cast<T*>(hint);
+}
+
+// Typed array over memory owned by *owner, which is freed when JS drops the
+// buffer; several views may share one owner through their common ArrayBuffer
+template <typename Owner>
+napi_value externalBuffer(napi_env env, Owner* owner, void* data, size_t bytes) {
+    napi_value buffer;
+    if (napi_create_external_arraybuffer(env, data, bytes, deleteOwned<Owner>, owner, &buffer) != napi_ok) {
+        delete owner;
+        return 0;
+    }
+    return buffer;
+}
+
+napi_value view(napi_env env, napi_value buffer, napi_typedarray_type type, size_t length, size_t offset) {
+    napi_value result;
+    if (napi_create_typedarray(env, type, length, buffer, offset, &result) != napi_ok) return 0;
+    return result;
+}
+
+napi_value float64Result(napi_env env, std::vector<double>* values) {
+    if (values->empty()) {
+        // External buffers need a non-null pointer; hand out a plain empty one
+        delete values;
+        napi_value buffer;
+        if (napi_create_arraybuffer(env, 0, 0, &buffer) != napi_ok) return 0;
+        return view(env, buffer, napi_float64_array, 0, 0);
+    }
+    size_t n = values->size();
+    napi_value buffer = externalBuffer(env, values, &(*values)[0], n * sizeof(double));
+    return buffer ? view(env, buffer, napi_float64_array, n, 0) : 0;
+}
+
+bool setNamed(napi_env env, napi_value object, const char* key, napi_value value) {
+    return value && napi_set_named_property(env, object, key, value) == napi_ok;
+}
+
+napi_value number(napi_env env, double value) {
+    napi_value result;
+    napi_create_double(env, value, &result);
+    return result;
+}
+
+// ---------------------------------------------------------------------------
+// fft(series, topK = 5) -> Promise<{ magnitude, phase, dominant: [{ index, period, magnitude }] }>
+// ---------------------------------------------------------------------------
+
+struct SpectrumResult {
+    std::unique_ptr<std::vector<double> > magnitude;
+    std::unique_ptr<std::vector<double> > phase;
+    std::vector<std::pair<int, double> > dominant;
+    size_t padded;
+};
+
+napi_value fft(napi_env env, napi_callback_info info) {
+    size_t argc = 2;
+    napi_value argv[2];
+    NAPI_CALL(env, napi_get_cb_info(env, info, &argc, argv, 0, 0));
+    SeriesView series;
+    double top_k = 5;
+    if (argc < 1 || !getSeries(env, argv[0], series)) return 0;
+    if (argc > 1 && !getNumber(env, argv[1], top_k, "topK")) return 0;
+
+    // The spectrum has padded / 2 bins, padded being the power of two >= length
+    size_t padded = 1;
+    while (padded < series.length) padded *= 2;
+    double bins = (double)(padded / 2);
+    if (argc < 2) top_k = std::min(top_k, bins);
+    if (!(top_k >= 0 && top_k <= bins) || top_k != std::floor(top_k)) {
+        std::string message = "topK must be an integer in [0, " + std::to_string(padded / 2) + "]";
+        napi_throw_range_error(env, 0, message.c_str());
+        return 0;
+    }
+
+    AsyncJob* job = new AsyncJob();
+    if (!keepAlive(env, job, argv[0])) {
+        delete job;
+        napi_throw_error(env, 0, "Cannot reference input");
+        return 0;
+    }
+
+    std::shared_ptr<SpectrumResult> result = std::make_shared<SpectrumResult>();
+    result->magnitude.reset(new std::vector<double>());
+    result->phase.reset(new std::vector<double>());
+    int k = (int)top_k;
+
+    job->execute = [series, result, k]() {
+        FourierTransform ft = series.f64 ? FourierTransform(series.f64, series.length)
+                                         : FourierTransform(series.f32, series.length);
+        ft.compute();
+        *result->magnitude = ft.getMagnitudeSpectrum();
+        *result->phase = ft.getPhaseSpectrum();
+        result->dominant = ft.getDominantFrequencies(k);
+        result->padded = result->magnitude->size() * 2;
+    };
+    job->complete = [result, series](napi_env env) -> napi_value {
+        napi_value out, dominant;
+        if (napi_create_object(env, &out) != napi_ok) return 0;
+        // Ownership of the spectra moves to the returned buffers
+        if (!setNamed(env, out, "magnitude", float64Result(env, result->magnitude.release()))) return 0;
+        if (!setNamed(env, out, "phase", float64Result(env, result->phase.release()))) return 0;
+
+        if (napi_create_array_with_length(env, result->dominant.size(), &dominant) != napi_ok) return 0;
+        for (size_t i = 0; i < result->dominant.size(); i++) {
+            napi_value entry;
+            if (napi_create_object(env, &entry) != napi_ok) return 0;
+            int index = result->dominant[i].first;
+            setNamed(env, entry, "index", number(env, index));
+            setNamed(env, entry, "period", number(env, (double)result->padded / index));
+            setNamed(env, entry, "magnitude", number(env, result->dominant[i].second));
+            napi_set_element(env, dominant, i, entry);
+        }
+        setNamed(env, out, "dominant", dominant);
+        setNamed(env, out, "paddedLength", number(env, (double)result->padded));
+        return out;
+    };
+    return queueJob(env, job, "energy.fft");
+}
+
+// ---------------------------------------------------------------------------
+// decompose(series, period = 24) -> Promise<{ trend, seasonal, residual, strength }>
+// ---------------------------------------------------------------------------
+
+struct DecompositionResult {
+    std::unique_ptr<std::vector<double> > parts[3];    // trend, seasonal, residual
+    double strength;
+};
+
+napi_value decompose(napi_env env, napi_callback_info info) {
+    size_t argc = 2;
+    napi_value argv[2];
+    NAPI_CALL(env, napi_get_cb_info(env, info, &argc, argv, 0, 0));
+    SeriesView series;
+    double period = 24;
+    if (argc < 1 || !getSeries(env, argv[0], series)) return 0;
+    if (argc > 1 && !getNumber(env, argv[1], period, "period")) return 0;
+    if (series.length == 0 || !(period >= 1 && period <= INT_MAX)) {
+        napi_throw_range_error(env, 0, "Series must be non-empty and period a finite number >= 1");
+        return 0;
+    }
+
+    AsyncJob* job = new AsyncJob();
+    if (!keepAlive(env, job, argv[0])) {
+        delete job;
+        napi_throw_error(env, 0, "Cannot reference input");
+        return 0;
+    }
+
+    std::shared_ptr<DecompositionResult> result = std::make_shared<DecompositionResult>();
+    for (int i = 0; i < 3; i++) result->parts[i].reset(new std::vector<double>());
+    int period_length = (int)period;
+
+    job->execute = [series, result, period_length]() {
+        SeasonalDecomposition decomp = series.f64
+            ? SeasonalDecomposition(series.f64, series.length, period_length)
+            : SeasonalDecomposition(series.f32, series.length, period_length);
+        decomp.decompose();
+        *result->parts[0] = decomp.getTrend();
+        *result->parts[1] = decomp.getSeasonal();
+        *result->parts[2] = decomp.getResidual();
+        result->strength = decomp.getSeasonalityStrength();
+    };
+    job->complete = [result](napi_env env) -> napi_value {
+        napi_value out;
+        if (napi_create_object(env, &out) != napi_ok) return 0;
+        const char* names[3] = { "trend", "seasonal", "residual" };
+        for (int i = 0; i < 3; i++) {
+            if (!setNamed(env, out, names[i], float64Result(env, result->parts[i].release()))) return 0;
+        }
+        setNamed(env, out, "strength", number(env, result->strength));
+        return out;
+    };
+    return queueJob(env, job, "energy.decompose");
+}
+
+// ---------------------------------------------------------------------------
+// ForecastEngine
+// ---------------------------------------------------------------------------
+
+// Forecasts read an immutable engine snapshot; train/loadStore build the next
+// engine off-thread (one update at a time) and swap it in
+struct EngineHandle {
+    std::mutex mutex;
+    std::mutex update;
+    std::shared_ptr<const ForecastEngine> engine;
+
+    EngineHandle() : engine(std::make_shared<ForecastEngine>()) {}
+
+    std::shared_ptr<const ForecastEngine> snapshot() {
+        std::lock_guard<std::mutex> lock(mutex);
+        return engine;
+    }
+
+    void install(const std::shared_ptr<const ForecastEngine>& next) {
+        std::lock_guard<std::mutex> lock(mutex);
+        engine = next;
+    }
+};
+
+void deleteEngineHandle(napi_env, void* data, void*) {
+    delete static_cast<EngineHandle*>(data);
+}
+
+napi_value engineConstructor(napi_env env, napi_callback_info info) {
+    napi_value self;
+    NAPI_CALL(env, napi_get_cb_info(env, info, 0, 0, &self, 0));
+    EngineHandle* handle = new EngineHandle();
+    if (napi_wrap(env, self, handle, deleteEngineHandle, 0, 0) != napi_ok) {
+        delete handle;
+        napi_throw_error(env, 0, "Cannot wrap ForecastEngine");
+        return 0;
+    }
+    return self;
+}
+
+// Unwrap this, reading up to max_args arguments; keeps this alive in job
+EngineHandle* engineCall(napi_env env, napi_callback_info info, napi_value* argv, size_t& argc,
+                         AsyncJob*& job) {
+    napi_value self;
+    size_t capacity = argc;
+    void* data = 0;
+    if (napi_get_cb_info(env, info, &argc, argv, &self, 0) != napi_ok ||
+        napi_unwrap(env, self, &data) != napi_ok) {
+        napi_throw_type_error(env, 0, "Not a ForecastEngine");
+        return 0;
+    }
+    if (argc > capacity) argc = capacity;
+    job = new AsyncJob();
+    if (!keepAlive(env, job, self)) {
+        delete job;
+        job = 0;
+        napi_throw_error(env, 0, "Cannot reference ForecastEngine");
+        return 0;
+    }
+    return static_cast<EngineHandle*>(data);
+}
+
+void discardJob(napi_env env, AsyncJob* job) {
+    for (size_t i = 0; i < job->keep_alive.size(); i++) napi_delete_reference(env, job->keep_alive[i]);
+    delete job;
+}
+
+// engine.loadStore(path) -> Promise<modelCount>
+napi_value engineLoadStore(napi_env env, napi_callback_info info) {
+    size_t argc = 1;
+    napi_value argv[1];
+    AsyncJob* job = 0;
+    EngineHandle* handle = engineCall(env, info, argv, argc, job);
+    if (!handle) return 0;
+
+    char path[4096];
+    size_t length = 0;
+    if (argc < 1 || napi_get_value_string_utf8(env, argv[0], path, sizeof(path), &length) != napi_ok) {
+        discardJob(env, job);
+        napi_throw_type_error(env, 0, "Expected a model store path");
+        return 0;
+    }
+
+    std::string store_path(path, length);
+    std::shared_ptr<size_t> count = std::make_shared<size_t>(0);
+    job->execute = [handle, store_path, count]() {
+        std::lock_guard<std::mutex> lock(handle->update);
+        std::shared_ptr<ForecastEngine> next = std::make_shared<ForecastEngine>(*handle->snapshot());
+        if (!next->loadStore(store_path)) throw std::runtime_error("Cannot load model store " + store_path);
+        *count = next->modelCount();
+        handle->install(next);
+    };
+    job->complete = [count](napi_env env) { return number(env, (double)*count); };
+    return queueJob(env, job, "energy.loadStore");
+}
+
+// engine.train(site, days = 90) -> Promise<modelCount>, on synthetic history
+napi_value engineTrain(napi_env env, napi_callback_info info) {
+    size_t argc = 2;
+    napi_value argv[2];
+    AsyncJob* job = 0;
+    EngineHandle* handle = engineCall(env, info, argv, argc, job);
+    if (!handle) return 0;
+
+    double site = 0, days = 90;
+    if ((argc > 0 && !getNumber(env, argv[0], site, "site")) ||
+        (argc > 1 && !getNumber(env, argv[1], days, "days"))) {
+        discardJob(env, job);
+        return 0;
+    }
+    if (days < 1) {
+        discardJob(env, job);
+        napi_throw_range_error(env, 0, "days must be at least 1");
+        return 0;
+    }
+
+    int site_id = (int)site, n_days = (int)days;
+    std::shared_ptr<size_t> count = std::make_shared<size_t>(0);
+    job->execute = [handle, site_id, n_days, count]() {
+        std::lock_guard<std::mutex> lock(handle->update);
+        std::shared_ptr<ForecastEngine> next = std::make_shared<ForecastEngine>(*handle->snapshot());
+        next->train(site_id, generateSyntheticHistory(n_days));
+        *count = next->modelCount();
+        handle->install(next);
+    };
+    job->complete = [count](napi_env env) { return number(env, (double)*count); };
+    return queueJob(env, job, "energy.train");
+}
+
+// Shared argument handling for forecast() and forecastJson()
+bool forecastArgs(napi_env env, napi_value* argv, size_t argc, int& site, int& hour, int& day) {
+    std::time_t now = std::time(0);
+    std::tm local;
+    localtime_r(&now, &local);
+    double values[3] = { 0.0, (double)local.tm_hour, (double)(local.tm_yday + 1) };
+    const char* names[3] = { "site", "hour", "day" };
+    for (size_t i = 0; i < argc && i < 3; i++) {
+        napi_valuetype type;
+        napi_typeof(env, argv[i], &type);
+        if (type == napi_undefined) continue;
+        if (!getNumber(env, argv[i], values[i], names[i])) return false;
+    }
+    if (values[1] < 0 || values[1] > 23 || values[2] < 0 || values[2] > 366) {
+        napi_throw_range_error(env, 0, "hour or day out of range");
+        return false;
+    }
+    site = (int)values[0];
+    hour = (int)values[1];
+    day = (int)values[2];
+    return true;
+}
+
+napi_value bandObject(napi_env env, napi_value buffer, size_t offset) {
+    napi_value bands;
+    if (napi_create_object(env, &bands) != napi_ok) return 0;
+    const char* keys[FORECAST_LEVELS] = { "p10", "p50", "p90" };
+    for (int l = 0; l < FORECAST_LEVELS; l++) {
+        size_t at = offset + l * FORECAST_HOURS * sizeof(double);
+        if (!setNamed(env, bands, keys[l], view(env, buffer, napi_float64_array, FORECAST_HOURS, at))) return 0;
+    }
+    return bands;
+}
+
+// engine.forecast(site, hour, day) -> Promise<{ site, dayOfYear, issuedAt, hour, solar, wind }>
+// hour is an Int32Array and solar/wind.{p10,p50,p90} are Float64Arrays, all
+// views into one native Forecast24h
+napi_value engineForecast(napi_env env, napi_callback_info info) {
+    size_t argc = 3;
+    napi_value argv[3];
+    AsyncJob* job = 0;
+    EngineHandle* handle = engineCall(env, info, argv, argc, job);
+    if (!handle) return 0;
+
+    int site, hour, day;
+    if (!forecastArgs(env, argv, argc, site, hour, day)) {
+        discardJob(env, job);
+        return 0;
+    }
+
+    std::shared_ptr<const ForecastEngine> engine = handle->snapshot();
+    std::shared_ptr<std::unique_ptr<Forecast24h> > owner =
+        std::make_shared<std::unique_ptr<Forecast24h> >(new Forecast24h());
+    job->execute = [engine, owner, site, hour, day]() {
+        if (!engine->forecast24h(site, hour, day, **owner)) throw std::runtime_error("unknown site");
+    };
+    job->complete = [owner](napi_env env) -> napi_value {
+        Forecast24h* f = owner->release();
+        napi_value buffer = externalBuffer(env, f, f, sizeof(Forecast24h));
+        napi_value out;
+        if (!buffer || napi_create_object(env, &out) != napi_ok) return 0;
+        setNamed(env, out, "site", number(env, f->site_id));
+        setNamed(env, out, "dayOfYear", number(env, f->day_of_year));
+        setNamed(env, out, "issuedAt", number(env, (double)f->issued_at));
+        if (!setNamed(env, out, "hour", view(env, buffer, napi_int32_array, FORECAST_HOURS,
+                                             offsetof(Forecast24h, hour))) ||
+            !setNamed(env, out, "solar", bandObject(env, buffer, offsetof(Forecast24h, solar))) ||
+            !setNamed(env, out, "wind", bandObject(env, buffer, offsetof(Forecast24h, wind)))) {
+            return 0;
+        }
+        return out;
+    };
+    return queueJob(env, job, "energy.forecast");
+}
+
+// engine.forecastJson(site, hour, day) -> Promise<string> (forecast_output.json shape)
+napi_value engineForecastJson(napi_env env, napi_callback_info info) {
+    size_t argc = 3;
+    napi_value argv[3];
+    AsyncJob* job = 0;
+    EngineHandle* handle = engineCall(env, info, argv, argc, job);
+    if (!handle) return 0;
+
+    int site, hour, day;
+    if (!forecastArgs(env, argv, argc, site, hour, day)) {
+        discardJob(env, job);
+        return 0;
+    }
+
+    std::shared_ptr<const ForecastEngine> engine = handle->snapshot();
+    std::shared_ptr<std::string> json = std::make_shared<std::string>();
+    job->execute = [engine, json, site, hour, day]() {
+        Forecast24h f;
+        if (!engine->forecast24h(site, hour, day, f)) throw std::runtime_error("unknown site");
+        *json = forecastToJson(f);
+    };
+    job->complete = [json](napi_env env) -> napi_value {
+        napi_value out;
+        if (napi_create_string_utf8(env, json->data(), json->size(), &out) != napi_ok) return 0;
+        return out;
+    };
+    return queueJob(env, job, "energy.forecastJson");
+}
+
+// engine.modelCount() / engine.hasSite(site), synchronous and cheap
+napi_value engineModelCount(napi_env env, napi_callback_info info) {
+    napi_value self;
+    void* data = 0;
+    NAPI_CALL(env, napi_get_cb_info(env, info, 0, 0, &self, 0));
+    NAPI_CALL(env, napi_unwrap(env, self, &data));
+    return number(env, (double)static_cast<EngineHandle*>(data)->snapshot()->modelCount());
+}
+
+napi_value engineHasSite(napi_env env, napi_callback_info info) {
+    size_t argc = 1;
+    napi_value argv[1], self, result;
+    void* data = 0;
+    double site = 0;
+    NAPI_CALL(env, napi_get_cb_info(env, info, &argc, argv, &self, 0));
+    NAPI_CALL(env, napi_unwrap(env, self, &data));
+    if (argc < 1 || !getNumber(env, argv[0], site, "site")) return 0;
+    NAPI_CALL(env, napi_get_boolean(env, static_cast<EngineHandle*>(data)->snapshot()->hasSite((int)site),
+                                    &result));
+    return result;
+}
+
+// ---------------------------------------------------------------------------
+// gridState(shmName?) -> { version, solarCapacity, ..., forecast } | null
+// Synchronous: a seqlock copy out of shared memory costs well under a microsecond
+// ---------------------------------------------------------------------------
+
+// Forecast bands copied into one buffer: p10/p50/p90 views per target
+napi_value forecastBands(napi_env env, const GridSnapshot& s, napi_value& solar, napi_value& wind) {
+    napi_value buffer;
+    void* data = 0;
+    if (napi_create_arraybuffer(env, sizeof(s.solar) + sizeof(s.wind), &data, &buffer) != napi_ok) return 0;
+    memcpy(data, s.solar, sizeof(s.solar));
+    memcpy(static_cast<char*>(data) + sizeof(s.solar), s.wind, sizeof(s.wind));
+    const char* keys[GRID_FORECAST_LEVELS] = { "p10", "p50", "p90" };
+    napi_value* targets[2] = { &solar, &wind };
+    for (int t = 0; t < 2; t++) {
+        if (napi_create_object(env, targets[t]) != napi_ok) return 0;
+        for (int l = 0; l < GRID_FORECAST_LEVELS; l++) {
+            size_t offset = ((size_t)t * GRID_FORECAST_LEVELS + l) * GRID_FORECAST_HOURS * sizeof(double);
+            if (!setNamed(env, *targets[t], keys[l], view(env, buffer, napi_float64_array, GRID_FORECAST_HOURS,
+                                                          offset))) {
+                return 0;
+            }
+        }
+    }
+    return buffer;
+}
+
+// Attached on first use and kept for the life of the process (main thread only)
+GridStateShm* attachedGridState(const std::string& name) {
+    static std::map<std::string, GridStateShm*> attached;
+    GridStateShm*& shm = attached[name];
+    if (!shm) {
+        GridStateShm* candidate = new GridStateShm();
+        if (candidate->attach(name)) shm = candidate;
+        else delete candidate;
+    }
+    return shm;
+}
+
+bool gridStateName(napi_env env, napi_callback_info info, std::string& name) {
+    size_t argc = 1;
+    napi_value argv[1];
+    name = GRID_SHM_NAME;
+    if (napi_get_cb_info(env, info, &argc, argv, 0, 0) != napi_ok) return false;
+    napi_valuetype type = napi_undefined;
+    if (argc > 0) napi_typeof(env, argv[0], &type);
+    if (type == napi_string) {
+        char buf[256];
+        size_t length = 0;
+        if (napi_get_value_string_utf8(env, argv[0], buf, sizeof(buf), &length) != napi_ok) return false;
+        name.assign(buf, length);
+    } else if (type != napi_undefined) {
+        napi_throw_type_error(env, 0, "Expected a shared memory name");
+        return false;
+    }
+    return true;
+}
+
+// gridStateVersion(shmName?) -> publish count (0 if absent), to poll cheaply
+napi_value gridStateVersion(napi_env env, napi_callback_info info) {
+    std::string name;
+    if (!gridStateName(env, info, name)) return 0;
+    GridStateShm* shm = attachedGridState(name);
+    return number(env, shm ? (double)shm->version() : 0.0);
+}
+
+napi_value gridState(napi_env env, napi_callback_info info) {
+    std::string name;
+    if (!gridStateName(env, info, name)) return 0;
+    GridStateShm* shm = attachedGridState(name);
+    GridSnapshot s;
+    napi_value out;
+    if (!shm || !shm->read(s)) {
+        NAPI_CALL(env, napi_get_null(env, &out));
+        return out;
+    }
+
+    NAPI_CALL(env, napi_create_object(env, &out));
+    napi_value backup, updated;
+    NAPI_CALL(env, napi_get_boolean(env, s.state.backup_active, &backup));
+    std::string iso = isoTimestamp(s.state.updated_ms);
+    NAPI_CALL(env, napi_create_string_utf8(env, iso.c_str(), iso.size(), &updated));
+    setNamed(env, out, "version", number(env, (double)s.version));
+    setNamed(env, out, "solarCapacity", number(env, s.state.solar_capacity));
+    setNamed(env, out, "windCapacity", number(env, s.state.wind_capacity));
+    setNamed(env, out, "batteryLevel", number(env, s.state.battery_level));
+    setNamed(env, out, "gridLoad", number(env, s.state.grid_load));
+    setNamed(env, out, "backupActive", backup);
+    setNamed(env, out, "lastUpdated", updated);
+    if (s.has_forecast) {
+        napi_value forecast;
+        NAPI_CALL(env, napi_create_object(env, &forecast));
+        setNamed(env, forecast, "startHour", number(env, s.forecast_start_hour));
+        setNamed(env, forecast, "issuedAt", number(env, (double)s.forecast_issued_at));
+        napi_value solar, wind;
+        if (!forecastBands(env, s, solar, wind)) return 0;
+        setNamed(env, forecast, "solar", solar);
+        setNamed(env, forecast, "wind", wind);
+        setNamed(env, out, "forecast", forecast);
+    }
+    return out;
+}
+
+// ---------------------------------------------------------------------------
+// recommend({ solar, wind, demand, battery }) -> Promise<{ action, deficit, surplus, counts, buffer }>
+// Columns are equal-length Float64Arrays; action is a Uint8Array of GridAction
+// codes and buffer the packed layout of grid_recommend.h (for binary replies)
+// ---------------------------------------------------------------------------
+
+struct RecommendationResult {
+    std::unique_ptr<std::vector<double> > packed;      // packedRecommendationBytes(n), 8-byte aligned
+    size_t counts[GRID_ACTION_COUNT];
+};
+
+napi_value recommend(napi_env env, napi_callback_info info) {
+    size_t argc = 1;
+    napi_value argv[1];
+    NAPI_CALL(env, napi_get_cb_info(env, info, &argc, argv, 0, 0));
+    napi_valuetype type = napi_undefined;
+    if (argc > 0) napi_typeof(env, argv[0], &type);
+    if (type != napi_object) {
+        napi_throw_type_error(env, 0, "Expected { solar, wind, demand, battery }");
+        return 0;
+    }
+
+    const char* names[4] = { "solar", "wind", "demand", "battery" };
+    napi_value columns[4];
+    const double* data[4];
+    size_t n = 0;
+    for (int c = 0; c < 4; c++) {
+        SeriesView column;
+        NAPI_CALL(env, napi_get_named_property(env, argv[0], names[c], &columns[c]));
+        if (!getSeries(env, columns[c], column)) return 0;
+        if (column.f32 || (c > 0 && column.length != n)) {
+            std::string message = std::string("Column ") + names[c] + " must be a Float64Array of the common length";
+            napi_throw_range_error(env, 0, message.c_str());
+            return 0;
+        }
+        data[c] = column.f64;
+        n = column.length;
+    }
+
+    AsyncJob* job = new AsyncJob();
+    for (int c = 0; c < 4; c++) {
+        if (!keepAlive(env, job, columns[c])) {
+            for (size_t i = 0; i < job->keep_alive.size(); i++) napi_delete_reference(env, job->keep_alive[i]);
+            delete job;
+            napi_throw_error(env, 0, "Cannot reference input");
+            return 0;
+        }
+    }
+
+    std::shared_ptr<RecommendationResult> result = std::make_shared<RecommendationResult>();
+    // At least one word, as external buffers need a non-null pointer
+    result->packed.reset(new std::vector<double>(packedRecommendationBytes(n) / sizeof(double) + 1));
+    RecommendationInputs in = { data[0], data[1], data[2], data[3], n };
+
+    job->execute = [in, result]() {
+        recommendPacked(0, in, &(*result->packed)[0]);
+        countActions(reinterpret_cast<const uint8_t*>(&(*result->packed)[0]), in.n, result->counts);
+    };
+    job->complete = [result, n](napi_env env) -> napi_value {
+        napi_value out, counts;
+        // Ownership of the packed result moves to the returned buffer
+        std::vector<double>* packed = result->packed.release();
+        napi_value buffer = externalBuffer(env, packed, &(*packed)[0], packedRecommendationBytes(n));
+        if (!buffer || napi_create_object(env, &out) != napi_ok) return 0;
+        size_t offset = actionColumnBytes(n);
+        if (!setNamed(env, out, "action", view(env, buffer, napi_uint8_array, n, 0))) return 0;
+        if (!setNamed(env, out, "deficit", view(env, buffer, napi_float64_array, n, offset))) return 0;
+        if (!setNamed(env, out, "surplus", view(env, buffer, napi_float64_array, n,
+                                                offset + n * sizeof(double)))) {
+            return 0;
+        }
+        if (napi_create_object(env, &counts) != napi_ok) return 0;
+        for (int a = 0; a < GRID_ACTION_COUNT; a++) {
+            setNamed(env, counts, actionName(a), number(env, (double)result->counts[a]));
+        }
+        setNamed(env, out, "counts", counts);
+        setNamed(env, out, "buffer", buffer);
+        return out;
+    };
+    return queueJob(env, job, "energy.recommend");
+}
+
+napi_value init(napi_env env, napi_value exports) {
+    napi_property_descriptor functions[] = {
+        { "fft", 0, fft, 0, 0, 0, napi_default, 0 },
+        { "decompose", 0, decompose, 0, 0, 0, napi_default, 0 },
+        { "recommend", 0, recommend, 0, 0, 0, napi_default, 0 },
+        { "gridState", 0, gridState, 0, 0, 0, napi_default, 0 },
+        { "gridStateVersion", 0, gridStateVersion, 0, 0, 0, napi_default, 0 },
+    };
+    NAPI_CALL(env, napi_define_properties(env, exports, 5, functions));
+
+    napi_property_descriptor methods[] = {
+        { "loadStore", 0, engineLoadStore, 0, 0, 0, napi_default, 0 },
+        { "train", 0, engineTrain, 0, 0, 0, napi_default, 0 },
+        { "forecast", 0, engineForecast, 0, 0, 0, napi_default, 0 },
+        { "forecastJson", 0, engineForecastJson, 0, 0, 0, napi_default, 0 },
+        { "modelCount", 0, engineModelCount, 0, 0, 0, napi_default, 0 },
+        { "hasSite", 0, engineHasSite, 0, 0, 0, napi_default, 0 },
+    };
+    napi_value engine_class;
+    NAPI_CALL(env, napi_define_class(env, "ForecastEngine", NAPI_AUTO_LENGTH, engineConstructor, 0,
+                                     6, methods, &engine_class));
+    NAPI_CALL(env, napi_set_named_property(env, exports, "ForecastEngine", engine_class));
+    return exports;
+}
+
+NAPI_MODULE(energy_addon, init)
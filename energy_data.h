@@ -0,0 +1,131 @@
+/**
+ * Synthetic Energy Data and Feature Preparation
+ * Native counterparts of generate_synthetic_data() and prepare_features()
+ * Shared by the C++ forecasting tools
+ */
+
+#ifndef ENERGY_DATA_H
+#define ENERGY_DATA_H
+
+#include <vector>
+#include <cmath>
+#include <random>
+#include <algorithm>
+#include <cstddef>
+
+const double TWO_PI = 6.28318530717958647692;
+
+// Hourly weather and generation history (one entry per hour)
+struct EnergyHistory {
+    std::vector<int> hour_of_day;
+    std::vector<int> day_of_year;
+    std::vector<double> temperature;
+    std::vector<double> cloud_cover;
+    std::vector<double> wind_speed;
+    std::vector<double> solar_capacity;
+    std::vector<double> wind_capacity;
+
+    size_t size() const { return hour_of_day.size(); }
+};
+
+// Beta(a, b) sample via the ratio of two gamma variates
+inline double sampleBeta(std::mt19937& rng, double a, double b) {
+    std::gamma_distribution<double> ga(a, 1.0), gb(b, 1.0);
+    double x = ga(rng);
+    double y = gb(rng);
+    return x / (x + y);
+}
+
+// Generate synthetic training data (mirrors beta_regression.py)
+inline EnergyHistory generateSyntheticHistory(int n_days, unsigned seed = 42) {
+    std::mt19937 rng(seed);
+    std::normal_distribution<double> normal(0.0, 1.0);
+    std::gamma_distribution<double> gamma22(2.0, 2.0);
+
+    int n_hours = n_days * 24;
+    EnergyHistory h;
+    h.hour_of_day.resize(n_hours);
+    h.day_of_year.resize(n_hours);
+    h.temperature.resize(n_hours);
+    h.cloud_cover.resize(n_hours);
+    h.wind_speed.resize(n_hours);
+    h.solar_capacity.resize(n_hours);
+    h.wind_capacity.resize(n_hours);
+
+    for (int i = 0; i < n_hours; i++) {
+        int hour = i % 24;
+        int day = i / 24;
+        double annual = TWO_PI * day / 365.0;
+
+        // Solar capacity: high during day, zero at night
+        double solar_base = std::max(0.0, std::sin((hour - 6) * TWO_PI / 24.0));
+        double solar = solar_base * 0.8 + 0.2 * std::sin(annual) + sampleBeta(rng, 2, 2) * 0.2;
+
+        // Wind capacity: more variable, less diurnal pattern
+        double wind_base = 0.4 + 0.3 * std::sin(hour * TWO_PI / 12.0);
+        double wind = wind_base + 0.15 * std::cos(annual) + sampleBeta(rng, 2, 2) * 0.3;
+
+        h.hour_of_day[i] = hour;
+        h.day_of_year[i] = day;
+        h.temperature[i] = 20 + 10 * std::sin(annual) + normal(rng) * 3;
+        h.cloud_cover[i] = sampleBeta(rng, 2, 5);
+        h.wind_speed[i] = 5 + 3 * std::sin(annual) + gamma22(rng);
+        h.solar_capacity[i] = std::min(0.99, std::max(0.01, solar));
+        h.wind_capacity[i] = std::min(0.99, std::max(0.01, wind));
+    }
+
+    return h;
+}
+
+// Feature layout used by prepare_features(): intercept, Fourier terms,
+// scaled weather, annual sin/cos. Persisted with every trained model.
+struct FeatureSpec {
+    int fourier_order;
+    double fourier_period;
+    double temperature_scale;
+    double wind_speed_scale;
+    double annual_period;
+};
+
+inline FeatureSpec defaultFeatureSpec() {
+    FeatureSpec spec;
+    spec.fourier_order = 6;
+    spec.fourier_period = 24.0;
+    spec.temperature_scale = 100.0;
+    spec.wind_speed_scale = 10.0;
+    spec.annual_period = 365.0;
+    return spec;
+}
+
+inline size_t featureCount(const FeatureSpec& spec = defaultFeatureSpec()) {
+    return 1 + 2 * spec.fourier_order + 3 + 2;
+}
+
+// Build the row-major design matrix (n x featureCount(spec))
+inline std::vector<double> prepareFeatures(const EnergyHistory& h,
+                                           const FeatureSpec& spec = defaultFeatureSpec()) {
+    size_t n = h.size();
+    size_t p = featureCount(spec);
+    std::vector<double> X(n * p);
+
+    for (size_t i = 0; i < n; i++) {
+        double* row = &X[i * p];
+        size_t c = 0;
+        row[c++] = 1.0;
+        for (int k = 1; k <= spec.fourier_order; k++) {
+            double angle = TWO_PI * k * h.hour_of_day[i] / spec.fourier_period;
+            row[c++] = std::sin(angle);
+            row[c++] = std::cos(angle);
+        }
+        row[c++] = h.temperature[i] / spec.temperature_scale;
+        row[c++] = h.cloud_cover[i];
+        row[c++] = h.wind_speed[i] / spec.wind_speed_scale;
+        double annual = TWO_PI * h.day_of_year[i] / spec.annual_period;
+        row[c++] = std::sin(annual);
+        row[c++] = std::cos(annual);
+    }
+
+    return X;
+}
+
+#endif
@@ -0,0 +1,462 @@
+/**
+ * Energy Native
+ * CPython extension exposing FourierTransform and SeasonalDecomposition
+ * Replaces the fourier_transform executable + CSV round trip for
+ * beta_regression.py and notebooks
+ *
+ * Inputs are any C-contiguous float64/float32 buffer (numpy arrays, array,
+ * memoryview), read in place through the buffer protocol. Results are
+ * returned as numpy arrays viewing the native result buffers (memoryviews
+ * when numpy is not installed), so nothing is copied in either direction.
+ * The GIL is released while computing, and the *_batch entry points split
+ * the rows of a 2-D input across one module-wide thread pool.
+ *
+ *   import numpy as np, energy_native
+ *   magnitude, phase, dominant = energy_native.fft(series, top_k=5)
+ *   trend, seasonal, residual, strength = energy_native.decompose(series, period=24)
+ *   trend, seasonal, residual, strength = energy_native.decompose_batch(matrix, 24, threads=8)
+ *   grid = energy_native.grid_state()          # shared-memory snapshot as a dict
+ *
+ * Build: g++ -std=c++11 -O2 -march=native -shared -fPIC -pthread $(python3-config --includes) \
+ *          -o energy_native$(python3-config --extension-suffix) energy_native.cpp
+ */
+
+#define PY_SSIZE_T_CLEAN
+#include <Python.h>
+
+#include <vector>
+#include <string>
+#include <cstring>
+#include <cstddef>
+#include <algorithm>
+#include <atomic>
+#include <map>
+
+#include "fourier_transform.h"
+#include "thread_pool.h"
+#include "grid_state_shm.h"
+
+// ---------------------------------------------------------------------------
+// Input buffers
+// ---------------------------------------------------------------------------
+
+// Borrowed view of a 1-D or 2-D float64/float32 buffer; rows x cols
+struct SeriesBuffer {
+    Py_buffer view;
+    bool acquired;
+    const double* f64;
+    const float* f32;
+    size_t rows;
+    size_t cols;
+
+    SeriesBuffer() : acquired(false), f64(0), f32(0), rows(0), cols(0) {}
+    ~SeriesBuffer() {
+        if (acquired) PyBuffer_Release(&view);
+    }
+
+    const double* rowF64(size_t r) const { return f64 + r * cols; }
+    const float* rowF32(size_t r) const { return f32 + r * cols; }
+};
+
+// Native byte order float format codes ("d", "=d", "<d" on little-endian...)
+char formatCode(const char* format) {
+    if (!format) return 'B';
+    if (format[0] == '@' || format[0] == '=') format++;
+#if PY_LITTLE_ENDIAN
+    else if (format[0] == '<') format++;
+#else
+    else if (format[0] == '>' || format[0] == '!') format++;
+#endif
+    return format[0] && !format[1] ? format[0] : '?';
+}
+
+bool getSeries(PyObject* obj, int max_dims, SeriesBuffer& out) {
+    if (PyObject_GetBuffer(obj, &out.view, PyBUF_C_CONTIGUOUS | PyBUF_FORMAT) != 0) return false;
+    out.acquired = true;
+
+    char code = formatCode(out.view.format);
+    if ((code != 'd' && code != 'f') || out.view.ndim < 1 || out.view.ndim > max_dims) {
+        PyErr_Format(PyExc_TypeError, "expected a C-contiguous float64 or float32 array with %s",
+                     max_dims == 1 ? "1 dimension" : "1 or 2 dimensions");
+        return false;
+    }
+    out.rows = out.view.ndim == 2 ? (size_t)out.view.shape[0] : 1;
+    out.cols = (size_t)out.view.shape[out.view.ndim - 1];
+    if (out.cols == 0) {
+        PyErr_SetString(PyExc_ValueError, "series must not be empty");
+        return false;
+    }
+    out.f64 = code == 'd' ? static_cast<const double*>(out.view.buf) : 0;
+    out.f32 = code == 'f' ? static_cast<const float*>(out.view.buf) : 0;
+    return true;
+}
+
+// ---------------------------------------------------------------------------
+// Result buffers
+// ---------------------------------------------------------------------------
+
+// Owned float64 result exporting the buffer protocol; numpy wraps it in place
+struct NativeArray {
+    PyObject_HEAD
+    std::vector<double>* values;
+    Py_ssize_t shape[2];
+    Py_ssize_t strides[2];
+    int ndim;
+};
+
+static PyTypeObject* NativeArrayType = 0;
+static PyObject* numpy_asarray = 0;
+
+void nativeArrayDealloc(PyObject* self) {
+    PyTypeObject* type = Py_TYPE(self);
+    delete reinterpret_cast<NativeArray*>(self)->values;
+    type->tp_free(self);
+    Py_DECREF(type);
+}
+
+int nativeArrayGetBuffer(PyObject* self, Py_buffer* view, int flags) {
+    NativeArray* a = reinterpret_cast<NativeArray*>(self);
+    view->obj = self;
+    Py_INCREF(self);
+    view->buf = a->values->empty() ? 0 : &(*a->values)[0];
+    view->len = (Py_ssize_t)(a->values->size() * sizeof(double));
+    view->readonly = 0;
+    view->itemsize = sizeof(double);
+    view->format = (flags & PyBUF_FORMAT) ? const_cast<char*>("d") : 0;
+    view->ndim = a->ndim;
+    view->shape = (flags & PyBUF_ND) ? a->shape : 0;
+    view->strides = (flags & PyBUF_STRIDES) == PyBUF_STRIDES ? a->strides : 0;
+    view->suboffsets = 0;
+    view->internal = 0;
+    return 0;
+}
+
+// Wrap values (ownership taken) as a numpy array or memoryview of shape rows x cols
+PyObject* resultArray(std::vector<double>* values, size_t rows, size_t cols, bool two_dims) {
+    NativeArray* a = PyObject_New(NativeArray, NativeArrayType);
+    if (!a) {
+        delete values;
+        return 0;
+    }
+    a->values = values;
+    a->ndim = two_dims ? 2 : 1;
+    a->shape[0] = (Py_ssize_t)(two_dims ? rows : cols);
+    a->shape[1] = (Py_ssize_t)cols;
+    a->strides[0] = (Py_ssize_t)((two_dims ? cols : 1) * sizeof(double));
+    a->strides[1] = (Py_ssize_t)sizeof(double);
+
+    PyObject* result = numpy_asarray ? PyObject_CallFunctionObjArgs(numpy_asarray, (PyObject*)a, NULL)
+                                     : PyMemoryView_FromObject((PyObject*)a);
+    Py_DECREF(a);
+    return result;
+}
+
+// (bin, period, magnitude) tuples; periods are in samples of the zero-padded
+// transform of length `padded`, which the bins index
+PyObject* dominantList(const std::vector<std::pair<int, double> >& dominant, size_t padded) {
+    PyObject* list = PyList_New((Py_ssize_t)dominant.size());
+    if (!list) return 0;
+    for (size_t i = 0; i < dominant.size(); i++) {
+        PyObject* entry = Py_BuildValue("(idd)", dominant[i].first, (double)padded / dominant[i].first,
+                                        dominant[i].second);
+        if (!entry) {
+            Py_DECREF(list);
+            return 0;
+        }
+        PyList_SET_ITEM(list, (Py_ssize_t)i, entry);
+    }
+    return list;
+}
+
+// ---------------------------------------------------------------------------
+// Kernels (GIL released)
+// ---------------------------------------------------------------------------
+
+void spectrumRow(const SeriesBuffer& in, size_t r, double* magnitude, double* phase,
+                 std::vector<std::pair<int, double> >& dominant, int top_k) {
+    FourierTransform ft = in.f64 ? FourierTransform(in.rowF64(r), in.cols)
+                                 : FourierTransform(in.rowF32(r), in.cols);
+    ft.compute();
+    std::vector<double> m = ft.getMagnitudeSpectrum();
+    std::vector<double> p = ft.getPhaseSpectrum();
+    std::copy(m.begin(), m.end(), magnitude);
+    std::copy(p.begin(), p.end(), phase);
+    dominant = ft.getDominantFrequencies(top_k);
+}
+
+double decomposeRow(const SeriesBuffer& in, size_t r, int period, double* trend, double* seasonal,
+                    double* residual) {
+    SeasonalDecomposition decomp = in.f64 ? SeasonalDecomposition(in.rowF64(r), in.cols, period)
+                                          : SeasonalDecomposition(in.rowF32(r), in.cols, period);
+    decomp.decompose();
+    std::copy(decomp.getTrend().begin(), decomp.getTrend().end(), trend);
+    std::copy(decomp.getSeasonal().begin(), decomp.getSeasonal().end(), seasonal);
+    std::copy(decomp.getResidual().begin(), decomp.getResidual().end(), residual);
+    return decomp.getSeasonalityStrength();
+}
+
+// Worker pool shared by every batch call, created on first use with one
+// thread per core. Concurrent calls from several Python threads queue on the
+// same workers instead of each starting its own. It is never destroyed, so no
+// worker is joined during interpreter shutdown.
+ThreadPool& batchPool() {
+    static ThreadPool* pool = new ThreadPool();
+    return *pool;
+}
+
+// Run body(row) over every row, on the calling thread or the shared pool;
+// threads > 0 caps the workers this call may occupy
+template <typename Body>
+void forEachRow(size_t rows, int threads, const Body& body) {
+    size_t workers = 1;
+    if (rows > 1 && threads != 1) {
+        size_t cores = batchPool().size();
+        workers = std::min(rows, threads > 0 ? std::min((size_t)threads, cores) : cores);
+    }
+    if (workers <= 1) {
+        for (size_t r = 0; r < rows; r++) body(r);
+        return;
+    }
+    // One task per permitted worker, each claiming rows until none are left
+    std::atomic<size_t> next(0);
+    batchPool().parallelFor(workers, 1, [&](size_t, size_t, size_t) {
+        for (size_t r = next++; r < rows; r = next++) body(r);
+    });
+}
+
+size_t spectrumBins(size_t n) {
+    size_t padded = 1;
+    while (padded < n) padded *= 2;
+    return padded / 2;
+}
+
+// ---------------------------------------------------------------------------
+// Module functions
+// ---------------------------------------------------------------------------
+
+PyObject* spectrum(PyObject* args, PyObject* kwargs, bool batch) {
+    static const char* keywords[] = { "series", "top_k", "threads", 0 };
+    static const char* single_keywords[] = { "series", "top_k", 0 };
+    PyObject* obj;
+    int top_k = 5, threads = 0;
+    if (!PyArg_ParseTupleAndKeywords(args, kwargs, batch ? "O|ii" : "O|i",
+                                     const_cast<char**>(batch ? keywords : single_keywords),
+                                     &obj, &top_k, &threads)) {
+        return 0;
+    }
+    SeriesBuffer in;
+    if (!getSeries(obj, batch ? 2 : 1, in)) return 0;
+
+    size_t bins = spectrumBins(in.cols);
+    std::vector<double>* magnitude = new std::vector<double>(in.rows * bins);
+    std::vector<double>* phase = new std::vector<double>(in.rows * bins);
+    std::vector<std::vector<std::pair<int, double> > > dominant(in.rows);
+
+    Py_BEGIN_ALLOW_THREADS
+    forEachRow(in.rows, threads, [&](size_t r) {
+        spectrumRow(in, r, &(*magnitude)[r * bins], &(*phase)[r * bins], dominant[r], top_k);
+    });
+    Py_END_ALLOW_THREADS
+
+    bool two_dims = in.view.ndim == 2;
+    PyObject* m = resultArray(magnitude, in.rows, bins, two_dims);
+    PyObject* p = resultArray(phase, in.rows, bins, two_dims);
+    PyObject* d = 0;
+    if (two_dims) {
+        d = PyList_New((Py_ssize_t)in.rows);
+        for (size_t r = 0; d && r < in.rows; r++) {
+            PyObject* row = dominantList(dominant[r], 2 * bins);
+            if (!row) {
+                Py_CLEAR(d);
+                break;
+            }
+            PyList_SET_ITEM(d, (Py_ssize_t)r, row);
+        }
+    } else {
+        d = dominantList(dominant[0], 2 * bins);
+    }
+    if (!m || !p || !d) {
+        Py_XDECREF(m);
+        Py_XDECREF(p);
+        Py_XDECREF(d);
+        return 0;
+    }
+    return Py_BuildValue("(NNN)", m, p, d);
+}
+
+PyObject* decomposition(PyObject* args, PyObject* kwargs, bool batch) {
+    static const char* keywords[] = { "series", "period", "threads", 0 };
+    static const char* single_keywords[] = { "series", "period", 0 };
+    PyObject* obj;
+    int period = 24, threads = 0;
+    if (!PyArg_ParseTupleAndKeywords(args, kwargs, batch ? "O|ii" : "O|i",
+                                     const_cast<char**>(batch ? keywords : single_keywords),
+                                     &obj, &period, &threads)) {
+        return 0;
+    }
+    if (period < 1) {
+        PyErr_SetString(PyExc_ValueError, "period must be at least 1");
+        return 0;
+    }
+    SeriesBuffer in;
+    if (!getSeries(obj, batch ? 2 : 1, in)) return 0;
+
+    size_t n = in.rows * in.cols;
+    std::vector<double>* trend = new std::vector<double>(n);
+    std::vector<double>* seasonal = new std::vector<double>(n);
+    std::vector<double>* residual = new std::vector<double>(n);
+    std::vector<double>* strength = new std::vector<double>(in.rows);
+
+    Py_BEGIN_ALLOW_THREADS
+    forEachRow(in.rows, threads, [&](size_t r) {
+        size_t at = r * in.cols;
+        (*strength)[r] = decomposeRow(in, r, period, &(*trend)[at], &(*seasonal)[at], &(*residual)[at]);
+    });
+    Py_END_ALLOW_THREADS
+
+    bool two_dims = in.view.ndim == 2;
+    double single_strength = (*strength)[0];
+    PyObject* t = resultArray(trend, in.rows, in.cols, two_dims);
+    PyObject* s = resultArray(seasonal, in.rows, in.cols, two_dims);
+    PyObject* e = resultArray(residual, in.rows, in.cols, two_dims);
+    PyObject* k;
+    if (two_dims) {
+        k = resultArray(strength, 1, in.rows, false);
+    } else {
+        delete strength;
+        k = PyFloat_FromDouble(single_strength);
+    }
+    if (!t || !s || !e || !k) {
+        Py_XDECREF(t);
+        Py_XDECREF(s);
+        Py_XDECREF(e);
+        Py_XDECREF(k);
+        return 0;
+    }
+    return Py_BuildValue("(NNNN)", t, s, e, k);
+}
+
+PyObject* fftFunction(PyObject*, PyObject* args, PyObject* kwargs) {
+    return spectrum(args, kwargs, false);
+}
+
+PyObject* fftBatchFunction(PyObject*, PyObject* args, PyObject* kwargs) {
+    return spectrum(args, kwargs, true);
+}
+
+PyObject* decomposeFunction(PyObject*, PyObject* args, PyObject* kwargs) {
+    return decomposition(args, kwargs, false);
+}
+
+PyObject* decomposeBatchFunction(PyObject*, PyObject* args, PyObject* kwargs) {
+    return decomposition(args, kwargs, true);
+}
+
+// Attached on first use and kept for the life of the process (guarded by the GIL)
+GridStateShm* attachedGridState(const std::string& name) {
+    static std::map<std::string, GridStateShm*> attached;
+    GridStateShm*& shm = attached[name];
+    if (!shm) {
+        GridStateShm* candidate = new GridStateShm();
+        if (candidate->attach(name)) shm = candidate;
+        else delete candidate;
+    }
+    return shm;
+}
+
+PyObject* gridStateFunction(PyObject*, PyObject* args, PyObject* kwargs) {
+    static const char* keywords[] = { "name", 0 };
+    const char* name = GRID_SHM_NAME;
+    if (!PyArg_ParseTupleAndKeywords(args, kwargs, "|s", const_cast<char**>(keywords), &name)) return 0;
+
+    GridStateShm* shm = attachedGridState(name);
+    GridSnapshot s;
+    if (!shm || !shm->read(s)) Py_RETURN_NONE;
+
+    PyObject* forecast;
+    if (s.has_forecast) {
+        // 3 x 24 arrays, rows p10 / p50 / p90
+        PyObject* solar = resultArray(new std::vector<double>(&s.solar[0][0], &s.solar[0][0] + 3 * 24),
+                                      GRID_FORECAST_LEVELS, GRID_FORECAST_HOURS, true);
+        PyObject* wind = resultArray(new std::vector<double>(&s.wind[0][0], &s.wind[0][0] + 3 * 24),
+                                     GRID_FORECAST_LEVELS, GRID_FORECAST_HOURS, true);
+        if (!solar || !wind) {
+            Py_XDECREF(solar);
+            Py_XDECREF(wind);
+            return 0;
+        }
+        forecast = Py_BuildValue("{s:i,s:L,s:N,s:N}", "start_hour", s.forecast_start_hour,
+                                 "issued_at", s.forecast_issued_at, "solar", solar, "wind", wind);
+    } else {
+        Py_INCREF(Py_None);
+        forecast = Py_None;
+    }
+    if (!forecast) return 0;
+    return Py_BuildValue("{s:K,s:d,s:d,s:d,s:d,s:O,s:s,s:N}",
+                         "version", (unsigned long long)s.version,
+                         "solar_capacity", s.state.solar_capacity,
+                         "wind_capacity", s.state.wind_capacity,
+                         "battery_level", s.state.battery_level,
+                         "grid_load", s.state.grid_load,
+                         "backup_active", s.state.backup_active ? Py_True : Py_False,
+                         "last_updated", isoTimestamp(s.state.updated_ms).c_str(),
+                         "forecast", forecast);
+}
+
+PyObject* gridStateVersionFunction(PyObject*, PyObject* args, PyObject* kwargs) {
+    static const char* keywords[] = { "name", 0 };
+    const char* name = GRID_SHM_NAME;
+    if (!PyArg_ParseTupleAndKeywords(args, kwargs, "|s", const_cast<char**>(keywords), &name)) return 0;
+    GridStateShm* shm = attachedGridState(name);
+    return PyLong_FromUnsignedLongLong(shm ? (unsigned long long)shm->version() : 0ULL);
+}
+
+static PyMethodDef energyNativeMethods[] = {
+    { "fft", (PyCFunction)(void (*)(void))fftFunction, METH_VARARGS | METH_KEYWORDS,
+      "fft(series, top_k=5) -> (magnitude, phase, [(index, period, magnitude), ...])\n"
+      "Zero-padded FFT spectrum of a 1-D float64/float32 series." },
+    { "fft_batch", (PyCFunction)(void (*)(void))fftBatchFunction, METH_VARARGS | METH_KEYWORDS,
+      "fft_batch(series, top_k=5, threads=0) -> (magnitude, phase, dominant per row)\n"
+      "fft() over each row of a 2-D array on up to `threads` shared workers (0 = all cores)." },
+    { "decompose", (PyCFunction)(void (*)(void))decomposeFunction, METH_VARARGS | METH_KEYWORDS,
+      "decompose(series, period=24) -> (trend, seasonal, residual, strength)\n"
+      "Moving-average trend plus FFT seasonal component of a 1-D series." },
+    { "decompose_batch", (PyCFunction)(void (*)(void))decomposeBatchFunction, METH_VARARGS | METH_KEYWORDS,
+      "decompose_batch(series, period=24, threads=0) -> (trend, seasonal, residual, strength)\n"
+      "decompose() over each row of a 2-D array; strength has one entry per row." },
+    { "grid_state", (PyCFunction)(void (*)(void))gridStateFunction, METH_VARARGS | METH_KEYWORDS,
+      "grid_state(name='" GRID_SHM_NAME "') -> dict or None\n"
+      "Latest grid snapshot and 24h forecast (3 x 24 P10/P50/P90 arrays) from grid_stream_server." },
+    { "grid_state_version", (PyCFunction)(void (*)(void))gridStateVersionFunction, METH_VARARGS | METH_KEYWORDS,
+      "grid_state_version(name='" GRID_SHM_NAME "') -> int\n"
+      "Publish count of the shared snapshot (0 if absent), for cheap change polling." },
+    { 0, 0, 0, 0 }
+};
+
+static struct PyModuleDef energyNativeModule = {
+    PyModuleDef_HEAD_INIT, "energy_native",
+    "Native FFT seasonal analysis with zero-copy buffers", -1, energyNativeMethods,
+    0, 0, 0, 0
+};
+
+PyMODINIT_FUNC PyInit_energy_native(void) {
+    static PyType_Slot slots[] = {
+        { Py_tp_dealloc, (void*)nativeArrayDealloc },
+        { Py_bf_getbuffer, (void*)nativeArrayGetBuffer },
+        { Py_tp_doc, (void*)"float64 result buffer owned by energy_native" },
+        { 0, 0 }
+    };
+    static PyType_Spec spec = { "energy_native.NativeArray", sizeof(NativeArray), 0, Py_TPFLAGS_DEFAULT, slots };
+    NativeArrayType = (PyTypeObject*)PyType_FromSpec(&spec);
+    if (!NativeArrayType) return 0;
+
+    // Optional: results become numpy arrays when numpy is importable
+    PyObject* numpy = PyImport_ImportModule("numpy");
+    if (numpy) {
+        numpy_asarray = PyObject_GetAttrString(numpy, "asarray");
+        Py_DECREF(numpy);
+    }
+    PyErr_Clear();
+
+    return PyModule_Create(&energyNativeModule);
+}
@@ -0,0 +1,175 @@
+/**
+ * Feature Builder
+ * Table-driven construction of the prepare_features() design matrix
+ * hour_of_day and day_of_year take few distinct values, so the Fourier and
+ * annual sin/cos terms are evaluated once per spec and copied per row;
+ * rows are written in one pass from columnar inputs, as double or float,
+ * whole or in tiles
+ */
+
+#ifndef FEATURE_BUILDER_H
+#define FEATURE_BUILDER_H
+
+#include <vector>
+#include <cmath>
+#include <cstring>
+#include <cstddef>
+#include <algorithm>
+#include <stdexcept>
+
+#include "energy_data.h"
+#include "aligned_buffer.h"
+
+const int HOURS_PER_DAY = 24;
+const int DAYS_PER_YEAR_TABLE = 366;
+const int MAX_FOURIER_ORDER = 64;
+
+// sin/cos of the daily Fourier basis (per hour) and annual cycle (per day),
+// computed with the same expressions as prepareFeatures() so rows match bit for bit
+class FeatureTables {
+private:
+    FeatureSpec spec;
+    size_t fourier_width;
+    std::vector<double> hour_table;      // HOURS_PER_DAY x fourier_width
+    std::vector<double> annual_table;    // DAYS_PER_YEAR_TABLE x 2
+
+public:
+    explicit FeatureTables(const FeatureSpec& feature_spec = defaultFeatureSpec())
+        : spec(feature_spec), fourier_width(2 * feature_spec.fourier_order) {
+        if (spec.fourier_order < 0 || spec.fourier_order > MAX_FOURIER_ORDER) {
+            throw std::invalid_argument("FeatureTables: Fourier order out of range");
+        }
+        hour_table.resize(HOURS_PER_DAY * fourier_width);
+        for (int hour = 0; hour < HOURS_PER_DAY; hour++) {
+            fourierTerms(hour, &hour_table[hour * fourier_width]);
+        }
+        annual_table.resize(DAYS_PER_YEAR_TABLE * 2);
+        for (int day = 0; day < DAYS_PER_YEAR_TABLE; day++) {
+            annualTerms(day, &annual_table[day * 2]);
+        }
+    }
+
+    const FeatureSpec& getSpec() const { return spec; }
+    size_t fourierWidth() const { return fourier_width; }
+
+    // Direct evaluation, used to fill the tables and for out-of-range inputs
+    void fourierTerms(int hour, double* out) const {
+        for (int k = 1; k <= spec.fourier_order; k++) {
+            double angle = TWO_PI * k * hour / spec.fourier_period;
+            out[2 * (k - 1)] = std::sin(angle);
+            out[2 * (k - 1) + 1] = std::cos(angle);
+        }
+    }
+
+    void annualTerms(int day, double* out) const {
+        double annual = TWO_PI * day / spec.annual_period;
+        out[0] = std::sin(annual);
+        out[1] = std::cos(annual);
+    }
+
+    // Table row for hour/day, or null when the value falls outside the table
+    const double* hourRow(int hour) const {
+        return (hour >= 0 && hour < HOURS_PER_DAY) ? &hour_table[hour * fourier_width] : 0;
+    }
+
+    const double* annualRow(int day) const {
+        return (day >= 0 && day < DAYS_PER_YEAR_TABLE) ? &annual_table[day * 2] : 0;
+    }
+};
+
+// Columnar weather inputs, one entry per hour (e.g. views into an EnergyHistory);
+// the pointers may be null when n == 0
+struct WeatherColumns {
+    const int* hour_of_day;
+    const int* day_of_year;
+    const double* temperature;
+    const double* cloud_cover;
+    const double* wind_speed;
+    size_t n;
+};
+
+inline WeatherColumns weatherColumns(const EnergyHistory& h) {
+    WeatherColumns cols = { h.hour_of_day.data(), h.day_of_year.data(), h.temperature.data(),
+                            h.cloud_cover.data(), h.wind_speed.data(), h.size() };
+    return cols;
+}
+
+class FeatureBuilder {
+private:
+    FeatureTables tables;
+    size_t p;
+
+public:
+    explicit FeatureBuilder(const FeatureSpec& spec = defaultFeatureSpec())
+        : tables(spec), p(::featureCount(spec)) {}
+
+    size_t featureCount() const { return p; }
+    const FeatureTables& getTables() const { return tables; }
+
+    // Write rows [begin, end) of the design matrix to out (row-major, stride
+    // featureCount()) in one pass: intercept, table lookups and weather
+    // scaling are fused per row. T is double or float.
+    template <typename T>
+    void buildRows(const WeatherColumns& cols, size_t begin, size_t end, T* out) const {
+        const FeatureSpec& spec = tables.getSpec();
+        size_t width = tables.fourierWidth();
+        double scratch[2 * MAX_FOURIER_ORDER + 2];
+
+        for (size_t i = begin; i < end; i++) {
+            T* row = out + (i - begin) * p;
+            row[0] = T(1);
+            const double* fourier = tables.hourRow(cols.hour_of_day[i]);
+            if (!fourier) {
+                tables.fourierTerms(cols.hour_of_day[i], scratch);
+                fourier = scratch;
+            }
+            for (size_t j = 0; j < width; j++) row[1 + j] = T(fourier[j]);
+
+            T* tail = row + 1 + width;
+            tail[0] = T(cols.temperature[i] / spec.temperature_scale);
+            tail[1] = T(cols.cloud_cover[i]);
+            tail[2] = T(cols.wind_speed[i] / spec.wind_speed_scale);
+            const double* annual = tables.annualRow(cols.day_of_year[i]);
+            if (!annual) {
+                tables.annualTerms(cols.day_of_year[i], scratch + width);
+                annual = scratch + width;
+            }
+            tail[3] = T(annual[0]);
+            tail[4] = T(annual[1]);
+        }
+    }
+
+    // Fill a cache-aligned row-major design matrix (n x featureCount())
+    template <typename T>
+    void build(const WeatherColumns& cols, AlignedBuffer<T>& X) const {
+        X.resize(cols.n * p);
+        buildRows(cols, 0, cols.n, X.data());
+    }
+
+    void build(const EnergyHistory& h, AlignedBuffer<double>& X) const {
+        build(weatherColumns(h), X);
+    }
+
+    AlignedBuffer<double> build(const EnergyHistory& h) const {
+        AlignedBuffer<double> X;
+        build(h, X);
+        return X;
+    }
+
+    // Stream the design matrix in tiles of block_rows rows through a reused
+    // buffer: sink(first_row, rows, tile) is called once per tile, so callers
+    // that score or accumulate row by row never hold the full matrix
+    template <typename T, typename Sink>
+    void forEachBlock(const WeatherColumns& cols, size_t block_rows,
+                      AlignedBuffer<T>& tile, Sink sink) const {
+        if (block_rows == 0) block_rows = cols.n;
+        tile.resize(std::min(block_rows, cols.n) * p);
+        for (size_t begin = 0; begin < cols.n; begin += block_rows) {
+            size_t end = std::min(cols.n, begin + block_rows);
+            buildRows(cols, begin, end, tile.data());
+            sink(begin, end - begin, static_cast<const T*>(tile.data()));
+        }
+    }
+};
+
+#endif
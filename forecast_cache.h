@@ -0,0 +1,208 @@
+/**
+ * Forecast Cache
+ * Single-flight, stale-while-revalidate cache in front of ForecastEngine
+ *
+ * - Concurrent requests for the same (site, hour, day) share one computation
+ * - Entries past their TTL are still served (up to stale_seconds) while a
+ *   background refresh runs, so callers never wait on a recompute
+ * - tick() refreshes recently used entries ahead of expiry, and swapping in a
+ *   retrained engine marks every entry for background revalidation
+ * Computations run on a ThreadPool; callbacks fire on the calling thread
+ * (cache hit) or on a pool worker (miss) and must be thread-safe.
+ */
+
+#ifndef FORECAST_CACHE_H
+#define FORECAST_CACHE_H
+
+#include <map>
+#include <vector>
+#include <string>
+#include <memory>
+#include <mutex>
+#include <chrono>
+#include <functional>
+#include <exception>
+#include <cstddef>
+
+#include "thread_pool.h"
+#include "forecast_service.h"
+
+struct ForecastKey {
+    int site_id;
+    int start_hour;
+    int day_of_year;
+
+    bool operator<(const ForecastKey& other) const {
+        if (site_id != other.site_id) return site_id < other.site_id;
+        if (start_hour != other.start_hour) return start_hour < other.start_hour;
+        return day_of_year < other.day_of_year;
+    }
+};
+
+struct ForecastCacheStats {
+    size_t hits;
+    size_t stale_hits;
+    size_t misses;
+    size_t coalesced;        // requests that joined an in-flight computation
+    size_t computations;
+    size_t background_refreshes;
+    size_t entries;
+};
+
+class ForecastCache {
+public:
+    // ok = false carries an error message instead of forecast JSON
+    typedef std::function<void(bool ok, const std::string& payload, bool stale)> Callback;
+    typedef std::chrono::steady_clock Clock;
+
+private:
+    struct Entry {
+        bool has_value;
+        bool ok;
+        std::string payload;              // serialized once per computation
+        Clock::time_point computed_at;
+        Clock::time_point last_access;
+        unsigned generation;
+        bool in_flight;
+        std::vector<Callback> waiters;
+
+        Entry() : has_value(false), ok(false), generation(0), in_flight(false) {}
+    };
+
+    ThreadPool& pool;
+    double ttl_seconds;
+    double stale_seconds;
+    double refresh_ahead;                 // fraction of the TTL after which to refresh
+
+    std::mutex mutex;
+    std::map<ForecastKey, Entry> entries;
+    std::shared_ptr<const ForecastEngine> engine;
+    unsigned generation;
+    ForecastCacheStats counters;
+
+    static double secondsSince(Clock::time_point t, Clock::time_point now) {
+        return std::chrono::duration<double>(now - t).count();
+    }
+
+    // Start a computation for key unless one is running (mutex held). A
+    // computation that throws keeps any earlier value, clears in_flight so
+    // the next request retries, and fails its waiters with ok = false.
+    void startLocked(const ForecastKey& key, Entry& entry, bool background) {
+        if (entry.in_flight) return;
+        std::shared_ptr<const ForecastEngine> snapshot = engine;
+        unsigned snapshot_generation = generation;
+
+        // The task takes the mutex first, so it cannot finish before in_flight is set
+        pool.submit([this, key, snapshot, snapshot_generation](size_t) {
+            Forecast24h forecast;
+            bool ok = false, failed = false;
+            std::string payload;
+            try {
+                ok = snapshot && snapshot->forecast24h(key.site_id, key.start_hour, key.day_of_year, forecast);
+                payload = ok ? forecastToJson(forecast) : std::string("unknown site");
+            } catch (const std::exception& error) {
+                failed = true;
+                payload = std::string("forecast failed: ") + error.what();
+            } catch (...) {
+                failed = true;
+                payload = "forecast failed";
+            }
+            if (failed) ok = false;
+
+            std::vector<Callback> waiters;
+            {
+                std::lock_guard<std::mutex> lock(mutex);
+                Entry& e = entries[key];
+                if (!failed) {
+                    e.has_value = true;
+                    e.ok = ok;
+                    e.payload = payload;
+                    e.computed_at = Clock::now();
+                    e.generation = snapshot_generation;
+                }
+                e.in_flight = false;
+                waiters.swap(e.waiters);
+            }
+            for (size_t i = 0; i < waiters.size(); i++) waiters[i](ok, payload, false);
+        });
+        entry.in_flight = true;
+        counters.computations++;
+        if (background) counters.background_refreshes++;
+    }
+
+public:
+    ForecastCache(ThreadPool& worker_pool, double ttl = 300.0, double stale = 3600.0,
+                  double refresh_fraction = 0.8)
+        : pool(worker_pool), ttl_seconds(ttl), stale_seconds(stale),
+          refresh_ahead(refresh_fraction), generation(0) {
+        ForecastCacheStats zero = {0, 0, 0, 0, 0, 0, 0};
+        counters = zero;
+    }
+
+    // Install a (re)trained engine; cached entries stay servable but are
+    // revalidated in the background by the next tick()
+    void setEngine(std::shared_ptr<const ForecastEngine> next) {
+        std::lock_guard<std::mutex> lock(mutex);
+        engine = next;
+        generation++;
+    }
+
+    void get(const ForecastKey& key, const Callback& callback) {
+        bool ok = false, stale = false;
+        std::string payload;
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            Clock::time_point now = Clock::now();
+            Entry& entry = entries[key];
+            entry.last_access = now;
+
+            double age = entry.has_value ? secondsSince(entry.computed_at, now) : 0.0;
+            if (!entry.has_value || age >= stale_seconds) {
+                // Nothing servable: wait for the (possibly shared) computation
+                if (entry.in_flight) counters.coalesced++;
+                else counters.misses++;
+                entry.waiters.push_back(callback);
+                startLocked(key, entry, false);
+                return;
+            }
+
+            stale = age >= ttl_seconds || entry.generation != generation;
+            if (stale) counters.stale_hits++;
+            else counters.hits++;
+            if (stale || age >= refresh_ahead * ttl_seconds) startLocked(key, entry, true);
+            ok = entry.ok;
+            payload = entry.payload;
+        }
+        callback(ok, payload, stale);
+    }
+
+    // Background scheduler step: refresh hot entries ahead of expiry or after
+    // an engine swap, and drop entries nobody asked for within stale_seconds
+    void tick() {
+        std::lock_guard<std::mutex> lock(mutex);
+        Clock::time_point now = Clock::now();
+        std::map<ForecastKey, Entry>::iterator it = entries.begin();
+        while (it != entries.end()) {
+            Entry& e = it->second;
+            double idle = secondsSince(e.last_access, now);
+            if (!e.in_flight && e.waiters.empty() && idle >= stale_seconds) {
+                entries.erase(it++);
+                continue;
+            }
+            bool hot = idle < ttl_seconds;
+            bool due = e.has_value && (secondsSince(e.computed_at, now) >= refresh_ahead * ttl_seconds ||
+                                       e.generation != generation);
+            if (hot && due) startLocked(it->first, e, true);
+            ++it;
+        }
+    }
+
+    ForecastCacheStats stats() {
+        std::lock_guard<std::mutex> lock(mutex);
+        ForecastCacheStats s = counters;
+        s.entries = entries.size();
+        return s;
+    }
+};
+
+#endif
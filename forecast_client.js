@@ -0,0 +1,120 @@
+/**
+ * Forecast Daemon Client
+ * Persistent Unix-socket connection to forecast_daemon
+ * Requests are newline-delimited JSON matched to responses by id
+ */
+
+const net = require('net');
+
+class ForecastClient {
+  constructor(socketPath, options = {}) {
+    this.socketPath = socketPath;
+    this.timeout = options.timeout || 2000;
+    this.socket = null;
+    this.connecting = null;
+    this.buffer = '';
+    this.nextId = 1;
+    this.pending = new Map();
+  }
+
+  connect() {
+    if (this.socket) return Promise.resolve(this.socket);
+    if (this.connecting) return this.connecting;
+
+    this.connecting = new Promise((resolve, reject) => {
+      const socket = net.createConnection(this.socketPath);
+      socket.setEncoding('utf8');
+
+      socket.once('connect', () => {
+        this.socket = socket;
+        this.connecting = null;
+        resolve(socket);
+      });
+
+      socket.on('data', (chunk) => this.onData(chunk));
+
+      socket.on('error', (error) => {
+        if (this.connecting) {
+          this.connecting = null;
+          reject(error);
+        }
+        this.failPending(error);
+      });
+
+      socket.on('close', () => {
+        this.socket = null;
+        this.buffer = '';
+        this.failPending(new Error('Forecast daemon connection closed'));
+      });
+    });
+
+    return this.connecting;
+  }
+
+  onData(chunk) {
+    this.buffer += chunk;
+    let newline;
+    while ((newline = this.buffer.indexOf('\n')) !== -1) {
+      const line = this.buffer.slice(0, newline);
+      this.buffer = this.buffer.slice(newline + 1);
+
+      let message;
+      try {
+        message = JSON.parse(line);
+      } catch (error) {
+        continue;
+      }
+
+      const entry = this.pending.get(message.id);
+      if (!entry) continue;
+      this.pending.delete(message.id);
+      clearTimeout(entry.timer);
+
+      if (message.ok) {
+        entry.resolve(message.data);
+      } else {
+        entry.reject(new Error(message.error || 'Forecast daemon error'));
+      }
+    }
+  }
+
+  failPending(error) {
+    for (const entry of this.pending.values()) {
+      clearTimeout(entry.timer);
+      entry.reject(error);
+    }
+    this.pending.clear();
+  }
+
+  async request(op, params = {}) {
+    const socket = await this.connect();
+    const id = this.nextId++;
+
+    return new Promise((resolve, reject) => {
+      const timer = setTimeout(() => {
+        this.pending.delete(id);
+        reject(new Error(`Forecast daemon timed out after ${this.timeout} ms`));
+      }, this.timeout);
+
+      this.pending.set(id, { resolve, reject, timer });
+      socket.write(JSON.stringify({ id, op, ...params }) + '\n');
+    });
+  }
+
+  forecast(site = 0, hour, day) {
+    const params = { site };
+    if (hour !== undefined) params.hour = hour;
+    if (day !== undefined) params.day = day;
+    return this.request('forecast', params);
+  }
+
+  stats() {
+    return this.request('stats');
+  }
+
+  close() {
+    if (this.socket) this.socket.end();
+  }
+}
+
+module.exports = ForecastClient;
@@ -0,0 +1,544 @@
+/**
+ * Forecast Daemon
+ * Long-running forecast service on a local Unix socket
+ * Holds the Beta regression models in memory and answers newline-delimited
+ * JSON requests, so server.js no longer spawns a Python retrain per request
+ *
+ * Forecasts are served through ForecastCache: concurrent requests for the same
+ * key share one computation on the worker pool, expired entries are served
+ * stale while they are recomputed, hot keys are refreshed ahead of their TTL,
+ * and a rewritten model store is reloaded in the background.
+ *
+ * Usage: ./forecast_daemon [--socket path] [--models site_models.bin]
+ *                          [--ttl seconds] [--stale seconds] [--threads n]
+ *        ./forecast_daemon --bench [requests] [--socket path]
+ *
+ * Protocol (one JSON object per line; responses carry the request id and may
+ * arrive out of order when a forecast has to be computed):
+ *   {"id":1,"op":"forecast","site":0,"hour":13,"day":289}
+ *       -> {"id":1,"ok":true,"data":{...forecast_output.json shape...}}
+ *       p50 is the predictive mean, as in beta_regression.py; timestamps start
+ *       at the requested hour of the requested day
+ *   {"id":2,"op":"ping"}   -> {"id":2,"ok":true}
+ *   {"id":3,"op":"stats"}  -> {"id":3,"ok":true,"data":{"requests":...,"cache":{...}}}
+ */
+
+#include <iostream>
+#include <iomanip>
+#include <sstream>
+#include <string>
+#include <vector>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <atomic>
+#include <chrono>
+#include <algorithm>
+#include <cstdlib>
+#include <cmath>
+#include <cstring>
+#include <cerrno>
+#include <csignal>
+#include <ctime>
+
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <sys/stat.h>
+#include <poll.h>
+#include <fcntl.h>
+#include <unistd.h>
+
+#include "energy_data.h"
+#include "forecast_service.h"
+#include "forecast_cache.h"
+#include "thread_pool.h"
+
+using namespace std;
+
+const char* DEFAULT_SOCKET_PATH = "/tmp/energy_forecast.sock";
+const size_t MAX_REQUEST_BYTES = 64 * 1024;
+const double MAX_SITE_ID = 2147483647.0;        // sites are int in ForecastKey
+const size_t LATENCY_WINDOW = 4096;
+
+volatile sig_atomic_t stop_requested = 0;
+
+void handleSignal(int) {
+    stop_requested = 1;
+}
+
+// Minimal field extraction for the flat request objects of this protocol
+bool jsonNumberField(const string& line, const char* key, double& out) {
+    string pattern = string("\"") + key + "\"";
+    size_t pos = line.find(pattern);
+    if (pos == string::npos) return false;
+    pos = line.find(':', pos + pattern.size());
+    if (pos == string::npos) return false;
+    const char* start = line.c_str() + pos + 1;
+    char* end = 0;
+    double value = strtod(start, &end);
+    if (end == start) return false;
+    out = value;
+    return true;
+}
+
+bool jsonStringField(const string& line, const char* key, string& out) {
+    string pattern = string("\"") + key + "\"";
+    size_t pos = line.find(pattern);
+    if (pos == string::npos) return false;
+    pos = line.find('"', line.find(':', pos + pattern.size()));
+    if (pos == string::npos) return false;
+    size_t end = line.find('"', pos + 1);
+    if (end == string::npos) return false;
+    out = line.substr(pos + 1, end - pos - 1);
+    return true;
+}
+
+string errorResponse(const string& id, const string& message) {
+    return "{\"id\":" + id + ",\"ok\":false,\"error\":\"" + message + "\"}\n";
+}
+
+class ForecastDaemon {
+private:
+    typedef unsigned long long ConnectionId;
+
+    struct Client {
+        int fd;
+        string input;
+        string output;
+    };
+
+    // Response produced on any thread, delivered by the event loop
+    struct Completion {
+        ConnectionId connection;
+        string response;
+        chrono::steady_clock::time_point received;
+    };
+
+    ForecastCache& cache;
+    const atomic<size_t>& model_count;
+    int listen_fd;
+    int wake_pipe[2];
+    string socket_path;
+    map<ConnectionId, Client> clients;
+    map<int, ConnectionId> connection_by_fd;
+    ConnectionId next_connection;
+
+    mutex completion_mutex;
+    vector<Completion> completions;
+
+    size_t requests;
+    vector<double> latencies_us;     // ring buffer of recent service times
+    size_t latency_next;
+
+    string statsJson() {
+        vector<double> sorted(latencies_us);
+        sort(sorted.begin(), sorted.end());
+        double p50 = sorted.empty() ? 0.0 : sorted[sorted.size() / 2];
+        double p99 = sorted.empty() ? 0.0 : sorted[min(sorted.size() - 1, sorted.size() * 99 / 100)];
+        ForecastCacheStats c = cache.stats();
+        ostringstream os;
+        os << fixed << setprecision(1) << "{\"requests\":" << requests << ",\"models\":"
+           << model_count.load() << ",\"clients\":" << clients.size()
+           << ",\"p50_us\":" << p50 << ",\"p99_us\":" << p99
+           << ",\"cache\":{\"entries\":" << c.entries << ",\"hits\":" << c.hits
+           << ",\"stale_hits\":" << c.stale_hits << ",\"misses\":" << c.misses
+           << ",\"coalesced\":" << c.coalesced << ",\"computations\":" << c.computations
+           << ",\"background_refreshes\":" << c.background_refreshes << "}}";
+        return os.str();
+    }
+
+    void post(ConnectionId connection, const string& response, chrono::steady_clock::time_point received) {
+        Completion done = { connection, response, received };
+        {
+            lock_guard<mutex> lock(completion_mutex);
+            completions.push_back(done);
+        }
+        char byte = 1;
+        if (write(wake_pipe[1], &byte, 1) < 0 && errno != EAGAIN) {
+            cerr << "Warning: wake pipe write failed: " << strerror(errno) << endl;
+        }
+    }
+
+    void handleRequest(ConnectionId connection, const string& line) {
+        chrono::steady_clock::time_point received = chrono::steady_clock::now();
+        double id_value = 0;
+        bool has_id = jsonNumberField(line, "id", id_value) && fabs(id_value) < 9e15;
+        string id = has_id ? to_string((long long)id_value) : "null";
+        string op;
+        if (!jsonStringField(line, "op", op)) return post(connection, errorResponse(id, "missing op"), received);
+
+        if (op == "ping") return post(connection, "{\"id\":" + id + ",\"ok\":true}\n", received);
+        if (op == "stats") {
+            return post(connection, "{\"id\":" + id + ",\"ok\":true,\"data\":" + statsJson() + "}\n", received);
+        }
+        if (op != "forecast") return post(connection, errorResponse(id, "unknown op"), received);
+
+        time_t now = time(0);
+        tm local;
+        localtime_r(&now, &local);
+        double site = 0, hour = local.tm_hour, day = local.tm_yday + 1;
+        jsonNumberField(line, "site", site);
+        jsonNumberField(line, "hour", hour);
+        jsonNumberField(line, "day", day);
+        // Negated comparisons also reject NaN, which jsonNumberField can return
+        if (!(site >= 0 && site <= MAX_SITE_ID)) {
+            return post(connection, errorResponse(id, "site out of range"), received);
+        }
+        if (!(hour >= 0 && hour <= 23) || !(day >= 0 && day <= 366)) {
+            return post(connection, errorResponse(id, "hour or day out of range"), received);
+        }
+
+        ForecastKey key = { (int)site, (int)hour, (int)day };
+        cache.get(key, [this, connection, id, received](bool ok, const string& payload, bool) {
+            post(connection, ok ? "{\"id\":" + id + ",\"ok\":true,\"data\":" + payload + "}\n"
+                                : errorResponse(id, payload), received);
+        });
+    }
+
+    void recordLatency(double us) {
+        if (latencies_us.size() < LATENCY_WINDOW) latencies_us.push_back(us);
+        else latencies_us[latency_next] = us;
+        latency_next = (latency_next + 1) % LATENCY_WINDOW;
+    }
+
+    // Move finished responses to their connections (dropped if it closed)
+    void drainCompletions() {
+        char buf[256];
+        while (read(wake_pipe[0], buf, sizeof(buf)) > 0) {}
+
+        vector<Completion> ready;
+        {
+            lock_guard<mutex> lock(completion_mutex);
+            ready.swap(completions);
+        }
+        chrono::steady_clock::time_point now = chrono::steady_clock::now();
+        for (size_t i = 0; i < ready.size(); i++) {
+            recordLatency(chrono::duration<double, micro>(now - ready[i].received).count());
+            map<ConnectionId, Client>::iterator it = clients.find(ready[i].connection);
+            if (it != clients.end()) it->second.output += ready[i].response;
+        }
+    }
+
+    // Read what is available; returns false when the client should be dropped
+    // (closed, failed, or a request line longer than MAX_REQUEST_BYTES)
+    bool readClient(ConnectionId connection, Client& c) {
+        char buf[16384];
+        for (;;) {
+            ssize_t got = read(c.fd, buf, sizeof(buf));
+            if (got > 0) {
+                c.input.append(buf, got);
+                // Answer complete lines as they arrive so the buffer stays bounded
+                if (!handleLines(connection, c)) return false;
+                continue;
+            }
+            if (got == 0) return false;
+            if (errno == EAGAIN || errno == EWOULDBLOCK) break;
+            if (errno == EINTR) continue;
+            return false;
+        }
+        return true;
+    }
+
+    bool handleLines(ConnectionId connection, Client& c) {
+        size_t start = 0, newline;
+        while ((newline = c.input.find('\n', start)) != string::npos) {
+            handleRequest(connection, c.input.substr(start, newline - start));
+            requests++;
+            start = newline + 1;
+        }
+        c.input.erase(0, start);
+        return c.input.size() <= MAX_REQUEST_BYTES;
+    }
+
+    bool writeClient(Client& c) {
+        while (!c.output.empty()) {
+            ssize_t sent = write(c.fd, c.output.data(), c.output.size());
+            if (sent > 0) {
+                c.output.erase(0, sent);
+                continue;
+            }
+            if (sent < 0 && (errno == EAGAIN || errno == EWOULDBLOCK)) return true;
+            if (sent < 0 && errno == EINTR) continue;
+            return false;
+        }
+        return true;
+    }
+
+    void acceptClients() {
+        for (;;) {
+            int fd = accept(listen_fd, 0, 0);
+            if (fd < 0) break;
+            fcntl(fd, F_SETFL, fcntl(fd, F_GETFL) | O_NONBLOCK);
+            Client c;
+            c.fd = fd;
+            ConnectionId connection = next_connection++;
+            clients[connection] = c;
+            connection_by_fd[fd] = connection;
+        }
+    }
+
+    void dropClient(ConnectionId connection) {
+        map<ConnectionId, Client>::iterator it = clients.find(connection);
+        if (it == clients.end()) return;
+        close(it->second.fd);
+        connection_by_fd.erase(it->second.fd);
+        clients.erase(it);
+    }
+
+public:
+    ForecastDaemon(ForecastCache& forecast_cache, const atomic<size_t>& models, const string& path)
+        : cache(forecast_cache), model_count(models), listen_fd(-1), socket_path(path),
+          next_connection(1), requests(0), latency_next(0) {
+        wake_pipe[0] = wake_pipe[1] = -1;
+    }
+
+    ~ForecastDaemon() {
+        for (map<ConnectionId, Client>::iterator it = clients.begin(); it != clients.end(); ++it) {
+            close(it->second.fd);
+        }
+        if (wake_pipe[0] >= 0) {
+            close(wake_pipe[0]);
+            close(wake_pipe[1]);
+        }
+        if (listen_fd >= 0) {
+            close(listen_fd);
+            unlink(socket_path.c_str());
+        }
+    }
+
+    bool listen() {
+        sockaddr_un addr;
+        memset(&addr, 0, sizeof(addr));
+        addr.sun_family = AF_UNIX;
+        if (socket_path.size() >= sizeof(addr.sun_path)) {
+            cerr << "Error: Socket path too long: " << socket_path << endl;
+            return false;
+        }
+        strcpy(addr.sun_path, socket_path.c_str());
+
+        if (pipe(wake_pipe) != 0) {
+            cerr << "Error: Cannot create wake pipe: " << strerror(errno) << endl;
+            return false;
+        }
+        fcntl(wake_pipe[0], F_SETFL, fcntl(wake_pipe[0], F_GETFL) | O_NONBLOCK);
+        fcntl(wake_pipe[1], F_SETFL, fcntl(wake_pipe[1], F_GETFL) | O_NONBLOCK);
+
+        listen_fd = socket(AF_UNIX, SOCK_STREAM, 0);
+        if (listen_fd < 0) {
+            cerr << "Error: Cannot create socket: " << strerror(errno) << endl;
+            return false;
+        }
+        unlink(socket_path.c_str());
+        if (bind(listen_fd, (sockaddr*)&addr, sizeof(addr)) != 0 || ::listen(listen_fd, 128) != 0) {
+            cerr << "Error: Cannot listen on " << socket_path << ": " << strerror(errno) << endl;
+            return false;
+        }
+        fcntl(listen_fd, F_SETFL, fcntl(listen_fd, F_GETFL) | O_NONBLOCK);
+        return true;
+    }
+
+    // Event loop; housekeeping() runs about once a second (refresh-ahead, reloads)
+    void run(const function<void()>& housekeeping) {
+        vector<pollfd> fds;
+        vector<ConnectionId> polled;
+        chrono::steady_clock::time_point last_tick = chrono::steady_clock::now();
+
+        while (!stop_requested) {
+            fds.clear();
+            polled.clear();
+            pollfd listener = { listen_fd, POLLIN, 0 };
+            pollfd waker = { wake_pipe[0], POLLIN, 0 };
+            fds.push_back(listener);
+            fds.push_back(waker);
+            for (map<ConnectionId, Client>::iterator it = clients.begin(); it != clients.end(); ++it) {
+                pollfd p = { it->second.fd, (short)(POLLIN | (it->second.output.empty() ? 0 : POLLOUT)), 0 };
+                fds.push_back(p);
+                polled.push_back(it->first);
+            }
+
+            int ready = poll(&fds[0], fds.size(), 250);
+            if (ready < 0 && errno != EINTR) {
+                cerr << "Error: poll failed: " << strerror(errno) << endl;
+                break;
+            }
+
+            if (ready > 0) {
+                if (fds[0].revents & POLLIN) acceptClients();
+                for (size_t i = 2; i < fds.size(); i++) {
+                    if (!(fds[i].revents & (POLLIN | POLLHUP | POLLERR))) continue;
+                    map<ConnectionId, Client>::iterator it = clients.find(polled[i - 2]);
+                    if (it != clients.end() && !readClient(it->first, it->second)) dropClient(polled[i - 2]);
+                }
+            }
+
+            // Cache hits complete synchronously, so always drain before writing
+            drainCompletions();
+            vector<ConnectionId> broken;
+            for (map<ConnectionId, Client>::iterator it = clients.begin(); it != clients.end(); ++it) {
+                if (!it->second.output.empty() && !writeClient(it->second)) broken.push_back(it->first);
+            }
+            for (size_t i = 0; i < broken.size(); i++) dropClient(broken[i]);
+
+            chrono::steady_clock::time_point now = chrono::steady_clock::now();
+            if (now - last_tick >= chrono::seconds(1)) {
+                last_tick = now;
+                housekeeping();
+            }
+        }
+    }
+};
+
+int connectSocket(const string& path) {
+    sockaddr_un addr;
+    memset(&addr, 0, sizeof(addr));
+    addr.sun_family = AF_UNIX;
+    strncpy(addr.sun_path, path.c_str(), sizeof(addr.sun_path) - 1);
+    int fd = socket(AF_UNIX, SOCK_STREAM, 0);
+    if (fd < 0 || connect(fd, (sockaddr*)&addr, sizeof(addr)) != 0) {
+        cerr << "Error: Cannot connect to " << path << ": " << strerror(errno) << endl;
+        if (fd >= 0) close(fd);
+        return -1;
+    }
+    return fd;
+}
+
+// Round-trip latency of sequential forecast requests against a running daemon
+int runBenchmark(const string& path, int n_requests) {
+    int fd = connectSocket(path);
+    if (fd < 0) return 1;
+
+    vector<double> latencies;
+    string pending;
+    char buf[65536];
+    for (int r = 0; r < n_requests; r++) {
+        ostringstream req;
+        req << "{\"id\":" << r << ",\"op\":\"forecast\",\"site\":0,\"hour\":" << r % 24
+            << ",\"day\":" << 1 + r % 365 << "}\n";
+        string line = req.str();
+        auto start = chrono::steady_clock::now();
+        if (write(fd, line.data(), line.size()) != (ssize_t)line.size()) {
+            cerr << "Error: write failed" << endl;
+            close(fd);
+            return 1;
+        }
+        size_t newline;
+        while ((newline = pending.find('\n')) == string::npos) {
+            ssize_t got = read(fd, buf, sizeof(buf));
+            if (got <= 0) {
+                cerr << "Error: daemon closed the connection" << endl;
+                close(fd);
+                return 1;
+            }
+            pending.append(buf, got);
+        }
+        latencies.push_back(chrono::duration<double, milli>(chrono::steady_clock::now() - start).count());
+        if (pending.find("\"ok\":true") > newline) {
+            cerr << "Error: " << pending.substr(0, newline) << endl;
+            close(fd);
+            return 1;
+        }
+        pending.erase(0, newline + 1);
+    }
+    close(fd);
+
+    sort(latencies.begin(), latencies.end());
+    size_t n = latencies.size();
+    cout << n << " forecast requests over " << path << endl;
+    cout << fixed << setprecision(3)
+         << "p50 = " << latencies[n / 2] << " ms, p90 = " << latencies[n * 90 / 100]
+         << " ms, p99 = " << latencies[min(n - 1, n * 99 / 100)]
+         << " ms, max = " << latencies[n - 1] << " ms" << endl;
+    return 0;
+}
+
+long long modificationTime(const string& path) {
+    struct stat st;
+    return stat(path.c_str(), &st) == 0 ? (long long)st.st_mtime : -1;
+}
+
+int main(int argc, char** argv) {
+    string socket_path = DEFAULT_SOCKET_PATH;
+    string models_path;
+    bool bench = false;
+    int bench_requests = 2000;
+    double ttl = 300.0, stale = 3600.0;
+    int n_threads = 0;
+
+    for (int i = 1; i < argc; i++) {
+        string arg = argv[i];
+        if (arg == "--socket" && i + 1 < argc) socket_path = argv[++i];
+        else if (arg == "--models" && i + 1 < argc) models_path = argv[++i];
+        else if (arg == "--ttl" && i + 1 < argc) ttl = atof(argv[++i]);
+        else if (arg == "--stale" && i + 1 < argc) stale = atof(argv[++i]);
+        else if (arg == "--threads" && i + 1 < argc) n_threads = atoi(argv[++i]);
+        else if (arg == "--bench") {
+            bench = true;
+            if (i + 1 < argc && argv[i + 1][0] != '-') bench_requests = atoi(argv[++i]);
+        } else {
+            cerr << "Usage: " << argv[0] << " [--socket path] [--models file] [--ttl s] [--stale s]"
+                 << " [--threads n] [--bench [requests]]" << endl;
+            return 1;
+        }
+    }
+
+    if (bench) return runBenchmark(socket_path, max(bench_requests, 1));
+
+    cout << "========================================" << endl;
+    cout << "FORECAST DAEMON" << endl;
+    cout << "========================================" << endl;
+
+    shared_ptr<ForecastEngine> engine = make_shared<ForecastEngine>();
+    auto start = chrono::steady_clock::now();
+    long long models_mtime = -1;
+    if (!models_path.empty()) {
+        models_mtime = modificationTime(models_path);
+        if (!engine->loadStore(models_path)) return 1;
+    } else {
+        // Same training run as beta_regression.py: 90 days of synthetic history
+        engine->train(0, generateSyntheticHistory(90));
+    }
+    double load_ms = chrono::duration<double, milli>(chrono::steady_clock::now() - start).count();
+    cout << "Models: " << engine->modelCount() << " loaded in " << fixed << setprecision(1)
+         << load_ms << " ms" << endl;
+
+    signal(SIGINT, handleSignal);
+    signal(SIGTERM, handleSignal);
+    signal(SIGPIPE, SIG_IGN);
+
+    ThreadPool pool(n_threads > 0 ? n_threads : 0);
+    atomic<size_t> model_count(engine->modelCount());
+    atomic<bool> reloading(false);
+    ForecastCache cache(pool, ttl, stale);
+    cache.setEngine(engine);
+
+    // Refresh-ahead for hot keys, and pick up a rewritten model store off the
+    // event loop; requests keep getting the previous models until the swap
+    auto housekeeping = [&]() {
+        cache.tick();
+        if (models_path.empty() || reloading) return;
+        long long mtime = modificationTime(models_path);
+        if (mtime < 0 || mtime == models_mtime) return;
+        models_mtime = mtime;
+        reloading = true;
+        pool.submit([&](size_t) {
+            shared_ptr<ForecastEngine> next = make_shared<ForecastEngine>();
+            if (next->loadStore(models_path)) {
+                model_count = next->modelCount();
+                cache.setEngine(next);
+                cout << "Reloaded " << next->modelCount() << " models from " << models_path << endl;
+            }
+            reloading = false;
+        });
+    };
+
+    {
+        ForecastDaemon daemon(cache, model_count, socket_path);
+        if (!daemon.listen()) return 1;
+        cout << "Listening on " << socket_path << " (" << pool.size() << " workers, ttl "
+             << setprecision(0) << ttl << " s, stale " << stale << " s)" << endl;
+        daemon.run(housekeeping);
+        pool.wait();
+    }
+    cout << "Shutting down" << endl;
+    return 0;
+}
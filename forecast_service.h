@@ -0,0 +1,258 @@
+/**
+ * Forecast Service
+ * In-memory solar/wind models answering 24-hour P10/P50/P90 forecasts
+ * Native counterpart of EnergyForecastingSystem.forecast_24h(), shared by the
+ * forecast daemon and the language bindings
+ */
+
+#ifndef FORECAST_SERVICE_H
+#define FORECAST_SERVICE_H
+
+#include <vector>
+#include <map>
+#include <string>
+#include <sstream>
+#include <iomanip>
+#include <random>
+#include <utility>
+#include <ctime>
+#include <cmath>
+#include <cstddef>
+
+#include "energy_data.h"
+#include "feature_builder.h"
+#include "beta_regression.h"
+#include "model_store.h"
+#include "training_scheduler.h"
+
+const int FORECAST_HOURS = 24;
+const int FORECAST_LEVELS = 3;
+// Levels of the p10 / p50 / p90 series. The middle one is reported as the
+// predictive mean, as beta_regression.py does, not as the Beta median.
+const double FORECAST_QUANTILES[FORECAST_LEVELS] = {0.1, 0.5, 0.9};
+
+struct Forecast24h {
+    int site_id;
+    int start_hour;
+    int day_of_year;
+    long long issued_at;                        // unix seconds
+    long long start_time;                       // unix seconds of the first forecast hour
+    int hour[FORECAST_HOURS];
+    double solar[FORECAST_LEVELS][FORECAST_HOURS];   // p10, p50 (predictive mean), p90
+    double wind[FORECAST_LEVELS][FORECAST_HOURS];
+};
+
+// Predictive Beta(alpha, beta) distribution of each forecast hour, by target
+// (TARGET_SOLAR, TARGET_WIND); input to the Monte Carlo risk engine
+struct PredictiveShapes24h {
+    int site_id;
+    int start_hour;
+    int day_of_year;
+    double alpha[2][FORECAST_HOURS];
+    double beta[2][FORECAST_HOURS];
+};
+
+// Simulated weather for the forecast horizon (same model as forecast_24h()),
+// seeded by (site, day, hour) so repeated requests see the same forecast
+struct WeatherForecast {
+    std::vector<int> hour_of_day, day_of_year;
+    std::vector<double> temperature, cloud_cover, wind_speed;
+};
+
+inline WeatherForecast simulateWeather(int site_id, int start_hour, int day_of_year) {
+    std::mt19937 rng(static_cast<unsigned>(site_id) * 1000003u
+                     + static_cast<unsigned>(day_of_year) * 24u + static_cast<unsigned>(start_hour));
+    std::normal_distribution<double> normal(0.0, 1.0);
+    std::gamma_distribution<double> gamma(2.0, 1.5);
+
+    WeatherForecast w;
+    double annual = std::sin(TWO_PI * day_of_year / 365.0);
+    for (int h = 0; h < FORECAST_HOURS; h++) {
+        w.hour_of_day.push_back((start_hour + h) % 24);
+        w.day_of_year.push_back(day_of_year);
+        w.temperature.push_back(20 + 5 * annual + normal(rng) * 2);
+        w.cloud_cover.push_back(std::min(1.0, std::max(0.0, 0.3 + normal(rng) * 0.15)));
+        w.wind_speed.push_back(6 + 2 * annual + gamma(rng));
+    }
+    return w;
+}
+
+// Local time of (start_hour, day_of_year) in the year of issued_at;
+// day_of_year counts from 1 like tm_yday + 1
+inline long long forecastStartTime(long long issued_at, int start_hour, int day_of_year) {
+    std::time_t now = (std::time_t)issued_at;
+    std::tm local;
+    localtime_r(&now, &local);
+    local.tm_mon = 0;
+    local.tm_mday = day_of_year;
+    local.tm_hour = start_hour;
+    local.tm_min = 0;
+    local.tm_sec = 0;
+    local.tm_isdst = -1;
+    return (long long)std::mktime(&local);
+}
+
+class ForecastEngine {
+private:
+    struct SiteModel {
+        std::vector<double> coefficients;
+        double phi;
+    };
+
+    std::map<std::pair<int, int>, SiteModel> models;
+    FeatureBuilder builder;
+
+    // Solar and wind models of a site; false if either is missing
+    bool siteModels(int site_id, const SiteModel*& solar, const SiteModel*& wind) const {
+        std::map<std::pair<int, int>, SiteModel>::const_iterator s =
+            models.find(std::make_pair(site_id, (int)TARGET_SOLAR));
+        std::map<std::pair<int, int>, SiteModel>::const_iterator w =
+            models.find(std::make_pair(site_id, (int)TARGET_WIND));
+        if (s == models.end() || w == models.end()) return false;
+        solar = &s->second;
+        wind = &w->second;
+        return true;
+    }
+
+    // Design matrix of the horizon's simulated weather; fills the hours
+    void buildHorizon(int site_id, int start_hour, int day_of_year, AlignedBuffer<double>& X,
+                      int hours[FORECAST_HOURS]) const {
+        WeatherForecast w = simulateWeather(site_id, start_hour, day_of_year);
+        WeatherColumns cols = { &w.hour_of_day[0], &w.day_of_year[0], &w.temperature[0],
+                                &w.cloud_cover[0], &w.wind_speed[0], (size_t)FORECAST_HOURS };
+        builder.build(cols, X);
+        for (int h = 0; h < FORECAST_HOURS; h++) hours[h] = w.hour_of_day[h];
+    }
+
+public:
+    ForecastEngine() {}
+
+    size_t modelCount() const { return models.size(); }
+
+    bool hasSite(int site_id) const {
+        return models.count(std::make_pair(site_id, (int)TARGET_SOLAR)) &&
+               models.count(std::make_pair(site_id, (int)TARGET_WIND));
+    }
+
+    void setModel(int site_id, int target, const std::vector<double>& coefficients, double phi) {
+        SiteModel& m = models[std::make_pair(site_id, target)];
+        m.coefficients = coefficients;
+        m.phi = phi;
+    }
+
+    // Load every model from a store written by the training scheduler
+    bool loadStore(const std::string& path) {
+        MappedModelStore store;
+        if (!store.open(path, true)) return false;
+        for (size_t i = 0; i < store.size(); i++) {
+            const ModelRecord& r = store.record(i);
+            if (!recordValid(r) || r.n_features != builder.featureCount()) continue;
+            setModel(r.site_id, r.target,
+                     std::vector<double>(r.coefficients, r.coefficients + r.n_features), r.phi);
+        }
+        return true;
+    }
+
+    // Fit one site on its history (as EnergyForecastingSystem.train())
+    void train(int site_id, const EnergyHistory& history) {
+        AlignedBuffer<double> X = builder.build(history);
+        size_t p = builder.featureCount();
+        BetaRegression model;
+        model.fit(X.data(), &history.solar_capacity[0], history.size(), p);
+        setModel(site_id, TARGET_SOLAR, model.getCoefficients(), model.getPhi());
+        model.fit(X.data(), &history.wind_capacity[0], history.size(), p);
+        setModel(site_id, TARGET_WIND, model.getCoefficients(), model.getPhi());
+    }
+
+    // 24-hour forecast starting at start_hour; false for an unknown site.
+    // Safe to call concurrently (no shared mutable state).
+    bool forecast24h(int site_id, int start_hour, int day_of_year, Forecast24h& out) const {
+        const SiteModel* solar;
+        const SiteModel* wind;
+        if (!siteModels(site_id, solar, wind)) return false;
+        AlignedBuffer<double> X;
+        buildHorizon(site_id, start_hour, day_of_year, X, out.hour);
+
+        out.site_id = site_id;
+        out.start_hour = start_hour;
+        out.day_of_year = day_of_year;
+        out.issued_at = (long long)std::time(0);
+        out.start_time = forecastStartTime(out.issued_at, start_hour, day_of_year);
+
+        // p10 and p90 from the Beta quantiles, p50 the predictive mean
+        size_t rows = X.size() / builder.featureCount();
+        const double outer[2] = { FORECAST_QUANTILES[0], FORECAST_QUANTILES[FORECAST_LEVELS - 1] };
+        double bands[FORECAST_HOURS * 2];
+        BetaRegression model;
+        const SiteModel* sources[2] = { solar, wind };
+        for (int t = 0; t < 2; t++) {
+            model.setParameters(sources[t]->coefficients, sources[t]->phi);
+            double (*dst)[FORECAST_HOURS] = t == 0 ? out.solar : out.wind;
+            model.predictQuantiles(X.data(), rows, outer, 2, bands);
+            model.predict(X.data(), rows, dst[1]);
+            for (int h = 0; h < FORECAST_HOURS; h++) {
+                dst[0][h] = bands[h * 2];
+                dst[FORECAST_LEVELS - 1][h] = bands[h * 2 + 1];
+            }
+        }
+        return true;
+    }
+
+    // Beta shapes behind forecast24h(), for sampling instead of fixed quantiles
+    bool predictiveShapes(int site_id, int start_hour, int day_of_year, PredictiveShapes24h& out) const {
+        const SiteModel* sources[2];
+        if (!siteModels(site_id, sources[TARGET_SOLAR], sources[TARGET_WIND])) return false;
+        AlignedBuffer<double> X;
+        int hours[FORECAST_HOURS];
+        buildHorizon(site_id, start_hour, day_of_year, X, hours);
+
+        out.site_id = site_id;
+        out.start_hour = start_hour;
+        out.day_of_year = day_of_year;
+        BetaRegression model;
+        for (int t = 0; t < 2; t++) {
+            model.setParameters(sources[t]->coefficients, sources[t]->phi);
+            model.predictShapes(X.data(), X.size() / builder.featureCount(), out.alpha[t], out.beta[t]);
+        }
+        return true;
+    }
+};
+
+inline void writeJsonArray(std::ostringstream& os, const double* values, int n) {
+    os << '[';
+    for (int i = 0; i < n; i++) os << (i ? "," : "") << values[i];
+    os << ']';
+}
+
+// Same shape as forecast_output.json written by beta_regression.py
+inline std::string forecastToJson(const Forecast24h& f) {
+    std::ostringstream os;
+    os << std::setprecision(6);
+    os << "{\"timestamp\":[";
+    for (int h = 0; h < FORECAST_HOURS; h++) {
+        std::time_t t = (std::time_t)(f.start_time + 3600LL * h);
+        std::tm local;
+        localtime_r(&t, &local);
+        char buf[32];
+        std::strftime(buf, sizeof(buf), "%Y-%m-%d %H:%M:%S", &local);
+        os << (h ? "," : "") << '"' << buf << '"';
+    }
+    os << "],\"hour\":[";
+    for (int h = 0; h < FORECAST_HOURS; h++) os << (h ? "," : "") << f.hour[h];
+    os << "]";
+    const char* names[2] = { "solar", "wind" };
+    const double (*series[2])[FORECAST_HOURS] = { f.solar, f.wind };
+    for (int t = 0; t < 2; t++) {
+        os << ",\"" << names[t] << "\":{";
+        const char* keys[FORECAST_LEVELS] = { "p10", "p50", "p90" };
+        for (int l = 0; l < FORECAST_LEVELS; l++) {
+            os << (l ? "," : "") << '"' << keys[l] << "\":";
+            writeJsonArray(os, series[t][l], FORECAST_HOURS);
+        }
+        os << '}';
+    }
+    os << ",\"site\":" << f.site_id << ",\"day_of_year\":" << f.day_of_year << '}';
+    return os.str();
+}
+
+#endif
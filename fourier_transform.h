@@ -0,0 +1,262 @@
+/**
+ * Fourier Transform
+ * FFT spectrum and FFT-based seasonal decomposition of energy series
+ * Shared by the fourier_transform driver and the Node.js addon
+ */
+
+#ifndef FOURIER_TRANSFORM_H
+#define FOURIER_TRANSFORM_H
+
+#include <vector>
+#include <cmath>
+#include <complex>
+#include <algorithm>
+#include <utility>
+#include <cstddef>
+
+const double PI = 3.14159265358979323846;
+
+class FourierTransform {
+private:
+    std::vector<std::complex<double>> data;
+    int n;
+    
+public:
+    FourierTransform(const std::vector<double>& input) {
+        n = input.size();
+        data.resize(n);
+        for (int i = 0; i < n; i++) {
+            data[i] = std::complex<double>(input[i], 0.0);
+        }
+    }
+    
+    // Read a raw float/double series in place (typed arrays, mapped files)
+    template <typename T>
+    FourierTransform(const T* input, size_t length) {
+        n = (int)length;
+        data.resize(n);
+        for (int i = 0; i < n; i++) {
+            data[i] = std::complex<double>((double)input[i], 0.0);
+        }
+    }
+    
+    // Cooley-Tukey FFT algorithm
+    void fft(std::vector<std::complex<double>>& x) {
+        int N = x.size();
+        if (N <= 1) return;
+        
+        // Divide
+        std::vector<std::complex<double>> even(N/2), odd(N/2);
+        for (int i = 0; i < N/2; i++) {
+            even[i] = x[i*2];
+            odd[i] = x[i*2 + 1];
+        }
+        
+        // Conquer
+        fft(even);
+        fft(odd);
+        
+        // Combine
+        for (int k = 0; k < N/2; k++) {
+            std::complex<double> t = std::polar(1.0, -2 * PI * k / N) * odd[k];
+            x[k] = even[k] + t;
+            x[k + N/2] = even[k] - t;
+        }
+    }
+    
+    // Inverse FFT
+    void ifft(std::vector<std::complex<double>>& x) {
+        int N = x.size();
+        
+        // Conjugate
+        for (int i = 0; i < N; i++) {
+            x[i] = std::conj(x[i]);
+        }
+        
+        // Forward FFT
+        fft(x);
+        
+        // Conjugate and scale
+        for (int i = 0; i < N; i++) {
+            x[i] = std::conj(x[i]) / std::complex<double>(N, 0);
+        }
+    }
+    
+    // Compute FFT and return frequencies and magnitudes
+    void compute() {
+        // Pad to nearest power of 2
+        int padded_size = 1;
+        while (padded_size < n) {
+            padded_size *= 2;
+        }
+        
+        std::vector<std::complex<double>> padded_data(padded_size);
+        for (int i = 0; i < n; i++) {
+            padded_data[i] = data[i];
+        }
+        for (int i = n; i < padded_size; i++) {
+            padded_data[i] = std::complex<double>(0.0, 0.0);
+        }
+        
+        fft(padded_data);
+        data = padded_data;
+    }
+    
+    // Length of the zero-padded transform; bin k has period getTransformLength() / k samples
+    int getTransformLength() const { return (int)data.size(); }
+
+    // Get magnitude spectrum
+    std::vector<double> getMagnitudeSpectrum() {
+        std::vector<double> magnitude(data.size() / 2);
+        for (size_t i = 0; i < magnitude.size(); i++) {
+            magnitude[i] = std::abs(data[i]);
+        }
+        return magnitude;
+    }
+    
+    // Get phase spectrum
+    std::vector<double> getPhaseSpectrum() {
+        std::vector<double> phase(data.size() / 2);
+        for (size_t i = 0; i < phase.size(); i++) {
+            phase[i] = std::arg(data[i]);
+        }
+        return phase;
+    }
+    
+    // Extract dominant frequencies
+    std::vector<std::pair<int, double>> getDominantFrequencies(int top_k = 5) {
+        std::vector<double> magnitude = getMagnitudeSpectrum();
+        std::vector<std::pair<int, double>> freq_mag;
+        
+        for (size_t i = 1; i < magnitude.size(); i++) {
+            freq_mag.push_back(std::make_pair(i, magnitude[i]));
+        }
+        
+        std::sort(freq_mag.begin(), freq_mag.end(), 
+             [](const std::pair<int, double>& a, const std::pair<int, double>& b) {
+                 return a.second > b.second;
+             });
+        
+        std::vector<std::pair<int, double>> result;
+        for (int i = 0; i < std::min(top_k, (int)freq_mag.size()); i++) {
+            result.push_back(freq_mag[i]);
+        }
+        
+        return result;
+    }
+};
+
+class SeasonalDecomposition {
+private:
+    std::vector<double> original;
+    std::vector<double> trend;
+    std::vector<double> seasonal;
+    std::vector<double> residual;
+    int period;
+    
+public:
+    SeasonalDecomposition(const std::vector<double>& data, int period_length) 
+        : original(data), period(period_length) {
+        trend.resize(data.size());
+        seasonal.resize(data.size());
+        residual.resize(data.size());
+    }
+    
+    template <typename T>
+    SeasonalDecomposition(const T* values, size_t length, int period_length)
+        : original(values, values + length), period(period_length) {
+        trend.resize(length);
+        seasonal.resize(length);
+        residual.resize(length);
+    }
+    
+    // Moving average for trend extraction
+    void extractTrend() {
+        int window = period;
+        for (size_t i = 0; i < original.size(); i++) {
+            double sum = 0.0;
+            int count = 0;
+            
+            for (int j = -(window/2); j <= window/2; j++) {
+                int idx = i + j;
+                if (idx >= 0 && idx < (int)original.size()) {
+                    sum += original[idx];
+                    count++;
+                }
+            }
+            
+            trend[i] = sum / count;
+        }
+    }
+    
+    // Extract seasonal component using Fourier analysis
+    void extractSeasonal() {
+        std::vector<double> detrended(original.size());
+        for (size_t i = 0; i < original.size(); i++) {
+            detrended[i] = original[i] - trend[i];
+        }
+        
+        // Use FFT to identify seasonal patterns
+        FourierTransform ft(detrended);
+        ft.compute();
+        
+        auto dominant = ft.getDominantFrequencies(3);
+        
+        // Reconstruct seasonal component from dominant frequencies
+        for (size_t i = 0; i < seasonal.size(); i++) {
+            seasonal[i] = 0.0;
+            for (const auto& freq : dominant) {
+                int k = freq.first;
+                double magnitude = freq.second / seasonal.size();
+                seasonal[i] += magnitude * std::cos(2 * PI * k * i / seasonal.size());
+            }
+        }
+        
+        // Normalize seasonal component
+        double seasonal_mean = 0.0;
+        for (double val : seasonal) {
+            seasonal_mean += val;
+        }
+        seasonal_mean /= seasonal.size();
+        
+        for (double& val : seasonal) {
+            val -= seasonal_mean;
+        }
+    }
+    
+    // Calculate residual
+    void extractResidual() {
+        for (size_t i = 0; i < original.size(); i++) {
+            residual[i] = original[i] - trend[i] - seasonal[i];
+        }
+    }
+    
+    // Perform complete decomposition
+    void decompose() {
+        extractTrend();
+        extractSeasonal();
+        extractResidual();
+    }
+    
+    // Getters
+    const std::vector<double>& getTrend() const { return trend; }
+    const std::vector<double>& getSeasonal() const { return seasonal; }
+    const std::vector<double>& getResidual() const { return residual; }
+    
+    // Calculate seasonality strength
+    double getSeasonalityStrength() const {
+        double var_seasonal = 0.0, var_residual = 0.0;
+        
+        for (size_t i = 0; i < seasonal.size(); i++) {
+            var_seasonal += seasonal[i] * seasonal[i];
+            var_residual += residual[i] * residual[i];
+        }
+        
+        var_seasonal /= seasonal.size();
+        var_residual /= residual.size();
+        
+        return var_seasonal / (var_seasonal + var_residual);
+    }
+};
+
+#endif
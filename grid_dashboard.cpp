@@ -0,0 +1,116 @@
+/**
+ * Grid Dashboard
+ * Terminal reader of the shared-memory grid snapshot (grid_state_shm.h)
+ * Reads at memory speed with no requests to the server
+ *
+ * Usage: ./grid_dashboard [--shm name]                 print the current snapshot
+ *        ./grid_dashboard --watch [ms] [--shm name]    reprint whenever it changes
+ *        ./grid_dashboard --bench [reads] [--shm name] measure read latency
+ */
+
+#include <iostream>
+#include <iomanip>
+#include <string>
+#include <chrono>
+#include <thread>
+#include <cstdlib>
+#include <csignal>
+
+#include "grid_state_shm.h"
+
+using namespace std;
+
+volatile sig_atomic_t stop_requested = 0;
+
+void handleSignal(int) {
+    stop_requested = 1;
+}
+
+void printSnapshot(const GridSnapshot& s) {
+    const GridState& g = s.state;
+    cout << "Version " << s.version << " at " << isoTimestamp(g.updated_ms) << endl;
+    cout << fixed << setprecision(1)
+         << "  Solar " << g.solar_capacity * 100 << "%  Wind " << g.wind_capacity * 100
+         << "%  Load " << g.grid_load * 100 << "%  Battery " << g.battery_level * 100
+         << "%  Backup " << (g.backup_active ? "ACTIVE" : "standby") << endl;
+    if (!s.has_forecast) return;
+
+    cout << "  Next 6h (P10 / P50 / P90):" << endl;
+    cout << "  Hour   Solar                  Wind" << endl;
+    cout << setprecision(2);
+    for (int h = 0; h < 6; h++) {
+        cout << "  " << setw(2) << (s.forecast_start_hour + h) % 24 << ":00  "
+             << s.solar[0][h] << " / " << s.solar[1][h] << " / " << s.solar[2][h] << "     "
+             << s.wind[0][h] << " / " << s.wind[1][h] << " / " << s.wind[2][h] << endl;
+    }
+}
+
+int runBenchmark(const GridStateShm& shm, long reads) {
+    GridSnapshot s;
+    long failed = 0;
+    double checksum = 0;
+    auto start = chrono::steady_clock::now();
+    for (long i = 0; i < reads; i++) {
+        if (shm.tryRead(s)) checksum += s.state.grid_load;
+        else failed++;
+    }
+    double ns = chrono::duration<double, nano>(chrono::steady_clock::now() - start).count();
+
+    cout << reads << " snapshot reads (" << sizeof(GridSnapshot) << " bytes each)" << endl;
+    cout << fixed << setprecision(1) << ns / reads << " ns/read, " << failed
+         << " overlapped a publish and would retry (checksum " << setprecision(3) << checksum << ")" << endl;
+    return 0;
+}
+
+int main(int argc, char** argv) {
+    string shm_name = GRID_SHM_NAME;
+    bool watch = false, bench = false;
+    int watch_ms = 100;
+    long bench_reads = 10000000;
+
+    for (int i = 1; i < argc; i++) {
+        string arg = argv[i];
+        if (arg == "--shm" && i + 1 < argc) shm_name = argv[++i];
+        else if (arg == "--watch") {
+            watch = true;
+            if (i + 1 < argc && argv[i + 1][0] != '-') watch_ms = max(1, atoi(argv[++i]));
+        } else if (arg == "--bench") {
+            bench = true;
+            if (i + 1 < argc && argv[i + 1][0] != '-') bench_reads = max(1L, atol(argv[++i]));
+        } else {
+            cerr << "Usage: " << argv[0] << " [--shm name] [--watch [ms] | --bench [reads]]" << endl;
+            return 1;
+        }
+    }
+
+    GridStateShm shm;
+    if (!shm.attach(shm_name)) {
+        cerr << "Error: No grid state in shared memory " << shm_name
+             << " (is grid_stream_server running?)" << endl;
+        return 1;
+    }
+    if (bench) return runBenchmark(shm, bench_reads);
+
+    GridSnapshot s;
+    if (!watch) {
+        if (!shm.read(s)) {
+            cerr << "Error: Nothing published yet" << endl;
+            return 1;
+        }
+        printSnapshot(s);
+        return 0;
+    }
+
+    signal(SIGINT, handleSignal);
+    signal(SIGTERM, handleSignal);
+    uint64_t seen = 0;
+    while (!stop_requested) {
+        if (shm.version() != seen && shm.read(s)) {
+            seen = s.version;
+            printSnapshot(s);
+            cout << endl;
+        }
+        this_thread::sleep_for(chrono::milliseconds(watch_ms));
+    }
+    return 0;
+}
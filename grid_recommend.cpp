@@ -0,0 +1,193 @@
+/**
+ * Grid Recommendation Driver
+ * Evaluates the grid control rules over millions of scenarios at once
+ * Checks the batched kernel (grid_recommend.h) against the per-scenario rule
+ * and compares their throughput
+ *
+ * Usage: ./grid_recommend [scenarios] [--threads n]
+ */
+
+#include <iostream>
+#include <iomanip>
+#include <chrono>
+#include <vector>
+#include <random>
+#include <limits>
+#include <cmath>
+#include <cstdlib>
+#include <string>
+
+#include "energy_data.h"
+#include "grid_recommend.h"
+#include "thread_pool.h"
+
+using namespace std;
+
+double elapsedMs(chrono::steady_clock::time_point start) {
+    return chrono::duration<double, milli>(chrono::steady_clock::now() - start).count();
+}
+
+// Scenario columns: a year of synthetic solar/wind history replayed with
+// per-scenario jitter, a diurnal demand curve and random battery levels
+struct ScenarioColumns {
+    vector<double> solar, wind, demand, battery;
+
+    RecommendationInputs inputs() const {
+        RecommendationInputs in = { &solar[0], &wind[0], &demand[0], &battery[0], solar.size() };
+        return in;
+    }
+};
+
+ScenarioColumns generateScenarios(size_t n, unsigned seed = 7) {
+    EnergyHistory history = generateSyntheticHistory(365);
+    mt19937 rng(seed);
+    normal_distribution<double> noise(0.0, 0.05);
+    uniform_real_distribution<double> uniform(0.0, 1.0);
+
+    ScenarioColumns s;
+    s.solar.resize(n);
+    s.wind.resize(n);
+    s.demand.resize(n);
+    s.battery.resize(n);
+    for (size_t i = 0; i < n; i++) {
+        size_t h = i % history.size();
+        int hour = history.hour_of_day[h];
+        s.solar[i] = max(0.0, history.solar_capacity[h] + noise(rng));
+        s.wind[i] = max(0.0, history.wind_capacity[h] + noise(rng));
+        s.demand[i] = 2.0 * (0.5 + 0.3 * sin((hour - 12) * TWO_PI / 24.0)) * (1.0 + noise(rng));
+        s.battery[i] = uniform(rng);
+    }
+    return s;
+}
+
+// Threshold boundaries, NaN and zero demand, in the same columns
+void appendEdgeCases(ScenarioColumns& s) {
+    const double nan = numeric_limits<double>::quiet_NaN();
+    const double cases[][4] = {
+        { 0.5, 0.35, 1.0, 0.5 },                // renewable exactly 0.85 demand
+        { 0.6, 0.55, 1.0, 0.5 },                // renewable exactly 1.15 demand
+        { 0.1, 0.1, 1.0, 0.3 },                 // battery exactly at reserve
+        { 0.9, 0.9, 1.0, 0.9 },                 // battery exactly full
+        { 0.0, 0.0, 0.0, 0.5 },                 // no demand, no generation
+        { 0.2, 0.2, 0.0, 0.95 },                // no demand
+        { nan, 0.2, 1.0, 0.5 },
+        { 0.2, 0.2, nan, 0.5 },
+        { 0.1, 0.1, 1.0, nan },
+        { 0.9, 0.9, 1.0, nan },
+    };
+    for (size_t c = 0; c < sizeof(cases) / sizeof(cases[0]); c++) {
+        s.solar.push_back(cases[c][0]);
+        s.wind.push_back(cases[c][1]);
+        s.demand.push_back(cases[c][2]);
+        s.battery.push_back(cases[c][3]);
+    }
+}
+
+bool sameValue(double a, double b) {
+    return a == b || (std::isnan(a) && std::isnan(b));
+}
+
+int main(int argc, char** argv) {
+    size_t n = 4000000;
+    int n_threads = 0;
+    for (int i = 1; i < argc; i++) {
+        string arg = argv[i];
+        if (arg == "--threads" && i + 1 < argc) n_threads = atoi(argv[++i]);
+        else if (arg[0] != '-') n = max(1L, atol(argv[i]));
+        else {
+            cerr << "Usage: " << argv[0] << " [scenarios] [--threads n]" << endl;
+            return 1;
+        }
+    }
+
+    cout << "========================================" << endl;
+    cout << "BATCHED GRID RECOMMENDATIONS" << endl;
+#ifdef GRID_RECOMMEND_AVX2
+    cout << "Kernel: AVX2, 4 scenarios per step" << endl;
+#else
+    cout << "Kernel: scalar" << endl;
+#endif
+    cout << "========================================" << endl;
+
+    ScenarioColumns scenarios = generateScenarios(n);
+    appendEdgeCases(scenarios);
+    RecommendationInputs in = scenarios.inputs();
+    cout << "\n[1] Generated " << in.n << " scenarios (" << fixed << setprecision(1)
+         << in.n * 4 * sizeof(double) / 1048576.0 << " MB of input columns)" << endl;
+
+    // Reference: one rule evaluation per scenario, as /api/grid/recommend does
+    vector<uint8_t> expected(in.n);
+    vector<double> expected_deficit(in.n), expected_surplus(in.n);
+    auto start = chrono::steady_clock::now();
+    for (size_t i = 0; i < in.n; i++) {
+        double renewable = in.solar[i] + in.wind[i];
+        expected[i] = (uint8_t)recommendAction(in.solar[i], in.wind[i], in.demand[i], in.battery[i]);
+        expected_deficit[i] = max(0.0, in.demand[i] - renewable);
+        expected_surplus[i] = max(0.0, renewable - in.demand[i]);
+    }
+    double scalar_ms = elapsedMs(start);
+
+    vector<uint8_t> action(in.n);
+    vector<double> deficit(in.n), surplus(in.n);
+    start = chrono::steady_clock::now();
+    recommendBatch(in, &action[0], &deficit[0], &surplus[0]);
+    double batch_ms = elapsedMs(start);
+
+    ThreadPool pool(n_threads > 0 ? n_threads : 0);
+    vector<uint8_t> parallel_action(in.n);
+    vector<double> parallel_deficit(in.n), parallel_surplus(in.n);
+    start = chrono::steady_clock::now();
+    recommendBatch(pool, in, &parallel_action[0], &parallel_deficit[0], &parallel_surplus[0]);
+    double parallel_ms = elapsedMs(start);
+
+    cout << "\n[2] Agreement with the per-scenario rule" << endl;
+    cout << "-----------------------------------" << endl;
+    size_t mismatched = 0;
+    for (size_t i = 0; i < in.n; i++) {
+        if (action[i] != expected[i] || parallel_action[i] != expected[i] ||
+            !sameValue(deficit[i], expected_deficit[i]) || !sameValue(surplus[i], expected_surplus[i]) ||
+            !sameValue(parallel_deficit[i], expected_deficit[i]) ||
+            !sameValue(parallel_surplus[i], expected_surplus[i])) {
+            if (mismatched < 5) {
+                cout << "  Row " << i << ": expected " << actionName(expected[i]) << ", got "
+                     << actionName(action[i]) << endl;
+            }
+            mismatched++;
+        }
+    }
+    cout << "  " << mismatched << " mismatched rows (including " << in.n - n
+         << " threshold, zero and NaN edge cases)" << endl;
+
+    cout << "\n[3] Throughput" << endl;
+    cout << "-----------------------------------" << endl;
+    cout << setprecision(2);
+    cout << "  Per-scenario rule:  " << setw(8) << scalar_ms << " ms  (" << setprecision(0)
+         << in.n / scalar_ms / 1000.0 << " M scenarios/s)" << endl;
+    cout << setprecision(2) << "  Batched kernel:     " << setw(8) << batch_ms << " ms  (" << setprecision(0)
+         << in.n / batch_ms / 1000.0 << " M scenarios/s)" << endl;
+    cout << setprecision(2) << "  Batched, " << pool.size() << " threads: " << setw(8) << parallel_ms
+         << " ms  (" << setprecision(0) << in.n / parallel_ms / 1000.0 << " M scenarios/s)" << endl;
+
+    cout << "\n[4] Action distribution" << endl;
+    cout << "-----------------------------------" << endl;
+    size_t counts[GRID_ACTION_COUNT];
+    countActions(&action[0], in.n, counts);
+    double total_deficit = 0.0, total_surplus = 0.0;
+    for (size_t i = 0; i < n; i++) {
+        total_deficit += deficit[i];
+        total_surplus += surplus[i];
+    }
+    for (int a = 0; a < GRID_ACTION_COUNT; a++) {
+        cout << "  " << left << setw(20) << actionName(a) << right << setw(10) << counts[a]
+             << "  (" << setprecision(1) << setw(5) << 100.0 * counts[a] / in.n << "%, priority "
+             << actionPriority(a) << ")" << endl;
+    }
+    cout << setprecision(3) << "  Mean deficit " << total_deficit / n << ", mean surplus "
+         << total_surplus / n << endl;
+
+    cout << "\n========================================" << endl;
+    cout << "ANALYSIS COMPLETE" << endl;
+    cout << "========================================" << endl;
+
+    return mismatched == 0 ? 0 : 1;
+}
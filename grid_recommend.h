@@ -0,0 +1,171 @@
+/**
+ * Grid Recommendations
+ * Batched, branch-free evaluation of the grid control rules
+ * Native counterpart of /api/grid/recommend (server.js) and recommend_action()
+ * (beta_regression.py), over columnar scenario inputs
+ *
+ * For each row, with renewable = solar + wind:
+ *   renewable < 0.85 demand:  battery > 0.3 ? DISCHARGE_BATTERY : ACTIVATE_BACKUP
+ *   renewable > 1.15 demand:  battery < 0.9 ? CHARGE_BATTERY   : CURTAIL_GENERATION
+ *   otherwise                 NOMINAL_OPERATION
+ * plus deficit = max(0, demand - renewable) and surplus = max(0, renewable - demand).
+ * Comparisons with NaN are false, as in JavaScript and Python.
+ *
+ * With AVX2 enabled the kernel classifies four rows at a time with compare
+ * masks and blends; otherwise it falls back to the scalar rule per row.
+ */
+
+#ifndef GRID_RECOMMEND_H
+#define GRID_RECOMMEND_H
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <algorithm>
+
+#include "thread_pool.h"
+
+#if defined(__AVX2__)
+#include <immintrin.h>
+#define GRID_RECOMMEND_AVX2 1
+#endif
+
+const double DEFICIT_THRESHOLD = 0.85;          // renewable below this fraction of demand
+const double SURPLUS_THRESHOLD = 1.15;          // renewable above this fraction of demand
+const double BATTERY_RESERVE = 0.3;             // discharge only above this level
+const double BATTERY_FULL = 0.9;                // charge only below this level
+
+enum GridAction {
+    ACTION_NOMINAL_OPERATION = 0,
+    ACTION_DISCHARGE_BATTERY = 1,
+    ACTION_ACTIVATE_BACKUP = 2,
+    ACTION_CHARGE_BATTERY = 3,
+    ACTION_CURTAIL_GENERATION = 4
+};
+
+const int GRID_ACTION_COUNT = 5;
+
+inline const char* actionName(int action) {
+    static const char* names[GRID_ACTION_COUNT] = {
+        "NOMINAL_OPERATION", "DISCHARGE_BATTERY", "ACTIVATE_BACKUP", "CHARGE_BATTERY", "CURTAIL_GENERATION"
+    };
+    return action >= 0 && action < GRID_ACTION_COUNT ? names[action] : "UNKNOWN";
+}
+
+inline const char* actionPriority(int action) {
+    static const char* priorities[GRID_ACTION_COUNT] = { "normal", "medium", "high", "low", "low" };
+    return action >= 0 && action < GRID_ACTION_COUNT ? priorities[action] : "normal";
+}
+
+// Scenario columns; all of length n
+struct RecommendationInputs {
+    const double* solar;
+    const double* wind;
+    const double* demand;
+    const double* battery;
+    size_t n;
+};
+
+// Reference rule for one scenario (same branches as server.js)
+inline GridAction recommendAction(double solar, double wind, double demand, double battery) {
+    double renewable = solar + wind;
+    if (renewable < demand * DEFICIT_THRESHOLD) {
+        return battery > BATTERY_RESERVE ? ACTION_DISCHARGE_BATTERY : ACTION_ACTIVATE_BACKUP;
+    }
+    if (renewable > demand * SURPLUS_THRESHOLD) {
+        return battery < BATTERY_FULL ? ACTION_CHARGE_BATTERY : ACTION_CURTAIL_GENERATION;
+    }
+    return ACTION_NOMINAL_OPERATION;
+}
+
+// Rows [begin, end): action codes into action[], metrics into deficit[] and
+// surplus[] (either may be null)
+inline void recommendRange(const RecommendationInputs& in, size_t begin, size_t end,
+                           uint8_t* action, double* deficit, double* surplus) {
+    size_t i = begin;
+#ifdef GRID_RECOMMEND_AVX2
+    const __m256d low_ratio = _mm256_set1_pd(DEFICIT_THRESHOLD);
+    const __m256d high_ratio = _mm256_set1_pd(SURPLUS_THRESHOLD);
+    const __m256d reserve = _mm256_set1_pd(BATTERY_RESERVE);
+    const __m256d full = _mm256_set1_pd(BATTERY_FULL);
+    const __m256d zero = _mm256_setzero_pd();
+    const __m256d nominal = _mm256_set1_pd(ACTION_NOMINAL_OPERATION);
+    const __m256d discharge = _mm256_set1_pd(ACTION_DISCHARGE_BATTERY);
+    const __m256d backup = _mm256_set1_pd(ACTION_ACTIVATE_BACKUP);
+    const __m256d charge = _mm256_set1_pd(ACTION_CHARGE_BATTERY);
+    const __m256d curtail = _mm256_set1_pd(ACTION_CURTAIL_GENERATION);
+    const __m128i low_bytes = _mm_setr_epi8(0, 4, 8, 12, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1);
+
+    for (; i + 4 <= end; i += 4) {
+        __m256d demand = _mm256_loadu_pd(in.demand + i);
+        __m256d battery = _mm256_loadu_pd(in.battery + i);
+        __m256d renewable = _mm256_add_pd(_mm256_loadu_pd(in.solar + i), _mm256_loadu_pd(in.wind + i));
+
+        __m256d short_mask = _mm256_cmp_pd(renewable, _mm256_mul_pd(demand, low_ratio), _CMP_LT_OQ);
+        __m256d excess_mask = _mm256_cmp_pd(renewable, _mm256_mul_pd(demand, high_ratio), _CMP_GT_OQ);
+        __m256d on_short = _mm256_blendv_pd(backup, discharge, _mm256_cmp_pd(battery, reserve, _CMP_GT_OQ));
+        __m256d on_excess = _mm256_blendv_pd(curtail, charge, _mm256_cmp_pd(battery, full, _CMP_LT_OQ));
+        __m256d code = _mm256_blendv_pd(_mm256_blendv_pd(nominal, on_excess, excess_mask), on_short, short_mask);
+
+        int packed = _mm_cvtsi128_si32(_mm_shuffle_epi8(_mm256_cvttpd_epi32(code), low_bytes));
+        std::memcpy(action + i, &packed, 4);
+
+        __m256d gap = _mm256_sub_pd(demand, renewable);
+        if (deficit) _mm256_storeu_pd(deficit + i, _mm256_max_pd(gap, zero));
+        if (surplus) _mm256_storeu_pd(surplus + i, _mm256_max_pd(_mm256_sub_pd(zero, gap), zero));
+    }
+#endif
+    for (; i < end; i++) {
+        double renewable = in.solar[i] + in.wind[i];
+        action[i] = (uint8_t)recommendAction(in.solar[i], in.wind[i], in.demand[i], in.battery[i]);
+        if (deficit) deficit[i] = std::max(0.0, in.demand[i] - renewable);
+        if (surplus) surplus[i] = std::max(0.0, renewable - in.demand[i]);
+    }
+}
+
+inline void recommendBatch(const RecommendationInputs& in, uint8_t* action, double* deficit, double* surplus) {
+    recommendRange(in, 0, in.n, action, deficit, surplus);
+}
+
+// Same, split across a pool in cache-sized chunks
+inline void recommendBatch(ThreadPool& pool, const RecommendationInputs& in,
+                           uint8_t* action, double* deficit, double* surplus) {
+    const size_t chunk = 16384;
+    if (in.n <= chunk || pool.size() <= 1) {
+        recommendBatch(in, action, deficit, surplus);
+        return;
+    }
+    pool.parallelFor(in.n, chunk, [&](size_t begin, size_t end, size_t) {
+        recommendRange(in, begin, end, action, deficit, surplus);
+    });
+}
+
+// Packed result, as returned by the Node addon and the binary bulk endpoint:
+// n action bytes, zero padding to a multiple of 8, then n deficit and n
+// surplus doubles (native byte order)
+inline size_t actionColumnBytes(size_t n) {
+    return (n + 7) & ~(size_t)7;
+}
+
+inline size_t packedRecommendationBytes(size_t n) {
+    return actionColumnBytes(n) + 2 * n * sizeof(double);
+}
+
+// out must hold packedRecommendationBytes(in.n) bytes, 8-byte aligned
+inline void recommendPacked(ThreadPool* pool, const RecommendationInputs& in, void* out) {
+    uint8_t* action = static_cast<uint8_t*>(out);
+    double* deficit = reinterpret_cast<double*>(action + actionColumnBytes(in.n));
+    std::memset(action + in.n, 0, actionColumnBytes(in.n) - in.n);
+    if (pool) recommendBatch(*pool, in, action, deficit, deficit + in.n);
+    else recommendBatch(in, action, deficit, deficit + in.n);
+}
+
+// Rows per action code
+inline void countActions(const uint8_t* action, size_t n, size_t counts[GRID_ACTION_COUNT]) {
+    for (int a = 0; a < GRID_ACTION_COUNT; a++) counts[a] = 0;
+    for (size_t i = 0; i < n; i++) {
+        if (action[i] < GRID_ACTION_COUNT) counts[action[i]]++;
+    }
+}
+
+#endif
@@ -0,0 +1,113 @@
+/**
+ * Grid State
+ * Real-time grid snapshot and its simulator
+ * Native counterpart of currentGridState / generateRealtimeData() in server.js
+ */
+
+#ifndef GRID_STATE_H
+#define GRID_STATE_H
+
+#include <string>
+#include <random>
+#include <chrono>
+#include <cstdio>
+#include <ctime>
+#include <cmath>
+#include <algorithm>
+
+struct GridState {
+    double solar_capacity;
+    double wind_capacity;
+    double battery_level;
+    double grid_load;
+    bool backup_active;
+    long long updated_ms;                      // unix milliseconds
+};
+
+inline long long unixMillis() {
+    return std::chrono::duration_cast<std::chrono::milliseconds>(
+        std::chrono::system_clock::now().time_since_epoch()).count();
+}
+
+// Same starting point as server.js
+inline GridState initialGridState() {
+    GridState s = { 0.67, 0.54, 0.82, 0.71, false, unixMillis() };
+    return s;
+}
+
+class GridSimulator {
+private:
+    GridState current;
+    std::mt19937 rng;
+    std::uniform_real_distribution<double> uniform;
+
+    static double clamp(double v, double lo, double hi) { return std::max(lo, std::min(hi, v)); }
+
+public:
+    explicit GridSimulator(unsigned seed = 42)
+        : current(initialGridState()), rng(seed), uniform(0.0, 1.0) {}
+
+    const GridState& state() const { return current; }
+
+    // One generateRealtimeData() step for the given local hour
+    const GridState& step(int hour, long long now_ms) {
+        const double pi = 3.14159265358979323846;
+
+        // Solar: high during day (6am-6pm)
+        double solar_base = std::max(0.0, std::sin((hour - 6) * pi / 12) * 0.8);
+        current.solar_capacity = clamp(solar_base + (uniform(rng) - 0.5) * 0.1, 0.0, 1.0);
+
+        // Wind: moderate variability
+        double wind_base = 0.4 + std::sin(hour * pi / 6) * 0.3;
+        current.wind_capacity = clamp(wind_base + (uniform(rng) - 0.5) * 0.15, 0.0, 1.0);
+
+        // Grid load: follows demand curve
+        double load_base = 0.5 + std::sin((hour - 12) * pi / 12) * 0.3;
+        current.grid_load = clamp(load_base + (uniform(rng) - 0.5) * 0.05, 0.2, 1.0);
+
+        // Battery management
+        double total_gen = current.solar_capacity + current.wind_capacity;
+        current.battery_level = clamp(current.battery_level + (total_gen - current.grid_load) * 0.02, 0.0, 1.0);
+
+        // Auto backup activation
+        if (total_gen < current.grid_load * 0.85 && current.battery_level < 0.3) {
+            current.backup_active = true;
+        } else if (total_gen > current.grid_load * 1.1) {
+            current.backup_active = false;
+        }
+
+        current.updated_ms = now_ms;
+        return current;
+    }
+
+    const GridState& step() {
+        std::time_t now = std::time(0);
+        std::tm local;
+        localtime_r(&now, &local);
+        return step(local.tm_hour, unixMillis());
+    }
+};
+
+// ISO-8601 UTC with milliseconds, as Date.toISOString()
+inline std::string isoTimestamp(long long unix_ms) {
+    std::time_t seconds = (std::time_t)(unix_ms / 1000);
+    std::tm utc;
+    gmtime_r(&seconds, &utc);
+    char buf[40];
+    size_t len = std::strftime(buf, sizeof(buf), "%Y-%m-%dT%H:%M:%S", &utc);
+    std::snprintf(buf + len, sizeof(buf) - len, ".%03dZ", (int)(unix_ms % 1000));
+    return buf;
+}
+
+// Same shape as currentGridState in server.js
+inline std::string gridStateToJson(const GridState& s) {
+    char buf[256];
+    std::snprintf(buf, sizeof(buf),
+                  "{\"solarCapacity\":%.6g,\"windCapacity\":%.6g,\"batteryLevel\":%.6g,"
+                  "\"gridLoad\":%.6g,\"backupActive\":%s,\"lastUpdated\":\"%s\"}",
+                  s.solar_capacity, s.wind_capacity, s.battery_level, s.grid_load,
+                  s.backup_active ? "true" : "false", isoTimestamp(s.updated_ms).c_str());
+    return buf;
+}
+
+#endif
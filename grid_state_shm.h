@@ -0,0 +1,172 @@
+/**
+ * Grid State Shared Memory
+ * Seqlock-published grid snapshot in a POSIX shared-memory region
+ *
+ * One writer (grid_stream_server) publishes the current GridState and 24h
+ * P10/P50/P90 forecasts; any number of local readers (grid_dashboard, the
+ * Node addon, the Python extension) copy it out without locks or syscalls.
+ * Readers never block the writer; a read that overlaps a publish is retried.
+ * The snapshot is stored as 64-bit words accessed with relaxed atomics, so
+ * the protocol is race-free under the C++ memory model. The region outlives
+ * the writer: a restarted writer takes it over and attached readers keep
+ * working (state.updated_ms tells them how fresh it is).
+ */
+
+#ifndef GRID_STATE_SHM_H
+#define GRID_STATE_SHM_H
+
+#include <atomic>
+#include <string>
+#include <cstring>
+#include <cstdint>
+#include <cstddef>
+#include <type_traits>
+
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+
+#include "grid_state.h"
+
+#define GRID_SHM_NAME "/energy_grid_state"
+const uint32_t GRID_SHM_MAGIC = 0x44495247;     // "GRID"
+const uint32_t GRID_SHM_VERSION = 1;
+const int GRID_FORECAST_HOURS = 24;
+const int GRID_FORECAST_LEVELS = 3;             // p10, p50, p90
+
+// What readers get back: plain data, safe to copy anywhere
+struct GridSnapshot {
+    uint64_t version;                           // publish count, 1 for the first
+    GridState state;
+    int has_forecast;
+    int forecast_start_hour;
+    long long forecast_issued_at;               // unix seconds
+    double solar[GRID_FORECAST_LEVELS][GRID_FORECAST_HOURS];
+    double wind[GRID_FORECAST_LEVELS][GRID_FORECAST_HOURS];
+};
+
+const size_t GRID_SNAPSHOT_WORDS = (sizeof(GridSnapshot) + 7) / 8;
+
+struct GridStateRegion {
+    uint32_t magic;
+    uint32_t layout_version;
+    uint32_t region_size;
+    uint32_t snapshot_size;
+    alignas(64) std::atomic<uint64_t> sequence;  // odd while a publish is in progress
+    alignas(64) std::atomic<uint64_t> words[GRID_SNAPSHOT_WORDS];
+};
+
+static_assert(std::is_trivially_copyable<GridSnapshot>::value, "GridSnapshot is copied as raw words");
+
+// Owns one mapping of the region; the writer creates it, readers attach
+class GridStateShm {
+private:
+    GridStateRegion* region;
+
+public:
+    GridStateShm() : region(0) {}
+    ~GridStateShm() { close(); }
+
+    bool isOpen() const { return region != 0; }
+
+    // Create (or take over) the region for publishing
+    bool create(const std::string& shm_name = GRID_SHM_NAME) {
+        close();
+        int fd = shm_open(shm_name.c_str(), O_CREAT | O_RDWR, 0644);
+        if (fd < 0) return false;
+        if (ftruncate(fd, sizeof(GridStateRegion)) != 0) {
+            ::close(fd);
+            return false;
+        }
+        void* mem = mmap(0, sizeof(GridStateRegion), PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+        ::close(fd);
+        if (mem == MAP_FAILED) return false;
+
+        region = static_cast<GridStateRegion*>(mem);
+        // Taking over a compatible region keeps versions increasing for readers
+        bool compatible = region->magic == GRID_SHM_MAGIC && region->layout_version == GRID_SHM_VERSION &&
+                          region->snapshot_size == sizeof(GridSnapshot);
+        uint64_t seq = compatible ? region->sequence.load(std::memory_order_relaxed) : 0;
+        region->sequence.store((seq + 1) & ~(uint64_t)1, std::memory_order_relaxed);
+        region->layout_version = GRID_SHM_VERSION;
+        region->region_size = sizeof(GridStateRegion);
+        region->snapshot_size = sizeof(GridSnapshot);
+        std::atomic_thread_fence(std::memory_order_release);
+        region->magic = GRID_SHM_MAGIC;
+        return true;
+    }
+
+    // Attach read-only; fails if no compatible writer has created the region
+    bool attach(const std::string& shm_name = GRID_SHM_NAME) {
+        close();
+        int fd = shm_open(shm_name.c_str(), O_RDONLY, 0);
+        if (fd < 0) return false;
+        struct stat st;
+        if (fstat(fd, &st) != 0 || (size_t)st.st_size < sizeof(GridStateRegion)) {
+            ::close(fd);
+            return false;
+        }
+        void* mem = mmap(0, sizeof(GridStateRegion), PROT_READ, MAP_SHARED, fd, 0);
+        ::close(fd);
+        if (mem == MAP_FAILED) return false;
+
+        region = static_cast<GridStateRegion*>(mem);
+        if (region->magic != GRID_SHM_MAGIC || region->layout_version != GRID_SHM_VERSION ||
+            region->region_size != sizeof(GridStateRegion) || region->snapshot_size != sizeof(GridSnapshot)) {
+            close();
+            return false;
+        }
+        return true;
+    }
+
+    void close() {
+        if (region) munmap(region, sizeof(GridStateRegion));
+        region = 0;
+    }
+
+    // Single writer only. snapshot.version is assigned here.
+    void publish(GridSnapshot snapshot) {
+        uint64_t seq = region->sequence.load(std::memory_order_relaxed);
+        snapshot.version = seq / 2 + 1;
+        uint64_t words[GRID_SNAPSHOT_WORDS] = {0};
+        std::memcpy(words, &snapshot, sizeof(snapshot));
+
+        region->sequence.store(seq + 1, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_release);
+        for (size_t i = 0; i < GRID_SNAPSHOT_WORDS; i++) {
+            region->words[i].store(words[i], std::memory_order_relaxed);
+        }
+        region->sequence.store(seq + 2, std::memory_order_release);
+    }
+
+    // One attempt; false if nothing is published yet or a publish overlapped
+    bool tryRead(GridSnapshot& out) const {
+        uint64_t before = region->sequence.load(std::memory_order_acquire);
+        if (before == 0 || (before & 1)) return false;
+        uint64_t words[GRID_SNAPSHOT_WORDS];
+        for (size_t i = 0; i < GRID_SNAPSHOT_WORDS; i++) {
+            words[i] = region->words[i].load(std::memory_order_relaxed);
+        }
+        std::atomic_thread_fence(std::memory_order_acquire);
+        if (region->sequence.load(std::memory_order_relaxed) != before) return false;
+        std::memcpy(&out, words, sizeof(out));
+        return true;
+    }
+
+    // Latest consistent snapshot; false only if nothing was ever published
+    bool read(GridSnapshot& out, int max_attempts = 1000) const {
+        for (int attempt = 0; attempt < max_attempts; attempt++) {
+            if (tryRead(out)) return true;
+            if (region->sequence.load(std::memory_order_relaxed) == 0) return false;
+        }
+        return false;
+    }
+
+    // Publish count, to poll for changes without copying
+    uint64_t version() const {
+        return region->sequence.load(std::memory_order_acquire) / 2;
+    }
+};
+
+#endif
@@ -0,0 +1,709 @@
+/**
+ * Grid Stream Server
+ * Edge-triggered epoll HTTP/SSE front end for real-time grid state
+ *
+ * Replaces the per-client setInterval of /api/stream/state in server.js: the
+ * grid is advanced once per tick, the snapshot is serialized once, and the
+ * same immutable frame is fanned out to every subscriber. A subscriber that
+ * cannot keep up never holds more than the frame it is partway through plus
+ * the newest one (older snapshots are superseded), and one that accepts no
+ * bytes for MAX_STALLED_TICKS ticks is disconnected.
+ *
+ * Every tick is also published, with the current 24h forecast, to the
+ * shared-memory snapshot of grid_state_shm.h for local readers.
+ *
+ * Between hourly forecasts, solar and wind samples feed Kalman nowcasters
+ * (kalman_nowcast.h); each state frame carries their filtered estimates and
+ * 90% bands as "nowcast".
+ *
+ * Usage: ./grid_stream_server [--port 3001] [--interval ms] [--shm name] [--models file]
+ *        ./grid_stream_server --bench [clients] [--port 3001] [--seconds s]
+ *
+ * Routes:
+ *   GET /api/stream/state   text/event-stream, one "id: <tick>\ndata: {...}" event per tick
+ *   GET /api/grid/state     latest snapshot, {"success":true,"data":{...}}
+ *   GET /api/stream/stats   subscriber count and fan-out timings
+ *   GET /api/health
+ */
+
+#include <iostream>
+#include <iomanip>
+#include <sstream>
+#include <string>
+#include <vector>
+#include <deque>
+#include <map>
+#include <unordered_map>
+#include <memory>
+#include <chrono>
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+#include <cerrno>
+#include <csignal>
+
+#include <sys/socket.h>
+#include <sys/epoll.h>
+#include <sys/timerfd.h>
+#include <sys/resource.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <arpa/inet.h>
+#include <fcntl.h>
+#include <unistd.h>
+
+#include "grid_state.h"
+#include "grid_state_shm.h"
+#include "forecast_service.h"
+#include "kalman_nowcast.h"
+
+using namespace std;
+
+const int DEFAULT_PORT = 3001;
+const int DEFAULT_INTERVAL_MS = 3000;
+const size_t MAX_HEADER_BYTES = 8192;
+const int MAX_STALLED_TICKS = 20;
+const int SUBSCRIBER_SNDBUF = 64 * 1024;   // bounds kernel memory per slow subscriber
+const size_t FANOUT_WINDOW = 1024;
+const int MAX_EVENTS = 1024;
+const int NOWCAST_HARMONICS = 3;
+const double SOLAR_SAMPLE_VARIANCE = 0.1 * 0.1 / 12.0;     // GridSimulator noise: uniform +/-0.05
+const double WIND_SAMPLE_VARIANCE = 0.15 * 0.15 / 12.0;    // +/-0.075
+
+volatile sig_atomic_t stop_requested = 0;
+
+void handleSignal(int) {
+    stop_requested = 1;
+}
+
+// Allow as many sockets as the hard limit permits
+void raiseFileLimit() {
+    rlimit limit;
+    if (getrlimit(RLIMIT_NOFILE, &limit) == 0 && limit.rlim_cur < limit.rlim_max) {
+        limit.rlim_cur = limit.rlim_max;
+        setrlimit(RLIMIT_NOFILE, &limit);
+    }
+}
+
+double percentile(vector<double> values, double q) {
+    if (values.empty()) return 0.0;
+    sort(values.begin(), values.end());
+    return values[min(values.size() - 1, (size_t)(q * values.size()))];
+}
+
+typedef shared_ptr<const string> Frame;
+
+string httpResponse(const string& status, const string& body) {
+    ostringstream os;
+    os << "HTTP/1.1 " << status << "\r\n"
+       << "Content-Type: application/json\r\n"
+       << "Access-Control-Allow-Origin: *\r\n"
+       << "Content-Length: " << body.size() << "\r\n"
+       << "Connection: close\r\n\r\n" << body;
+    return os.str();
+}
+
+class GridStreamServer {
+private:
+    struct Connection {
+        int fd;
+        bool subscriber;
+        bool writable;              // edge-triggered: false once a write hit EAGAIN
+        bool close_after_flush;
+        string request;
+        deque<Frame> queue;
+        size_t offset;              // bytes of queue.front() already sent
+        size_t sent_this_tick;
+        int stalled_ticks;
+    };
+
+    int port;
+    int interval_ms;
+    int epoll_fd, listen_fd, timer_fd;
+    int reserve_fd;                 // spare descriptor, released to shed connections at EMFILE
+    unordered_map<int, Connection> connections;
+    size_t subscribers;
+
+    GridSimulator simulator;
+    KalmanNowcaster<NOWCAST_HARMONICS> solar_nowcast, wind_nowcast;
+    NowcastFrame solar_frame, wind_frame;
+    GridStateShm* shm;
+    const ForecastEngine* engine;
+    GridSnapshot snapshot;          // last published, forecast refreshed hourly
+    unsigned long long tick;
+    string state_json;
+    Frame current_frame;
+    Frame sse_headers;
+
+    size_t frames_sent, frames_superseded, stalled_drops, bytes_sent;
+    size_t refused;                 // connections accepted and closed while out of descriptors
+    bool fd_exhausted;
+    vector<double> fanout_ms;       // ring buffer of recent tick fan-out times
+    size_t fanout_next;
+
+    void closeConnection(int fd) {
+        unordered_map<int, Connection>::iterator it = connections.find(fd);
+        if (it == connections.end()) return;
+        if (it->second.subscriber) subscribers--;
+        close(fd);                  // also removes it from the epoll set
+        connections.erase(it);
+    }
+
+    // Write queued frames until done or EAGAIN; false on a socket error
+    bool writeQueued(Connection& c) {
+        while (c.writable && !c.queue.empty()) {
+            const string& frame = *c.queue.front();
+            ssize_t n = send(c.fd, frame.data() + c.offset, frame.size() - c.offset, MSG_NOSIGNAL);
+            if (n > 0) {
+                c.offset += n;
+                c.sent_this_tick += n;
+                bytes_sent += n;
+                if (c.offset == frame.size()) {
+                    c.queue.pop_front();
+                    c.offset = 0;
+                    if (c.subscriber) frames_sent++;
+                }
+            } else if (n < 0 && (errno == EAGAIN || errno == EWOULDBLOCK)) {
+                c.writable = false;
+            } else if (!(n < 0 && errno == EINTR)) {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    // writeQueued(), closing the connection on error or once a response is out
+    void flush(Connection& c) {
+        if (!writeQueued(c) || (c.queue.empty() && c.close_after_flush)) closeConnection(c.fd);
+    }
+
+    // Queue the newest frame, superseding any older ones not yet started
+    void enqueue(Connection& c, const Frame& frame) {
+        size_t keep = c.offset > 0 ? 1 : 0;
+        if (c.queue.size() > keep) {
+            frames_superseded += c.queue.size() - keep;
+            c.queue.resize(keep);
+        }
+        c.queue.push_back(frame);
+    }
+
+    // The server.js state object plus {"nowcast":{"solar":{...},"wind":{...}}}
+    string stateWithNowcastJson(const GridState& state) const {
+        string json = gridStateToJson(state);
+        char buf[256];
+        snprintf(buf, sizeof(buf),
+                 ",\"nowcast\":{\"solar\":{\"estimate\":%.4f,\"lower\":%.4f,\"upper\":%.4f},"
+                 "\"wind\":{\"estimate\":%.4f,\"lower\":%.4f,\"upper\":%.4f}}",
+                 solar_frame.estimate[0], solar_frame.lower[0], solar_frame.upper[0], wind_frame.estimate[0],
+                 wind_frame.lower[0], wind_frame.upper[0]);
+        json.insert(json.size() - 1, buf);
+        return json;
+    }
+
+    string statsJson() const {
+        ostringstream os;
+        os << fixed << setprecision(3) << "{\"subscribers\":" << subscribers
+           << ",\"connections\":" << connections.size() << ",\"ticks\":" << tick
+           << ",\"interval_ms\":" << interval_ms << ",\"frames_sent\":" << frames_sent
+           << ",\"frames_superseded\":" << frames_superseded << ",\"stalled_drops\":" << stalled_drops
+           << ",\"refused\":" << refused
+           << ",\"bytes_sent\":" << bytes_sent << ",\"fanout_p50_ms\":" << percentile(fanout_ms, 0.5)
+           << ",\"fanout_p99_ms\":" << percentile(fanout_ms, 0.99) << "}";
+        return os.str();
+    }
+
+    void handleRequest(Connection& c) {
+        size_t line_end = c.request.find("\r\n");
+        istringstream line(c.request.substr(0, line_end));
+        string method, target;
+        line >> method >> target;
+        string path = target.substr(0, target.find('?'));
+        c.request.clear();
+
+        if (method == "GET" && path == "/api/stream/state") {
+            c.subscriber = true;
+            subscribers++;
+            setsockopt(c.fd, SOL_SOCKET, SO_SNDBUF, &SUBSCRIBER_SNDBUF, sizeof(SUBSCRIBER_SNDBUF));
+            c.queue.push_back(sse_headers);
+            c.queue.push_back(current_frame);
+            return;
+        }
+
+        string response;
+        if (method == "OPTIONS") {
+            response = "HTTP/1.1 204 No Content\r\nAccess-Control-Allow-Origin: *\r\n"
+                       "Access-Control-Allow-Methods: GET, OPTIONS\r\nConnection: close\r\n\r\n";
+        } else if (method == "GET" && path == "/api/grid/state") {
+            response = httpResponse("200 OK", "{\"success\":true,\"data\":" + state_json + "}");
+        } else if (method == "GET" && path == "/api/stream/stats") {
+            response = httpResponse("200 OK", "{\"success\":true,\"data\":" + statsJson() + "}");
+        } else if (method == "GET" && path == "/api/health") {
+            response = httpResponse("200 OK", "{\"status\":\"operational\",\"timestamp\":\"" +
+                                    isoTimestamp(unixMillis()) + "\",\"version\":\"4.2.1\"}");
+        } else {
+            response = httpResponse("404 Not Found", "{\"success\":false,\"error\":\"Not found\"}");
+        }
+        c.queue.push_back(make_shared<const string>(response));
+        c.close_after_flush = true;
+    }
+
+    // Drain readable bytes (edge-triggered); false if fd was closed
+    bool readConnection(Connection& c) {
+        char buf[4096];
+        for (;;) {
+            ssize_t n = recv(c.fd, buf, sizeof(buf), 0);
+            if (n > 0) {
+                // Subscribers have nothing more to say; discard anything they send
+                if (!c.subscriber && !c.close_after_flush) c.request.append(buf, n);
+                continue;
+            }
+            if (n < 0 && (errno == EAGAIN || errno == EWOULDBLOCK)) break;
+            if (n < 0 && errno == EINTR) continue;
+            closeConnection(c.fd);
+            return false;
+        }
+
+        if (!c.subscriber && !c.close_after_flush) {
+            if (c.request.find("\r\n\r\n") != string::npos) {
+                handleRequest(c);
+            } else if (c.request.size() > MAX_HEADER_BYTES) {
+                closeConnection(c.fd);
+                return false;
+            }
+        }
+        return true;
+    }
+
+    // Out of descriptors with connections still queued: the listen fd is
+    // edge-triggered, so they would never be reported again. Free the spare
+    // descriptor, accept one and close it at once; false when nothing was
+    // pending or no descriptor could be freed.
+    bool refuseConnection() {
+        if (!fd_exhausted) {
+            cerr << "Warning: out of file descriptors at " << connections.size()
+                 << " connections; refusing new ones" << endl;
+            fd_exhausted = true;
+        }
+        if (reserve_fd < 0) return false;
+        close(reserve_fd);
+        int fd = accept4(listen_fd, 0, 0, SOCK_NONBLOCK);
+        bool shed = fd >= 0;
+        if (shed) {
+            close(fd);
+            refused++;
+        }
+        reserve_fd = open("/dev/null", O_RDONLY | O_CLOEXEC);
+        return shed;
+    }
+
+    void acceptConnections() {
+        for (;;) {
+            int fd = accept4(listen_fd, 0, 0, SOCK_NONBLOCK);
+            if (fd < 0) {
+                if (errno == EINTR || errno == ECONNABORTED) continue;
+                if ((errno == EMFILE || errno == ENFILE) && refuseConnection()) continue;
+                break;
+            }
+            fd_exhausted = false;
+            int one = 1;
+            setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));
+
+            epoll_event ev;
+            ev.events = EPOLLIN | EPOLLOUT | EPOLLRDHUP | EPOLLET;
+            ev.data.fd = fd;
+            if (epoll_ctl(epoll_fd, EPOLL_CTL_ADD, fd, &ev) != 0) {
+                close(fd);
+                continue;
+            }
+            Connection c;
+            c.fd = fd;
+            c.subscriber = false;
+            c.writable = true;
+            c.close_after_flush = false;
+            c.offset = 0;
+            c.sent_this_tick = 0;
+            c.stalled_ticks = 0;
+            connections[fd] = c;
+        }
+    }
+
+    void publishSnapshot(const GridState& state) {
+        snapshot.state = state;
+        std::time_t now = (std::time_t)(state.updated_ms / 1000);
+        std::tm local;
+        localtime_r(&now, &local);
+        if (engine && (!snapshot.has_forecast || snapshot.forecast_start_hour != local.tm_hour)) {
+            Forecast24h f;
+            if (engine->forecast24h(0, local.tm_hour, local.tm_yday + 1, f)) {
+                snapshot.has_forecast = 1;
+                snapshot.forecast_start_hour = f.start_hour;
+                snapshot.forecast_issued_at = f.issued_at;
+                memcpy(snapshot.solar, f.solar, sizeof(snapshot.solar));
+                memcpy(snapshot.wind, f.wind, sizeof(snapshot.wind));
+            }
+        }
+        shm->publish(snapshot);
+    }
+
+    // Advance the grid once, serialize once, fan out to every subscriber
+    void onTick() {
+        uint64_t expirations;
+        while (read(timer_fd, &expirations, sizeof(expirations)) > 0) {}
+
+        auto start = chrono::steady_clock::now();
+        tick++;
+        const GridState& state = simulator.step();
+        solar_nowcast.update(&state.solar_capacity, solar_frame);
+        wind_nowcast.update(&state.wind_capacity, wind_frame);
+        state_json = stateWithNowcastJson(state);
+        if (shm) publishSnapshot(state);
+        current_frame = make_shared<const string>(
+            "id: " + to_string(tick) + "\ndata: " + state_json + "\n\n");
+
+        // Connections are closed after the loop so the iteration stays valid
+        vector<int> stalled, broken;
+        for (unordered_map<int, Connection>::iterator it = connections.begin(); it != connections.end(); ++it) {
+            Connection& c = it->second;
+            if (!c.subscriber) continue;
+            if (!c.queue.empty() && c.sent_this_tick == 0) {
+                if (++c.stalled_ticks > MAX_STALLED_TICKS) {
+                    stalled.push_back(c.fd);
+                    continue;
+                }
+            } else {
+                c.stalled_ticks = 0;
+            }
+            c.sent_this_tick = 0;
+            enqueue(c, current_frame);
+            if (!writeQueued(c)) broken.push_back(c.fd);
+        }
+        stalled_drops += stalled.size();
+        for (size_t i = 0; i < stalled.size(); i++) closeConnection(stalled[i]);
+        for (size_t i = 0; i < broken.size(); i++) closeConnection(broken[i]);
+
+        double ms = chrono::duration<double, milli>(chrono::steady_clock::now() - start).count();
+        if (fanout_ms.size() < FANOUT_WINDOW) fanout_ms.push_back(ms);
+        else fanout_ms[fanout_next] = ms;
+        fanout_next = (fanout_next + 1) % FANOUT_WINDOW;
+    }
+
+public:
+    // shm and engine are optional (null); both must outlive the server
+    GridStreamServer(int listen_port, int tick_ms, GridStateShm* state_shm, const ForecastEngine* forecasts)
+        : port(listen_port), interval_ms(tick_ms), epoll_fd(-1), listen_fd(-1), timer_fd(-1), reserve_fd(-1),
+          subscribers(0), solar_nowcast(1, capacityNowcastConfig(tick_ms / 1000.0, SOLAR_SAMPLE_VARIANCE)),
+          wind_nowcast(1, capacityNowcastConfig(tick_ms / 1000.0, WIND_SAMPLE_VARIANCE)),
+          shm(state_shm), engine(forecasts), tick(0), frames_sent(0), frames_superseded(0), stalled_drops(0),
+          bytes_sent(0), refused(0), fd_exhausted(false), fanout_next(0) {
+        memset(&snapshot, 0, sizeof(snapshot));
+        solar_frame.resize(1);
+        wind_frame.resize(1);
+        solar_frame.estimate[0] = solar_frame.lower[0] = solar_frame.upper[0] = simulator.state().solar_capacity;
+        wind_frame.estimate[0] = wind_frame.lower[0] = wind_frame.upper[0] = simulator.state().wind_capacity;
+        state_json = stateWithNowcastJson(simulator.state());
+        if (shm) publishSnapshot(simulator.state());
+        current_frame = make_shared<const string>("id: 0\ndata: " + state_json + "\n\n");
+        sse_headers = make_shared<const string>(
+            "HTTP/1.1 200 OK\r\n"
+            "Content-Type: text/event-stream\r\n"
+            "Cache-Control: no-cache\r\n"
+            "Connection: keep-alive\r\n"
+            "Access-Control-Allow-Origin: *\r\n\r\n");
+    }
+
+    ~GridStreamServer() {
+        for (unordered_map<int, Connection>::iterator it = connections.begin(); it != connections.end(); ++it) {
+            close(it->first);
+        }
+        if (timer_fd >= 0) close(timer_fd);
+        if (reserve_fd >= 0) close(reserve_fd);
+        if (listen_fd >= 0) close(listen_fd);
+        if (epoll_fd >= 0) close(epoll_fd);
+    }
+
+    bool listen() {
+        epoll_fd = epoll_create1(0);
+        listen_fd = socket(AF_INET, SOCK_STREAM | SOCK_NONBLOCK, 0);
+        timer_fd = timerfd_create(CLOCK_MONOTONIC, TFD_NONBLOCK);
+        reserve_fd = open("/dev/null", O_RDONLY | O_CLOEXEC);
+        if (epoll_fd < 0 || listen_fd < 0 || timer_fd < 0 || reserve_fd < 0) {
+            cerr << "Error: Cannot create descriptors: " << strerror(errno) << endl;
+            return false;
+        }
+
+        int one = 1;
+        setsockopt(listen_fd, SOL_SOCKET, SO_REUSEADDR, &one, sizeof(one));
+        sockaddr_in addr;
+        memset(&addr, 0, sizeof(addr));
+        addr.sin_family = AF_INET;
+        addr.sin_addr.s_addr = htonl(INADDR_ANY);
+        addr.sin_port = htons(port);
+        if (bind(listen_fd, (sockaddr*)&addr, sizeof(addr)) != 0 || ::listen(listen_fd, SOMAXCONN) != 0) {
+            cerr << "Error: Cannot listen on port " << port << ": " << strerror(errno) << endl;
+            return false;
+        }
+
+        itimerspec spec;
+        spec.it_interval.tv_sec = interval_ms / 1000;
+        spec.it_interval.tv_nsec = (interval_ms % 1000) * 1000000L;
+        spec.it_value = spec.it_interval;
+        timerfd_settime(timer_fd, 0, &spec, 0);
+
+        epoll_event ev;
+        ev.events = EPOLLIN | EPOLLET;
+        ev.data.fd = listen_fd;
+        epoll_ctl(epoll_fd, EPOLL_CTL_ADD, listen_fd, &ev);
+        ev.data.fd = timer_fd;
+        epoll_ctl(epoll_fd, EPOLL_CTL_ADD, timer_fd, &ev);
+        return true;
+    }
+
+    void run() {
+        epoll_event events[MAX_EVENTS];
+        while (!stop_requested) {
+            int ready = epoll_wait(epoll_fd, events, MAX_EVENTS, 500);
+            if (ready < 0) {
+                if (errno == EINTR) continue;
+                cerr << "Error: epoll_wait failed: " << strerror(errno) << endl;
+                break;
+            }
+            for (int i = 0; i < ready; i++) {
+                int fd = events[i].data.fd;
+                if (fd == listen_fd) {
+                    acceptConnections();
+                    continue;
+                }
+                if (fd == timer_fd) {
+                    onTick();
+                    continue;
+                }
+
+                unordered_map<int, Connection>::iterator it = connections.find(fd);
+                if (it == connections.end()) continue;
+                Connection& c = it->second;
+                if (events[i].events & EPOLLERR) {
+                    closeConnection(fd);
+                    continue;
+                }
+                if ((events[i].events & (EPOLLIN | EPOLLRDHUP | EPOLLHUP)) && !readConnection(c)) continue;
+                if (events[i].events & EPOLLOUT) c.writable = true;
+                flush(c);
+            }
+        }
+    }
+
+    void printSummary() const {
+        cout << "Ticks: " << tick << ", frames sent: " << frames_sent << ", superseded: "
+             << frames_superseded << ", stalled drops: " << stalled_drops << ", refused: " << refused << endl;
+        cout << fixed << setprecision(3) << "Fan-out per tick: p50 = " << percentile(fanout_ms, 0.5)
+             << " ms, p99 = " << percentile(fanout_ms, 0.99) << " ms" << endl;
+    }
+};
+
+// ---------------------------------------------------------------------------
+// Load generator: N SSE subscribers on one epoll loop
+// ---------------------------------------------------------------------------
+
+struct BenchClient {
+    int fd;
+    bool connected;
+    bool headers_done;
+    string buffer;
+};
+
+struct TickDelivery {
+    chrono::steady_clock::time_point first, last;
+    size_t clients;
+};
+
+// Consume complete events from c.buffer, recording when each tick id arrived
+void parseEvents(BenchClient& c, map<unsigned long long, TickDelivery>& deliveries, size_t& events) {
+    if (!c.headers_done) {
+        size_t end = c.buffer.find("\r\n\r\n");
+        if (end == string::npos) return;
+        c.buffer.erase(0, end + 4);
+        c.headers_done = true;
+    }
+    chrono::steady_clock::time_point now = chrono::steady_clock::now();
+    size_t start = 0, end;
+    while ((end = c.buffer.find("\n\n", start)) != string::npos) {
+        if (c.buffer.compare(start, 4, "id: ") == 0) {
+            unsigned long long id = strtoull(c.buffer.c_str() + start + 4, 0, 10);
+            map<unsigned long long, TickDelivery>::iterator it = deliveries.find(id);
+            if (it == deliveries.end()) {
+                TickDelivery d = { now, now, 1 };
+                deliveries[id] = d;
+            } else {
+                it->second.last = now;
+                it->second.clients++;
+            }
+            events++;
+        }
+        start = end + 2;
+    }
+    c.buffer.erase(0, start);
+}
+
+int runBenchmark(int port, int n_clients, double seconds) {
+    int epoll_fd = epoll_create1(0);
+    vector<BenchClient> clients(n_clients);
+    map<unsigned long long, TickDelivery> deliveries;
+    size_t events = 0, connected = 0, failed = 0, in_flight = 0;
+    const size_t MAX_IN_FLIGHT = 256;
+
+    sockaddr_in addr;
+    memset(&addr, 0, sizeof(addr));
+    addr.sin_family = AF_INET;
+    addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    addr.sin_port = htons(port);
+    const string request = "GET /api/stream/state HTTP/1.1\r\nHost: localhost\r\nAccept: text/event-stream\r\n\r\n";
+
+    epoll_event ready[MAX_EVENTS];
+    auto pump = [&](int timeout_ms) {
+        int n = epoll_wait(epoll_fd, ready, MAX_EVENTS, timeout_ms);
+        for (int i = 0; i < n; i++) {
+            BenchClient& c = clients[ready[i].data.u32];
+            if (c.fd < 0) continue;
+            if (!c.connected && (ready[i].events & (EPOLLOUT | EPOLLERR | EPOLLHUP))) {
+                int error = 0;
+                socklen_t len = sizeof(error);
+                getsockopt(c.fd, SOL_SOCKET, SO_ERROR, &error, &len);
+                in_flight--;
+                if (error != 0 || send(c.fd, request.data(), request.size(), MSG_NOSIGNAL) != (ssize_t)request.size()) {
+                    close(c.fd);
+                    c.fd = -1;
+                    failed++;
+                    continue;
+                }
+                c.connected = true;
+                connected++;
+            }
+            char buf[16384];
+            ssize_t got;
+            while ((got = recv(c.fd, buf, sizeof(buf), 0)) > 0) c.buffer.append(buf, got);
+            if (got == 0) {
+                close(c.fd);
+                c.fd = -1;
+                continue;
+            }
+            parseEvents(c, deliveries, events);
+        }
+    };
+
+    auto start = chrono::steady_clock::now();
+    for (int i = 0; i < n_clients; i++) {
+        while (in_flight >= MAX_IN_FLIGHT) pump(100);
+        BenchClient& c = clients[i];
+        c.connected = c.headers_done = false;
+        c.fd = socket(AF_INET, SOCK_STREAM | SOCK_NONBLOCK, 0);
+        if (c.fd < 0) {
+            cerr << "Error: Cannot create client socket " << i << ": " << strerror(errno) << endl;
+            failed++;
+            continue;
+        }
+        if (connect(c.fd, (sockaddr*)&addr, sizeof(addr)) != 0 && errno != EINPROGRESS) {
+            close(c.fd);
+            c.fd = -1;
+            failed++;
+            continue;
+        }
+        epoll_event ev;
+        ev.events = EPOLLIN | EPOLLOUT | EPOLLET;
+        ev.data.u32 = (uint32_t)i;
+        epoll_ctl(epoll_fd, EPOLL_CTL_ADD, c.fd, &ev);
+        in_flight++;
+    }
+    double connect_s = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+
+    // Only ticks that started after everyone subscribed count towards fan-out
+    unsigned long long first_full_tick = deliveries.empty() ? 0 : deliveries.rbegin()->first + 1;
+    auto measure_start = chrono::steady_clock::now();
+    while (chrono::duration<double>(chrono::steady_clock::now() - measure_start).count() < seconds) {
+        pump(100);
+    }
+    size_t measured_events = events;
+
+    vector<double> spread_ms;
+    size_t complete_ticks = 0, measured_ticks = 0;
+    for (map<unsigned long long, TickDelivery>::iterator it = deliveries.begin(); it != deliveries.end(); ++it) {
+        if (it->first < first_full_tick) continue;
+        measured_ticks++;
+        if (it->second.clients == connected) complete_ticks++;
+        spread_ms.push_back(chrono::duration<double, milli>(it->second.last - it->second.first).count());
+    }
+
+    for (size_t i = 0; i < clients.size(); i++) {
+        if (clients[i].fd >= 0) close(clients[i].fd);
+    }
+    close(epoll_fd);
+
+    cout << connected << " subscribers connected in " << fixed << setprecision(2) << connect_s
+         << " s (" << failed << " failed)" << endl;
+    cout << measured_events << " events received, " << measured_ticks << " ticks measured, "
+         << complete_ticks << " delivered to every subscriber" << endl;
+    cout << setprecision(3) << "Delivery spread per tick: p50 = " << percentile(spread_ms, 0.5)
+         << " ms, p99 = " << percentile(spread_ms, 0.99) << " ms" << endl;
+    return connected > 0 ? 0 : 1;
+}
+
+int main(int argc, char** argv) {
+    int port = DEFAULT_PORT;
+    int interval_ms = DEFAULT_INTERVAL_MS;
+    bool bench = false;
+    string shm_name = GRID_SHM_NAME;
+    string models_path;
+    int bench_clients = 1000;
+    double bench_seconds = 10.0;
+
+    for (int i = 1; i < argc; i++) {
+        string arg = argv[i];
+        if (arg == "--port" && i + 1 < argc) port = atoi(argv[++i]);
+        else if (arg == "--interval" && i + 1 < argc) interval_ms = max(1, atoi(argv[++i]));
+        else if (arg == "--seconds" && i + 1 < argc) bench_seconds = atof(argv[++i]);
+        else if (arg == "--shm" && i + 1 < argc) shm_name = argv[++i];
+        else if (arg == "--no-shm") shm_name.clear();
+        else if (arg == "--models" && i + 1 < argc) models_path = argv[++i];
+        else if (arg == "--bench") {
+            bench = true;
+            if (i + 1 < argc && argv[i + 1][0] != '-') bench_clients = atoi(argv[++i]);
+        } else {
+            cerr << "Usage: " << argv[0] << " [--port n] [--interval ms] [--shm name | --no-shm]"
+                 << " [--models file] [--bench [clients] [--seconds s]]" << endl;
+            return 1;
+        }
+    }
+
+    raiseFileLimit();
+    signal(SIGPIPE, SIG_IGN);
+    if (bench) return runBenchmark(port, max(bench_clients, 1), bench_seconds);
+
+    cout << "========================================" << endl;
+    cout << "GRID STREAM SERVER" << endl;
+    cout << "========================================" << endl;
+
+    signal(SIGINT, handleSignal);
+    signal(SIGTERM, handleSignal);
+
+    GridStateShm shm;
+    ForecastEngine engine;
+    if (!shm_name.empty()) {
+        if (!shm.create(shm_name)) {
+            cerr << "Error: Cannot create shared memory " << shm_name << ": " << strerror(errno) << endl;
+            return 1;
+        }
+        if (!models_path.empty()) {
+            if (!engine.loadStore(models_path)) return 1;
+        } else {
+            engine.train(0, generateSyntheticHistory(90));
+        }
+        cout << "Publishing grid state and forecasts to shared memory " << shm_name << endl;
+    }
+
+    GridStreamServer server(port, interval_ms, shm.isOpen() ? &shm : 0, &engine);
+    if (!server.listen()) return 1;
+    cout << "Listening on port " << port << ", tick every " << interval_ms << " ms" << endl;
+    server.run();
+    server.printSummary();
+    cout << "Shutting down" << endl;
+    return 0;
+}
@@ -0,0 +1,444 @@
+/**
+ * Grid Digital Twin
+ * Vectorized simulator of many feeders, each with solar, wind, load and a battery
+ * Scaled-out counterpart of generateRealtimeData() (server.js) / GridSimulator
+ *
+ * Feeder state is stored as columns (one array per quantity), so each step
+ * runs a few streaming kernels over all feeders: weather and load from the
+ * diurnal curves of generateRealtimeData() with per-feeder capacity scales and
+ * uniform noise, a controller hook that requests battery flows, and battery
+ * physics with power limits and efficiencies that books the residual as
+ * backup energy or curtailment. The time step is configurable (3 s as the
+ * server, or an hour to replay a year in seconds).
+ *
+ * Noise comes from Philox (counter_rng.h) keyed by (seed, step, column,
+ * feeder), so a run is reproducible for any thread count, and feeder i
+ * sees the same weather in a twin of 1,000 feeders as in one of 100,000.
+ * With AVX2 enabled the weather and physics kernels process four feeders
+ * per instruction.
+ */
+
+#ifndef GRID_TWIN_H
+#define GRID_TWIN_H
+
+#include <vector>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <functional>
+#include <stdexcept>
+#include <algorithm>
+
+#include "aligned_buffer.h"
+#include "energy_data.h"
+#include "counter_rng.h"
+#include "grid_state.h"
+#include "grid_recommend.h"
+#include "dispatch_optimizer.h"
+#include "thread_pool.h"
+
+#if defined(__AVX2__) && defined(__FMA__)
+#include <immintrin.h>
+#define GRID_TWIN_AVX2 1
+#endif
+
+const size_t TWIN_CHUNK = 8192;                 // feeders per task, a multiple of 4
+
+struct TwinConfig {
+    size_t feeders;
+    uint64_t seed;
+    double step_seconds;
+    int start_day;                              // day of year at time 0 (midnight)
+    double initial_battery;                     // fraction of capacity
+    DispatchConfig battery;                     // capacity, power limits, efficiencies and costs
+};
+
+inline TwinConfig defaultTwinConfig() {
+    TwinConfig c = { 100000, 42, 3600.0, 0, 0.82, defaultDispatchConfig() };
+    return c;
+}
+
+// Columns seen by a controller for one step; it fills request[] (battery-side
+// energy over the step, + charge) and action[] for feeders [begin, end)
+struct TwinView {
+    size_t step;
+    int day_of_year;
+    double hour;                                // local hour of day, fractional
+    double step_hours;
+    const double* solar;
+    const double* wind;
+    const double* load;
+    const double* battery;
+    double* request;
+    uint8_t* action;
+};
+
+typedef std::function<void(const TwinView& view, size_t begin, size_t end, size_t worker)> TwinController;
+
+// Totals over feeders for one step
+struct TwinStepStats {
+    size_t backup_feeders;
+    double backup_energy, curtailed_energy;
+    double mean_battery;
+};
+
+// Diurnal and seasonal curves of generateRealtimeData(); summer raises solar
+// and lowers wind
+inline double twinSeason(int day_of_year) { return std::sin(TWO_PI * (day_of_year - 80) / 365.0); }
+inline double twinSolarBase(double hour, int day_of_year) {
+    return std::max(0.0, std::sin((hour - 6.0) * TWO_PI / 24.0) * 0.8) * (1.0 + 0.25 * twinSeason(day_of_year));
+}
+inline double twinWindBase(double hour, int day_of_year) {
+    return (0.4 + std::sin(hour * TWO_PI / 12.0) * 0.3) * (1.0 - 0.2 * twinSeason(day_of_year));
+}
+inline double twinLoadBase(double hour) { return 0.5 + std::sin((hour - 12.0) * TWO_PI / 24.0) * 0.3; }
+
+class GridTwin {
+private:
+    enum { COLUMN_SOLAR, COLUMN_WIND, COLUMN_LOAD, COLUMN_COUNT };
+
+    TwinConfig config;
+    CounterRng weather_rng;
+    AlignedBuffer<double> solar_scale, wind_scale, load_scale;
+    AlignedBuffer<double> solar, wind, load, battery, request;
+    AlignedBuffer<double> backup_energy, curtailed_energy;
+    AlignedBuffer<uint8_t> action, backup_active;
+    size_t steps_done;
+
+    struct Workspace {
+        std::vector<double> noise;              // COLUMN_COUNT x TWIN_CHUNK uniforms
+    };
+    std::vector<Workspace> workspaces;
+
+    // Weather and load of feeders [begin, end) at the given base levels
+    void weatherRange(size_t begin, size_t end, double solar_base, double wind_base, double load_base,
+                      size_t step, Workspace& w) {
+        size_t n = end - begin;
+        w.noise.resize(COLUMN_COUNT * TWIN_CHUNK);
+        for (int c = 0; c < COLUMN_COUNT; c++) {
+            weather_rng.uniforms((uint64_t)step * COLUMN_COUNT + c, begin / 4, &w.noise[c * TWIN_CHUNK], n);
+        }
+        const double* us = &w.noise[COLUMN_SOLAR * TWIN_CHUNK];
+        const double* uw = &w.noise[COLUMN_WIND * TWIN_CHUNK];
+        const double* ul = &w.noise[COLUMN_LOAD * TWIN_CHUNK];
+        size_t k = 0;
+#ifdef GRID_TWIN_AVX2
+        const __m256d zero = _mm256_setzero_pd(), half = _mm256_set1_pd(0.5), floor = _mm256_set1_pd(0.2);
+        const __m256d sb = _mm256_set1_pd(solar_base), wb = _mm256_set1_pd(wind_base), lb = _mm256_set1_pd(load_base);
+        const __m256d sn = _mm256_set1_pd(0.1), wn = _mm256_set1_pd(0.15), ln = _mm256_set1_pd(0.05);
+        for (; k + 4 <= n; k += 4) {
+            size_t i = begin + k;
+            __m256d ss = _mm256_load_pd(&solar_scale[i]), ws = _mm256_load_pd(&wind_scale[i]);
+            __m256d ls = _mm256_load_pd(&load_scale[i]);
+            __m256d s = _mm256_fmadd_pd(_mm256_sub_pd(_mm256_loadu_pd(us + k), half), sn, _mm256_mul_pd(ss, sb));
+            __m256d v = _mm256_fmadd_pd(_mm256_sub_pd(_mm256_loadu_pd(uw + k), half), wn, _mm256_mul_pd(ws, wb));
+            __m256d l = _mm256_fmadd_pd(_mm256_sub_pd(_mm256_loadu_pd(ul + k), half), ln, _mm256_mul_pd(ls, lb));
+            _mm256_store_pd(&solar[i], _mm256_min_pd(ss, _mm256_max_pd(zero, s)));
+            _mm256_store_pd(&wind[i], _mm256_min_pd(ws, _mm256_max_pd(zero, v)));
+            _mm256_store_pd(&load[i], _mm256_min_pd(ls, _mm256_max_pd(_mm256_mul_pd(floor, ls), l)));
+        }
+#endif
+        for (; k < n; k++) {
+            size_t i = begin + k;
+            solar[i] = std::min(solar_scale[i], std::max(0.0, solar_scale[i] * solar_base + (us[k] - 0.5) * 0.1));
+            wind[i] = std::min(wind_scale[i], std::max(0.0, wind_scale[i] * wind_base + (uw[k] - 0.5) * 0.15));
+            load[i] = std::min(load_scale[i],
+                               std::max(0.2 * load_scale[i], load_scale[i] * load_base + (ul[k] - 0.5) * 0.05));
+        }
+    }
+
+    // Apply the requested flows within power and charge limits; sums holds
+    // backup feeders, backup energy, curtailed energy and battery level
+    void physicsRange(size_t begin, size_t end, double dt, double* sums) {
+        const DispatchConfig& b = config.battery;
+        const double capacity = b.capacity, inv_capacity = 1.0 / b.capacity;
+        const double charge_limit = b.max_charge * dt, discharge_limit = b.max_discharge * dt;
+        const double inv_charge = 1.0 / b.charge_efficiency, discharge = b.discharge_efficiency;
+        double feeders = 0.0, backup = 0.0, curtailed = 0.0, level = 0.0;
+        size_t i = begin;
+#ifdef GRID_TWIN_AVX2
+        const __m256d zero = _mm256_setzero_pd(), one = _mm256_set1_pd(1.0), vdt = _mm256_set1_pd(dt);
+        const __m256d vcap = _mm256_set1_pd(capacity), vinv_cap = _mm256_set1_pd(inv_capacity);
+        const __m256d up = _mm256_set1_pd(charge_limit), down = _mm256_set1_pd(-discharge_limit);
+        const __m256d vinv_charge = _mm256_set1_pd(inv_charge), vdischarge = _mm256_set1_pd(discharge);
+        __m256d feeders_sum = zero, backup_sum = zero, curtailed_sum = zero, level_sum = zero;
+        for (; i + 4 <= end; i += 4) {
+            __m256d soc = _mm256_load_pd(&battery[i]);
+            __m256d req = _mm256_min_pd(up, _mm256_max_pd(down, _mm256_load_pd(&request[i])));
+            req = _mm256_min_pd(_mm256_mul_pd(_mm256_sub_pd(one, soc), vcap),
+                                _mm256_max_pd(_mm256_sub_pd(zero, _mm256_mul_pd(soc, vcap)), req));
+            __m256d draw = _mm256_blendv_pd(_mm256_mul_pd(req, vdischarge), _mm256_mul_pd(req, vinv_charge),
+                                            _mm256_cmp_pd(req, zero, _CMP_GT_OQ));
+            __m256d net = _mm256_sub_pd(_mm256_add_pd(_mm256_load_pd(&solar[i]), _mm256_load_pd(&wind[i])),
+                                        _mm256_load_pd(&load[i]));
+            __m256d r = _mm256_fmsub_pd(net, vdt, draw);
+            __m256d short_energy = _mm256_max_pd(zero, _mm256_sub_pd(zero, r));
+            __m256d spill = _mm256_max_pd(zero, r);
+            __m256d active = _mm256_cmp_pd(short_energy, zero, _CMP_GT_OQ);
+            soc = _mm256_min_pd(one, _mm256_max_pd(zero, _mm256_fmadd_pd(req, vinv_cap, soc)));
+            _mm256_store_pd(&battery[i], soc);
+            _mm256_store_pd(&backup_energy[i], _mm256_add_pd(_mm256_load_pd(&backup_energy[i]), short_energy));
+            _mm256_store_pd(&curtailed_energy[i], _mm256_add_pd(_mm256_load_pd(&curtailed_energy[i]), spill));
+            int mask = _mm256_movemask_pd(active);
+            for (int k = 0; k < 4; k++) backup_active[i + k] = (uint8_t)((mask >> k) & 1);
+            feeders_sum = _mm256_add_pd(feeders_sum, _mm256_and_pd(active, one));
+            backup_sum = _mm256_add_pd(backup_sum, short_energy);
+            curtailed_sum = _mm256_add_pd(curtailed_sum, spill);
+            level_sum = _mm256_add_pd(level_sum, soc);
+        }
+        double lanes[4][4];
+        _mm256_storeu_pd(lanes[0], feeders_sum);
+        _mm256_storeu_pd(lanes[1], backup_sum);
+        _mm256_storeu_pd(lanes[2], curtailed_sum);
+        _mm256_storeu_pd(lanes[3], level_sum);
+        feeders = lanes[0][0] + lanes[0][1] + lanes[0][2] + lanes[0][3];
+        backup = lanes[1][0] + lanes[1][1] + lanes[1][2] + lanes[1][3];
+        curtailed = lanes[2][0] + lanes[2][1] + lanes[2][2] + lanes[2][3];
+        level = lanes[3][0] + lanes[3][1] + lanes[3][2] + lanes[3][3];
+#endif
+        for (; i < end; i++) {
+            double req = std::min(charge_limit, std::max(-discharge_limit, request[i]));
+            req = std::min((1.0 - battery[i]) * capacity, std::max(-battery[i] * capacity, req));
+            double draw = req > 0.0 ? req * inv_charge : req * discharge;
+            double r = (solar[i] + wind[i] - load[i]) * dt - draw;
+            double short_energy = std::max(0.0, -r), spill = std::max(0.0, r);
+            battery[i] = std::min(1.0, std::max(0.0, battery[i] + req * inv_capacity));
+            backup_energy[i] += short_energy;
+            curtailed_energy[i] += spill;
+            backup_active[i] = short_energy > 0.0;
+            feeders += short_energy > 0.0;
+            backup += short_energy;
+            curtailed += spill;
+            level += battery[i];
+        }
+        sums[0] = feeders;
+        sums[1] = backup;
+        sums[2] = curtailed;
+        sums[3] = level;
+    }
+
+public:
+    explicit GridTwin(const TwinConfig& c = defaultTwinConfig()) : config(c), weather_rng(c.seed), steps_done(0) {
+        if (c.feeders == 0 || !(c.step_seconds > 0.0) || !(c.battery.capacity > 0.0)) {
+            throw std::invalid_argument("GridTwin: need feeders, a positive time step and battery capacity");
+        }
+        size_t n = c.feeders;
+        AlignedBuffer<double>* columns[] = { &solar_scale, &wind_scale, &load_scale, &solar, &wind, &load,
+                                             &battery, &request, &backup_energy, &curtailed_energy };
+        for (size_t k = 0; k < sizeof(columns) / sizeof(columns[0]); k++) columns[k]->resize(n);
+        action.resize(n);
+        backup_active.resize(n);
+
+        // Feeder mix from its own stream: capacity scales in [0.6, 1.4], load in [0.8, 1.2]
+        const CounterRng feeder_rng(c.seed ^ 0x5DEECE66DULL);
+        for (size_t i = 0; i < n; i++) {
+            uint32_t words[4];
+            feeder_rng.block(i, 0, words);
+            solar_scale[i] = 0.6 + 0.8 * uniformFromBits(words[0]);
+            wind_scale[i] = 0.6 + 0.8 * uniformFromBits(words[1]);
+            load_scale[i] = 0.8 + 0.4 * uniformFromBits(words[2]);
+            battery[i] = std::min(1.0, std::max(0.0, c.initial_battery));
+            request[i] = 0.0;
+            backup_energy[i] = 0.0;
+            curtailed_energy[i] = 0.0;
+            action[i] = ACTION_NOMINAL_OPERATION;
+            backup_active[i] = 0;
+        }
+    }
+
+    const TwinConfig& settings() const { return config; }
+    size_t size() const { return config.feeders; }
+    size_t stepCount() const { return steps_done; }
+    double stepHours() const { return config.step_seconds / 3600.0; }
+    double elapsedHours() const { return steps_done * stepHours(); }
+    int dayOfYear() const { return (config.start_day + (int)std::floor(elapsedHours() / 24.0)) % 365; }
+    double hourOfDay() const { return std::fmod(elapsedHours(), 24.0); }
+
+    const double* solarColumn() const { return solar.data(); }
+    const double* windColumn() const { return wind.data(); }
+    const double* loadColumn() const { return load.data(); }
+    const double* batteryColumn() const { return battery.data(); }
+    const uint8_t* actionColumn() const { return action.data(); }
+    const uint8_t* backupColumn() const { return backup_active.data(); }
+    const double* backupEnergy() const { return backup_energy.data(); }
+    const double* curtailedEnergy() const { return curtailed_energy.data(); }
+
+    // Net generation scenarios for the next `hours` hourly steps, drawn from the
+    // twin's own weather model with forecast_seed instead of the realized noise;
+    // out is [feeder][hour][scenario] as DispatchInputs::net
+    void forecastScenarios(ThreadPool& pool, int hours, int scenarios, uint64_t forecast_seed, float* out) const {
+        const CounterRng rng(forecast_seed);
+        double start = elapsedHours();
+        std::vector<double> bases(3 * (size_t)hours);
+        for (int h = 0; h < hours; h++) {
+            double t = start + h, hour = std::fmod(t, 24.0);
+            int day = (config.start_day + (int)std::floor(t / 24.0)) % 365;
+            bases[3 * h] = twinSolarBase(hour, day);
+            bases[3 * h + 1] = twinWindBase(hour, day);
+            bases[3 * h + 2] = twinLoadBase(hour);
+        }
+        size_t draws = 3 * (size_t)scenarios;
+        pool.parallelFor(config.feeders, 256, [&](size_t begin, size_t end, size_t) {
+            std::vector<double> u(draws);
+            for (size_t i = begin; i < end; i++) {
+                for (int h = 0; h < hours; h++) {
+                    rng.uniforms(i, (uint64_t)h * ((draws + 3) / 4), &u[0], draws);
+                    float* net = out + (i * hours + h) * scenarios;
+                    for (int w = 0; w < scenarios; w++) {
+                        double s = std::min(solar_scale[i],
+                                            std::max(0.0, solar_scale[i] * bases[3 * h] + (u[3 * w] - 0.5) * 0.1));
+                        double v = std::min(wind_scale[i],
+                                            std::max(0.0, wind_scale[i] * bases[3 * h + 1] + (u[3 * w + 1] - 0.5) * 0.15));
+                        double l = std::min(load_scale[i], std::max(0.2 * load_scale[i],
+                                            load_scale[i] * bases[3 * h + 2] + (u[3 * w + 2] - 0.5) * 0.05));
+                        net[w] = (float)(s + v - l);
+                    }
+                }
+            }
+        });
+    }
+
+    // Advance one time step: weather, controller, physics
+    TwinStepStats step(ThreadPool& pool, const TwinController& controller) {
+        double dt = stepHours();
+        double hour = hourOfDay();
+        int day = dayOfYear();
+        double solar_base = twinSolarBase(hour, day), wind_base = twinWindBase(hour, day);
+        double load_base = twinLoadBase(hour);
+        TwinView view = { steps_done, day, hour, dt, solar.data(), wind.data(), load.data(), battery.data(),
+                          request.data(), action.data() };
+
+        size_t n_chunks = (config.feeders + TWIN_CHUNK - 1) / TWIN_CHUNK;
+        std::vector<double> sums(4 * n_chunks);
+        if (workspaces.size() < pool.size()) workspaces.resize(pool.size());
+        pool.parallelFor(config.feeders, TWIN_CHUNK, [&](size_t begin, size_t end, size_t worker) {
+            weatherRange(begin, end, solar_base, wind_base, load_base, steps_done, workspaces[worker]);
+            controller(view, begin, end, worker);
+            physicsRange(begin, end, dt, &sums[4 * (begin / TWIN_CHUNK)]);
+        });
+
+        // Reduce in chunk order so totals do not depend on scheduling
+        TwinStepStats stats = { 0, 0.0, 0.0, 0.0 };
+        double feeders = 0.0, level = 0.0;
+        for (size_t c = 0; c < n_chunks; c++) {
+            feeders += sums[4 * c];
+            stats.backup_energy += sums[4 * c + 1];
+            stats.curtailed_energy += sums[4 * c + 2];
+            level += sums[4 * c + 3];
+        }
+        stats.backup_feeders = (size_t)feeders;
+        stats.mean_battery = level / config.feeders;
+        steps_done++;
+        return stats;
+    }
+
+    // Mean feeder as a GridState, for the snapshot publishers of grid_state_shm.h
+    GridState summary(long long now_ms) const {
+        double s = 0.0, w = 0.0, l = 0.0, b = 0.0;
+        size_t active = 0;
+        for (size_t i = 0; i < config.feeders; i++) {
+            s += solar[i];
+            w += wind[i];
+            l += load[i];
+            b += battery[i];
+            active += backup_active[i];
+        }
+        double n = (double)config.feeders;
+        GridState state = { s / n, w / n, b / n, l / n, 2 * active > config.feeders, now_ms };
+        return state;
+    }
+};
+
+// The rule table of grid_recommend.h as a twin controller: discharge to cover
+// the deficit, charge with the surplus, otherwise let the battery absorb the
+// net generation as generateRealtimeData() does
+inline TwinController recommendationController(const DispatchConfig& battery) {
+    double inv_discharge = 1.0 / battery.discharge_efficiency, charge = battery.charge_efficiency;
+    return [inv_discharge, charge](const TwinView& v, size_t begin, size_t end, size_t) {
+        RecommendationInputs in = { v.solar, v.wind, v.load, v.battery, end };
+        recommendRange(in, begin, end, v.action, 0, 0);
+        size_t i = begin;
+#ifdef GRID_TWIN_AVX2
+        const __m256d zero = _mm256_setzero_pd(), dt = _mm256_set1_pd(v.step_hours);
+        const __m256d up = _mm256_set1_pd(charge), down = _mm256_set1_pd(inv_discharge);
+        const __m256i backup = _mm256_set1_epi64x(ACTION_ACTIVATE_BACKUP);
+        const __m256i curtail = _mm256_set1_epi64x(ACTION_CURTAIL_GENERATION);
+        for (; i + 4 <= end; i += 4) {
+            __m256d net = _mm256_mul_pd(_mm256_sub_pd(_mm256_add_pd(_mm256_loadu_pd(v.solar + i),
+                                                                    _mm256_loadu_pd(v.wind + i)),
+                                                      _mm256_loadu_pd(v.load + i)), dt);
+            __m256d absorb = _mm256_blendv_pd(_mm256_mul_pd(net, down), _mm256_mul_pd(net, up),
+                                              _mm256_cmp_pd(net, zero, _CMP_GT_OQ));
+            int32_t packed;
+            std::memcpy(&packed, v.action + i, 4);
+            __m256i a = _mm256_cvtepu8_epi64(_mm_cvtsi32_si128(packed));
+            __m256i idle = _mm256_or_si256(_mm256_cmpeq_epi64(a, backup), _mm256_cmpeq_epi64(a, curtail));
+            _mm256_storeu_pd(v.request + i, _mm256_andnot_pd(_mm256_castsi256_pd(idle), absorb));
+        }
+#endif
+        for (; i < end; i++) {
+            double net = (v.solar[i] + v.wind[i] - v.load[i]) * v.step_hours;
+            double absorb = net > 0.0 ? net * charge : net * inv_discharge;
+            uint8_t a = v.action[i];
+            v.request[i] = a == ACTION_ACTIVATE_BACKUP || a == ACTION_CURTAIL_GENERATION ? 0.0 : absorb;
+        }
+    };
+}
+
+// Dispatch plans (dispatch_optimizer.h) as a twin controller. refresh() solves
+// every feeder over the horizon from forecast scenarios of the twin's weather
+// model; between refreshes each hourly step acts on the stored values.
+class TwinDispatchPlanner {
+private:
+    const GridTwin& twin;
+    DispatchOptimizer optimizer;
+    int refresh_hours, scenarios;
+    DispatchPlan plan;
+    std::vector<float> net, soc;
+    size_t planned_at;
+    uint64_t refreshes;
+
+public:
+    TwinDispatchPlanner(const GridTwin& t, const DispatchConfig& config, int refresh_every = 24, int n_scenarios = 16)
+        : twin(t), optimizer(config), refresh_hours(refresh_every), scenarios(n_scenarios), planned_at(0),
+          refreshes(0) {
+        if (std::fabs(t.stepHours() - 1.0) > 1e-9) {
+            throw std::invalid_argument("TwinDispatchPlanner: dispatch plans need hourly twin steps");
+        }
+        if (refresh_every < 1 || refresh_every > config.horizon || n_scenarios < 1) {
+            throw std::invalid_argument("TwinDispatchPlanner: refresh interval must lie within the horizon");
+        }
+    }
+
+    bool due() const { return refreshes == 0 || twin.stepCount() - planned_at >= (size_t)refresh_hours; }
+
+    void refresh(ThreadPool& pool) {
+        const DispatchConfig& c = optimizer.settings();
+        size_t n = twin.size();
+        net.resize(n * c.horizon * scenarios);
+        soc.resize(n);
+        twin.forecastScenarios(pool, c.horizon, scenarios, twin.settings().seed + 1000003ULL * (refreshes + 1), &net[0]);
+        for (size_t i = 0; i < n; i++) soc[i] = (float)twin.batteryColumn()[i];
+        DispatchInputs in = { &net[0], &soc[0], n, c.horizon, scenarios };
+        optimizer.solve(pool, in, plan, true);
+        planned_at = twin.stepCount();
+        refreshes++;
+    }
+
+    TwinController controller() const {
+        return [this](const TwinView& v, size_t begin, size_t end, size_t) {
+            const int levels = optimizer.settings().soc_levels, rows = optimizer.settings().horizon + 1;
+            size_t offset = v.step - planned_at + 1;
+            for (size_t i = begin; i < end; i++) {
+                const float* next = &plan.values[(i * rows + offset) * levels];
+                DispatchStep d = optimizer.decide(next, optimizer.levelOf(v.battery[i]),
+                                                  (v.solar[i] + v.wind[i] - v.load[i]) * v.step_hours);
+                v.request[i] = d.flow;
+                v.action[i] = (uint8_t)d.action;
+            }
+        };
+    }
+};
+
+#endif
@@ -0,0 +1,222 @@
+/**
+ * Harmonic Forecaster
+ * Extrapolates the periodic model described by the FFT spectrum of a series
+ * Cheap, weather-free 24/48/72h baseline to the Beta regression forecasts
+ *
+ * Over a trailing window the series is detrended and Hann-tapered, and the
+ * FFT (fourier_transform.h) picks the strongest spectral peaks. Each peak's
+ * frequency is refined between bins by Gaussian interpolation of the
+ * log-magnitudes around it (bins of the zero-padded FFT rarely fall on the
+ * 24h or 12h period exactly, and a small frequency error turns into a large
+ * phase error when extrapolated). Amplitude and phase of every harmonic are
+ * then fitted by least squares jointly with a linear trend,
+ *
+ *   y(t) = level + slope * t + sum_j a_j cos(2 pi f_j t) + b_j sin(2 pi f_j t),
+ *
+ * which replaces the leakage-biased FFT amplitudes, and the fitted model is
+ * evaluated past the end of the window.
+ */
+
+#ifndef HARMONIC_FORECAST_H
+#define HARMONIC_FORECAST_H
+
+#include <vector>
+#include <cmath>
+#include <cstddef>
+#include <limits>
+#include <stdexcept>
+#include <algorithm>
+
+#include "fourier_transform.h"
+#include "weighted_gram.h"
+#include "thread_pool.h"
+
+const int HARMONIC_MAX_TERMS = 12;
+
+struct HarmonicConfig {
+    int window;                                 // trailing samples fitted
+    int harmonics;                              // spectral peaks kept, <= HARMONIC_MAX_TERMS
+    double min_period;                          // shortest period kept, in samples
+    double min_relative_peak;                   // peaks below this fraction of the largest are noise
+    double lower, upper;                        // forecast clamp (capacity factors: 0, 1)
+};
+
+inline HarmonicConfig defaultHarmonicConfig() {
+    // Four weeks of hourly data; the diurnal harmonics fall at 24, 12, 8, 6 h
+    HarmonicConfig c = { 672, 6, 3.0, 0.1, -std::numeric_limits<double>::infinity(),
+                         std::numeric_limits<double>::infinity() };
+    return c;
+}
+
+// Time t counts samples from the first point of the fitted window
+struct HarmonicModel {
+    int samples;                                // window length; forecasts start at t = samples
+    int terms;
+    double level, slope;
+    double frequency[HARMONIC_MAX_TERMS];       // cycles per sample
+    double cos_coef[HARMONIC_MAX_TERMS], sin_coef[HARMONIC_MAX_TERMS];
+    double rmse;                                // in-sample residual
+};
+
+class HarmonicForecaster {
+private:
+    HarmonicConfig config;
+
+    // Up to `harmonics` interpolated peak frequencies of x (length n, detrended)
+    int pickFrequencies(const std::vector<double>& x, double* frequency) const {
+        size_t n = x.size();
+        std::vector<double> tapered(n);
+        for (size_t i = 0; i < n; i++) tapered[i] = x[i] * (0.5 - 0.5 * std::cos(2 * PI * i / (n - 1)));
+        FourierTransform ft(tapered);
+        ft.compute();
+        std::vector<double> magnitude = ft.getMagnitudeSpectrum();
+        double bins = 2.0 * magnitude.size();
+
+        // Local maxima with at least one cycle in the window and period >= min_period
+        std::vector<std::pair<double, size_t> > peaks;
+        for (size_t k = 2; k + 1 < magnitude.size(); k++) {
+            double f = k / bins;
+            if (f * n < 1.0 || f * config.min_period > 1.0) continue;
+            if (magnitude[k] > magnitude[k - 1] && magnitude[k] >= magnitude[k + 1] && magnitude[k] > 0.0) {
+                peaks.push_back(std::make_pair(magnitude[k], k));
+            }
+        }
+        std::sort(peaks.begin(), peaks.end(),
+                  [](const std::pair<double, size_t>& a, const std::pair<double, size_t>& b) {
+                      return a.first > b.first;
+                  });
+        int terms = std::min((int)peaks.size(), config.harmonics);
+        while (terms > 1 && peaks[terms - 1].first < config.min_relative_peak * peaks[0].first) terms--;
+        for (int j = 0; j < terms; j++) {
+            size_t k = peaks[j].second;
+            double l0 = std::log(std::max(magnitude[k - 1], 1e-300));
+            double l1 = std::log(magnitude[k]);
+            double l2 = std::log(std::max(magnitude[k + 1], 1e-300));
+            double curvature = l0 - 2.0 * l1 + l2;
+            double offset = curvature < 0.0 ? 0.5 * (l0 - l2) / curvature : 0.0;
+            frequency[j] = (k + std::max(-0.5, std::min(0.5, offset))) / bins;
+        }
+        return terms;
+    }
+
+public:
+    explicit HarmonicForecaster(const HarmonicConfig& c = defaultHarmonicConfig()) : config(c) {
+        if (c.window < 16 || c.harmonics < 0 || c.harmonics > HARMONIC_MAX_TERMS || !(c.min_period >= 2.0)) {
+            throw std::invalid_argument("HarmonicForecaster: window >= 16, harmonics <= HARMONIC_MAX_TERMS, "
+                                        "min_period >= 2");
+        }
+    }
+
+    const HarmonicConfig& settings() const { return config; }
+
+    // Fit the trailing window of series[0, length); false if it is too short
+    bool fit(const double* series, size_t length, HarmonicModel& model) const {
+        size_t n = std::min(length, (size_t)config.window);
+        if (n < 16) return false;
+        const double* y = series + (length - n);
+
+        // Straight-line fit, removed before the spectrum
+        double center = 0.5 * (n - 1), sxx = 0.0, sxy = 0.0, mean = 0.0;
+        for (size_t t = 0; t < n; t++) mean += y[t];
+        mean /= n;
+        for (size_t t = 0; t < n; t++) {
+            sxx += (t - center) * (t - center);
+            sxy += (t - center) * (y[t] - mean);
+        }
+        std::vector<double> detrended(n);
+        for (size_t t = 0; t < n; t++) detrended[t] = y[t] - mean - sxy / sxx * (t - center);
+
+        model.samples = (int)n;
+        model.terms = pickFrequencies(detrended, model.frequency);
+
+        // Normal equations over [1, (t - center) / n, cos, sin, ...]; cos/sin by rotation
+        const size_t p = 2 + 2 * model.terms;
+        double G[(2 + 2 * HARMONIC_MAX_TERMS) * (2 + 2 * HARMONIC_MAX_TERMS)] = { 0.0 };
+        double rhs[2 + 2 * HARMONIC_MAX_TERMS] = { 0.0 };
+        double row[2 + 2 * HARMONIC_MAX_TERMS];
+        double rot_c[HARMONIC_MAX_TERMS], rot_s[HARMONIC_MAX_TERMS];
+        for (int j = 0; j < model.terms; j++) {
+            rot_c[j] = std::cos(2 * PI * model.frequency[j]);
+            rot_s[j] = std::sin(2 * PI * model.frequency[j]);
+            row[2 + 2 * j] = 1.0;
+            row[3 + 2 * j] = 0.0;
+        }
+        for (size_t t = 0; t < n; t++) {
+            row[0] = 1.0;
+            row[1] = (t - center) / n;
+            for (size_t a = 0; a < p; a++) {
+                for (size_t b = 0; b <= a; b++) G[a * p + b] += row[a] * row[b];
+                rhs[a] += row[a] * y[t];
+            }
+            for (int j = 0; j < model.terms; j++) {
+                double c = row[2 + 2 * j], s = row[3 + 2 * j];
+                row[2 + 2 * j] = c * rot_c[j] - s * rot_s[j];
+                row[3 + 2 * j] = s * rot_c[j] + c * rot_s[j];
+            }
+        }
+        choleskyDecomposeRegularized(G, p);
+        choleskySolve(G, p, rhs);
+
+        model.slope = rhs[1] / n;
+        model.level = rhs[0] - model.slope * center;
+        for (int j = 0; j < model.terms; j++) {
+            model.cos_coef[j] = rhs[2 + 2 * j];
+            model.sin_coef[j] = rhs[3 + 2 * j];
+        }
+
+        double sse = 0.0;
+        std::vector<double> fitted(n);
+        evaluate(model, 0, n, &fitted[0], false);
+        for (size_t t = 0; t < n; t++) sse += (y[t] - fitted[t]) * (y[t] - fitted[t]);
+        model.rmse = std::sqrt(sse / n);
+        return true;
+    }
+
+    // Model at t = first, first + 1, ... (count values), optionally clamped
+    void evaluate(const HarmonicModel& model, size_t first, size_t count, double* out, bool clamp = true) const {
+        for (size_t h = 0; h < count; h++) out[h] = model.level + model.slope * (double)(first + h);
+        for (int j = 0; j < model.terms; j++) {
+            double angle = 2 * PI * model.frequency[j];
+            double c = std::cos(angle * first), s = std::sin(angle * first);
+            double rc = std::cos(angle), rs = std::sin(angle);
+            for (size_t h = 0; h < count; h++) {
+                out[h] += model.cos_coef[j] * c + model.sin_coef[j] * s;
+                double next = c * rc - s * rs;
+                s = s * rc + c * rs;
+                c = next;
+            }
+        }
+        if (clamp) {
+            for (size_t h = 0; h < count; h++) out[h] = std::max(config.lower, std::min(config.upper, out[h]));
+        }
+    }
+
+    // The `horizon` values after the end of the fitted window
+    void forecast(const HarmonicModel& model, int horizon, double* out) const {
+        evaluate(model, (size_t)model.samples, (size_t)horizon, out);
+    }
+
+    // count series of `length` samples (row-major) -> count x horizon forecasts;
+    // series too short to fit get NaN. models, if given, receives every fit.
+    void forecastBatch(ThreadPool& pool, const double* series, size_t count, size_t length, int horizon,
+                       double* out, std::vector<HarmonicModel>* models = 0) const {
+        if (horizon < 1) throw std::invalid_argument("HarmonicForecaster::forecastBatch: horizon must be positive");
+        if (models) models->resize(count);
+        pool.parallelFor(count, 16, [&](size_t begin, size_t end, size_t) {
+            for (size_t i = begin; i < end; i++) {
+                HarmonicModel model = HarmonicModel();
+                double* f = out + i * horizon;
+                if (fit(series + i * length, length, model)) {
+                    forecast(model, horizon, f);
+                } else {
+                    std::fill(f, f + horizon, std::numeric_limits<double>::quiet_NaN());
+                    model.samples = 0;
+                    model.terms = 0;
+                }
+                if (models) (*models)[i] = model;
+            }
+        });
+    }
+};
+
+#endif
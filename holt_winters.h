@@ -0,0 +1,564 @@
+/**
+ * Holt-Winters Exponential Smoothing
+ * Additive and multiplicative seasonal ETS, fitted per series in batches
+ *
+ * Additive (period m, one-step forecast l + b + s):
+ *   l' = l + b + alpha * (y - s - l - b)
+ *   b' = b + beta * (l' - l - b)
+ *   s' = s + gamma * (y - l' - s)
+ * Multiplicative ((l + b) * s): y - s becomes y / s and y - l' becomes y / l'.
+ *
+ * Initial level, trend and seasonal indices come from SeasonalDecomposition
+ * (fourier_transform.h) of the first init_periods cycles: level and trend
+ * from its moving-average trend, indices from the phase averages of the
+ * detrended series. alpha, beta and
+ * gamma minimize the one-step SSE over the whole series by Nelder-Mead in
+ * logit coordinates, so they stay inside (0, 1).
+ *
+ * Each worker keeps HW_GROUP series in flight, one per float SIMD lane: every
+ * lane runs its own Nelder-Mead search as an ask/tell state machine, and each
+ * round evaluates all requested parameter points with one pass of the
+ * recursions over the interleaved series (AVX2+FMA when available). A lane
+ * whose search has converged takes the next series of the worker's range, so
+ * slow searches do not hold the others back.
+ */
+
+#ifndef HOLT_WINTERS_H
+#define HOLT_WINTERS_H
+
+#include <vector>
+#include <cmath>
+#include <cstddef>
+#include <limits>
+#include <stdexcept>
+#include <algorithm>
+
+#include "aligned_buffer.h"
+#include "fourier_transform.h"
+#include "thread_pool.h"
+
+#if defined(__AVX2__) && defined(__FMA__)
+#include <immintrin.h>
+#define HOLT_WINTERS_AVX2 1
+#endif
+
+const int HW_LANES = 8;                         // floats per AVX2 register
+const int HW_VECTORS = 2;                       // independent recursions interleaved per step (AVX2)
+const int HW_GROUP = HW_LANES * HW_VECTORS;     // series in flight per worker
+const double HW_SEASON_FLOOR = 1e-3;            // multiplicative indices and level divisors stay above this
+
+enum HoltWintersSeason { HW_ADDITIVE = 0, HW_MULTIPLICATIVE = 1 };
+
+struct HoltWintersConfig {
+    int period;                                 // samples per season
+    HoltWintersSeason season;
+    int init_periods;                           // cycles decomposed for the initial state
+    int max_evaluations;                        // SSE evaluations per series
+    double tolerance;                           // relative SSE spread of the simplex at convergence
+};
+
+inline HoltWintersConfig defaultHoltWintersConfig() {
+    HoltWintersConfig c = { 24, HW_ADDITIVE, 14, 150, 1e-6 };
+    return c;
+}
+
+struct HoltWintersModel {
+    double alpha, beta, gamma;
+    double level, trend;                        // at the end of the series
+    std::vector<double> seasonal;               // seasonal[k] applies k + 1 steps ahead (mod period)
+    double sse;
+    int evaluations;
+};
+
+// Nelder-Mead over R^D as an ask/tell state machine, so several independent
+// searches can share batched function evaluations
+template <int D>
+class NelderMeadSearch {
+private:
+    enum Phase { INITIAL, REFLECT, EXPAND, CONTRACT_OUTSIDE, CONTRACT_INSIDE, SHRINK, CONVERGED };
+
+    double x[D + 1][D], f[D + 1];
+    double centroid[D], reflected[D], trial[D], reflected_value;
+    Phase phase;
+    int index, evaluations, max_evaluations;
+    double tolerance;
+
+    void point(double scale, const double* from, double* out) const {
+        for (int d = 0; d < D; d++) out[d] = centroid[d] + scale * (from[d] - centroid[d]);
+    }
+
+    void replaceWorst(const double* p, double value) {
+        std::copy(p, p + D, x[D]);
+        f[D] = value;
+    }
+
+    // Order the simplex, test convergence and propose the reflected point
+    void iterate() {
+        for (int i = 1; i <= D; i++) {
+            for (int j = i; j > 0 && f[j] < f[j - 1]; j--) {
+                std::swap(f[j], f[j - 1]);
+                for (int d = 0; d < D; d++) std::swap(x[j][d], x[j - 1][d]);
+            }
+        }
+        if (f[D] - f[0] <= tolerance * (std::fabs(f[0]) + 1e-300) || evaluations >= max_evaluations) {
+            phase = CONVERGED;
+            return;
+        }
+        for (int d = 0; d < D; d++) {
+            centroid[d] = 0.0;
+            for (int i = 0; i < D; i++) centroid[d] += x[i][d] / D;
+        }
+        point(-1.0, x[D], reflected);
+        phase = REFLECT;
+    }
+
+    void shrink() {
+        for (int i = 1; i <= D; i++) {
+            for (int d = 0; d < D; d++) x[i][d] = x[0][d] + 0.5 * (x[i][d] - x[0][d]);
+        }
+        phase = SHRINK;
+        index = 1;
+    }
+
+public:
+    NelderMeadSearch() : phase(CONVERGED), index(0), evaluations(0), max_evaluations(0), tolerance(0.0) {}
+
+    void start(const double* x0, double step, int max_evals, double tol) {
+        for (int i = 0; i <= D; i++) {
+            std::copy(x0, x0 + D, x[i]);
+            if (i > 0) x[i][i - 1] += step;
+        }
+        phase = INITIAL;
+        index = 0;
+        evaluations = 0;
+        max_evaluations = max_evals;
+        tolerance = tol;
+    }
+
+    bool converged() const { return phase == CONVERGED; }
+    int evaluationCount() const { return evaluations; }
+    const double* best() const { return x[0]; }
+    double bestValue() const { return f[0]; }
+
+    // Next point to evaluate (the best point once converged)
+    const double* ask() const {
+        switch (phase) {
+        case INITIAL:
+        case SHRINK: return x[index];
+        case REFLECT: return reflected;
+        case EXPAND:
+        case CONTRACT_OUTSIDE:
+        case CONTRACT_INSIDE: return trial;
+        default: return x[0];
+        }
+    }
+
+    void tell(double value) {
+        if (phase == CONVERGED) return;
+        if (!(value == value)) value = std::numeric_limits<double>::infinity();
+        evaluations++;
+        switch (phase) {
+        case INITIAL:
+        case SHRINK:
+            f[index] = value;
+            if (++index > D) iterate();
+            break;
+        case REFLECT:
+            reflected_value = value;
+            if (value < f[0]) {
+                point(-2.0, x[D], trial);
+                phase = EXPAND;
+            } else if (value < f[D - 1]) {
+                replaceWorst(reflected, value);
+                iterate();
+            } else if (value < f[D]) {
+                point(0.5, reflected, trial);
+                phase = CONTRACT_OUTSIDE;
+            } else {
+                point(0.5, x[D], trial);
+                phase = CONTRACT_INSIDE;
+            }
+            break;
+        case EXPAND:
+            if (value < reflected_value) replaceWorst(trial, value);
+            else replaceWorst(reflected, reflected_value);
+            iterate();
+            break;
+        case CONTRACT_OUTSIDE:
+            if (value <= reflected_value) {
+                replaceWorst(trial, value);
+                iterate();
+            } else {
+                shrink();
+            }
+            break;
+        case CONTRACT_INSIDE:
+            if (value < f[D]) {
+                replaceWorst(trial, value);
+                iterate();
+            } else {
+                shrink();
+            }
+            break;
+        default:
+            break;
+        }
+    }
+};
+
+#ifdef HOLT_WINTERS_AVX2
+// Recursion state of HW_LANES series for HoltWinters::recursions
+struct HwVectorState {
+    __m256 k_base, k_trend, k_season, alpha, base, trend, sum;
+
+    template <typename W>
+    void load(const W& ws, int offset) {
+        k_base = _mm256_loadu_ps(ws.k_base + offset);
+        k_trend = _mm256_loadu_ps(ws.k_trend + offset);
+        k_season = _mm256_loadu_ps(ws.k_season + offset);
+        alpha = _mm256_loadu_ps(ws.alpha + offset);
+        base = _mm256_loadu_ps(ws.base0 + offset);
+        trend = _mm256_loadu_ps(ws.trend0 + offset);
+        sum = _mm256_setzero_ps();
+    }
+
+    template <bool ADDITIVE>
+    inline __attribute__((always_inline)) void step(const float* y, float* season) {
+        const __m256 two = _mm256_set1_ps(2.0f), floor = _mm256_set1_ps((float)HW_SEASON_FLOOR);
+        __m256 yt = _mm256_load_ps(y), s = _mm256_load_ps(season);
+        __m256 next_base = _mm256_add_ps(base, trend);
+        __m256 d, next_season;
+        if (ADDITIVE) {
+            d = _mm256_sub_ps(_mm256_sub_ps(yt, s), base);
+            sum = _mm256_fmadd_ps(d, d, sum);
+            next_season = _mm256_fmadd_ps(k_season, d, s);
+        } else {
+            // Reciprocals by one Newton step on rcp: r (2 - x r)
+            __m256 r = _mm256_rcp_ps(s);
+            r = _mm256_mul_ps(r, _mm256_fnmadd_ps(s, r, two));
+            d = _mm256_fmsub_ps(yt, r, base);
+            __m256 e = _mm256_mul_ps(d, s);
+            sum = _mm256_fmadd_ps(e, e, sum);
+            __m256 level = _mm256_max_ps(floor, _mm256_fmadd_ps(alpha, d, base));
+            __m256 q = _mm256_rcp_ps(level);
+            q = _mm256_mul_ps(q, _mm256_fnmadd_ps(level, q, two));
+            next_season = _mm256_max_ps(floor, _mm256_fmadd_ps(k_season, _mm256_fmsub_ps(yt, q, s), s));
+        }
+        base = _mm256_fmadd_ps(k_base, d, next_base);
+        trend = _mm256_fmadd_ps(k_trend, d, trend);
+        _mm256_store_ps(season, next_season);
+    }
+
+    // Add the float SSE partials to the double totals
+    template <typename W>
+    void flush(W& ws, int offset) {
+        float partial[HW_LANES];
+        _mm256_storeu_ps(partial, sum);
+        for (int lane = 0; lane < HW_LANES; lane++) ws.sse[offset + lane] += partial[lane];
+        sum = _mm256_setzero_ps();
+    }
+
+    template <typename W>
+    void store(W& ws, int offset) const {
+        _mm256_storeu_ps(ws.base + offset, base);
+        _mm256_storeu_ps(ws.trend + offset, trend);
+    }
+};
+#endif
+
+class HoltWinters {
+private:
+    HoltWintersConfig config;
+
+    static double logistic(double u) { return 1.0 / (1.0 + std::exp(-u)); }
+    static double logit(double p) { return std::log(p / (1.0 - p)); }
+
+    enum LaneState { LANE_EMPTY, LANE_SEARCH, LANE_FINAL };
+
+    // One group of HW_GROUP series in flight on a worker
+    struct Workspace {
+        AlignedBuffer<float> y;                 // [t][lane]
+        AlignedBuffer<float> season;            // [phase][lane], recursion state
+        AlignedBuffer<float> initial_season;    // [phase][lane]
+        float base0[HW_GROUP], trend0[HW_GROUP];                // level + trend, trend at t = 0
+        float base[HW_GROUP], trend[HW_GROUP];                  // ... at t = n after a pass
+        float k_base[HW_GROUP], k_trend[HW_GROUP], k_season[HW_GROUP], alpha[HW_GROUP];
+        double sse[HW_GROUP];
+        NelderMeadSearch<3> search[HW_GROUP];
+        LaneState state[HW_GROUP];
+        size_t series[HW_GROUP];
+    };
+
+    // Initial state of one series from the decomposition of its first cycles
+    void initialState(const double* y, size_t length, double& level, double& trend, double* season) const {
+        int m = config.period;
+        size_t w = std::min(length, (size_t)config.init_periods * m);
+        // Only the moving-average trend: the seasonal indices are the phase
+        // averages of y - trend, which the FFT seasonal term would approximate
+        SeasonalDecomposition decomposition(y, w, m);
+        decomposition.extractTrend();
+        const std::vector<double>& T = decomposition.getTrend();
+        size_t cycles = std::max((size_t)1, w / m);
+
+        double first = 0.0, last = 0.0;
+        for (int k = 0; k < m; k++) {
+            first += T[k] / m;
+            last += T[(cycles - 1) * m + k] / m;
+        }
+        level = first;
+        trend = cycles > 1 ? (last - first) / ((cycles - 1) * m) : 0.0;
+
+        double mean = 0.0;
+        for (int k = 0; k < m; k++) {
+            double sum = 0.0;
+            for (size_t c = 0; c < cycles; c++) {
+                size_t i = c * m + k;
+                double detrended = y[i] - T[i];
+                sum += config.season == HW_ADDITIVE ? detrended
+                                                    : 1.0 + detrended / std::max(std::fabs(T[i]), HW_SEASON_FLOOR);
+            }
+            season[k] = sum / cycles;
+            if (config.season == HW_MULTIPLICATIVE) season[k] = std::max(HW_SEASON_FLOOR, season[k]);
+            mean += season[k] / m;
+        }
+        for (int k = 0; k < m; k++) {
+            if (config.season == HW_ADDITIVE) season[k] -= mean;
+            else season[k] = std::max(HW_SEASON_FLOOR, season[k] / mean);
+        }
+        if (config.season == HW_MULTIPLICATIVE) level = std::max(HW_SEASON_FLOOR, level);
+    }
+
+    // Error-correction form over B = level + trend, with d the one-step error
+    // (additive) or the error over the seasonal index (multiplicative):
+    //   B' = B + trend + alpha (1 + beta) d,  trend' = trend + alpha beta d
+    // so the loop-carried chain is one subtraction and one FMA per step.
+    // SSE partials are flushed to double once per period.
+    template <bool ADDITIVE>
+    void recursions(Workspace& ws, size_t n) const {
+        const int m = config.period;
+        std::copy(ws.initial_season.data(), ws.initial_season.data() + (size_t)m * HW_GROUP, ws.season.data());
+        float* season = ws.season.data();
+        const float* y = ws.y.data();
+        std::fill(ws.sse, ws.sse + HW_GROUP, 0.0);
+#ifdef HOLT_WINTERS_AVX2
+        // Named per-vector states (not arrays) so they stay in registers
+        HwVectorState first, second;
+        first.load(ws, 0);
+        second.load(ws, HW_LANES);
+        int k = 0;
+        for (size_t t = 0; t < n; t++) {
+            float* pos = season + k * HW_GROUP;
+            const float* yt = y + t * HW_GROUP;
+            first.step<ADDITIVE>(yt, pos);
+            second.step<ADDITIVE>(yt + HW_LANES, pos + HW_LANES);
+            if (++k == m) {
+                k = 0;
+                first.flush(ws, 0);
+                second.flush(ws, HW_LANES);
+            }
+        }
+        first.flush(ws, 0);
+        second.flush(ws, HW_LANES);
+        first.store(ws, 0);
+        second.store(ws, HW_LANES);
+#else
+        for (int lane = 0; lane < HW_GROUP; lane++) {
+            const float floor = (float)HW_SEASON_FLOOR;
+            float base = ws.base0[lane], trend = ws.trend0[lane], sum = 0.0f;
+            int k = 0;
+            for (size_t t = 0; t < n; t++) {
+                float yt = y[t * HW_GROUP + lane], s = season[k * HW_GROUP + lane], d;
+                if (ADDITIVE) {
+                    d = yt - s - base;
+                    sum += d * d;
+                    season[k * HW_GROUP + lane] = s + ws.k_season[lane] * d;
+                } else {
+                    d = yt / s - base;
+                    sum += (d * s) * (d * s);
+                    float level = std::max(floor, base + ws.alpha[lane] * d);
+                    season[k * HW_GROUP + lane] = std::max(floor, s + ws.k_season[lane] * (yt / level - s));
+                }
+                base += trend + ws.k_base[lane] * d;
+                trend += ws.k_trend[lane] * d;
+                if (++k == m) {
+                    k = 0;
+                    ws.sse[lane] += sum;
+                    sum = 0.0f;
+                }
+            }
+            ws.sse[lane] += sum;
+            ws.base[lane] = base;
+            ws.trend[lane] = trend;
+        }
+#endif
+    }
+
+    // Start the search for series i in a lane
+    template <typename T>
+    void loadLane(Workspace& ws, int lane, const T* series, size_t i, size_t length) const {
+        const int m = config.period;
+        std::vector<double> column(length), season(m);
+        const T* row = series + i * length;
+        for (size_t t = 0; t < length; t++) {
+            column[t] = (double)row[t];
+            ws.y[t * HW_GROUP + lane] = (float)row[t];
+        }
+        double level, trend;
+        initialState(&column[0], length, level, trend, &season[0]);
+        for (int k = 0; k < m; k++) ws.initial_season[k * HW_GROUP + lane] = (float)season[k];
+        ws.base0[lane] = (float)(level + trend);
+        ws.trend0[lane] = (float)trend;
+
+        const double start[3] = { logit(0.2), logit(0.01), logit(0.1) };
+        ws.search[lane].start(start, 1.0, config.max_evaluations, config.tolerance);
+        ws.state[lane] = LANE_SEARCH;
+        ws.series[lane] = i;
+    }
+
+    void harvestLane(const Workspace& ws, int lane, size_t length, HoltWintersModel& model) const {
+        const int m = config.period;
+        const double* u = ws.search[lane].ask();
+        model.alpha = logistic(u[0]);
+        model.beta = logistic(u[1]);
+        model.gamma = logistic(u[2]);
+        model.trend = ws.trend[lane];
+        model.level = (double)ws.base[lane] - ws.trend[lane];
+        model.sse = ws.sse[lane];
+        model.evaluations = ws.search[lane].evaluationCount();
+        model.seasonal.resize(m);
+        for (int k = 0; k < m; k++) model.seasonal[k] = ws.season[((length + k) % m) * HW_GROUP + lane];
+    }
+
+    // Fit series [begin, end): lanes run independent searches and take the
+    // next series as soon as theirs has converged
+    template <typename T>
+    void fitRange(const T* series, size_t begin, size_t end, size_t length, Workspace& ws,
+                  std::vector<HoltWintersModel>& models) const {
+        const int m = config.period;
+        ws.y.resize(length * HW_GROUP);
+        ws.season.resize((size_t)m * HW_GROUP);
+        ws.initial_season.resize((size_t)m * HW_GROUP);
+        std::fill(ws.y.data(), ws.y.data() + length * HW_GROUP, 0.0f);
+        std::fill(ws.initial_season.data(), ws.initial_season.data() + (size_t)m * HW_GROUP, 1.0f);
+        std::fill(ws.base0, ws.base0 + HW_GROUP, 0.0f);
+        std::fill(ws.trend0, ws.trend0 + HW_GROUP, 0.0f);
+
+        size_t next = begin;
+        int busy = 0;
+        for (int lane = 0; lane < HW_GROUP; lane++) {
+            ws.state[lane] = LANE_EMPTY;
+            if (next < end) {
+                loadLane(ws, lane, series, next++, length);
+                busy++;
+            }
+        }
+        while (busy > 0) {
+            for (int lane = 0; lane < HW_GROUP; lane++) {
+                const double* u = ws.search[lane].ask();
+                double alpha = logistic(u[0]), beta = logistic(u[1]), gamma = logistic(u[2]);
+                if (ws.state[lane] == LANE_EMPTY) alpha = beta = gamma = 0.5;
+                ws.alpha[lane] = (float)alpha;
+                ws.k_base[lane] = (float)(alpha * (1.0 + beta));
+                ws.k_trend[lane] = (float)(alpha * beta);
+                ws.k_season[lane] = (float)(config.season == HW_ADDITIVE ? gamma * (1.0 - alpha) : gamma);
+            }
+            if (config.season == HW_ADDITIVE) recursions<true>(ws, length);
+            else recursions<false>(ws, length);
+
+            for (int lane = 0; lane < HW_GROUP; lane++) {
+                if (ws.state[lane] == LANE_FINAL) {
+                    // This pass ran at the best point: its end states are the model
+                    harvestLane(ws, lane, length, models[ws.series[lane]]);
+                    ws.state[lane] = LANE_EMPTY;
+                    busy--;
+                    if (next < end) {
+                        loadLane(ws, lane, series, next++, length);
+                        busy++;
+                    }
+                } else if (ws.state[lane] == LANE_SEARCH) {
+                    ws.search[lane].tell(ws.sse[lane]);
+                    if (ws.search[lane].converged()) ws.state[lane] = LANE_FINAL;
+                }
+            }
+        }
+    }
+
+public:
+    explicit HoltWinters(const HoltWintersConfig& c = defaultHoltWintersConfig()) : config(c) {
+        if (c.period < 2 || c.init_periods < 2 || c.max_evaluations < 4 || !(c.tolerance >= 0.0)) {
+            throw std::invalid_argument("HoltWinters: period >= 2, init_periods >= 2, max_evaluations >= 4");
+        }
+    }
+
+    const HoltWintersConfig& settings() const { return config; }
+
+    // Fit count series of `length` samples (row-major float or double). Each
+    // model depends only on its own series, not on the thread count.
+    template <typename T>
+    void fitBatch(ThreadPool& pool, const T* series, size_t count, size_t length,
+                  std::vector<HoltWintersModel>& models) const {
+        if (length < 2 * (size_t)config.period) {
+            throw std::invalid_argument("HoltWinters::fitBatch: series must cover at least two periods");
+        }
+        models.resize(count);
+        std::vector<Workspace> workspaces(pool.size());
+        pool.parallelFor(count, 4 * HW_GROUP, [&](size_t begin, size_t end, size_t worker) {
+            fitRange(series, begin, end, length, workspaces[worker], models);
+        });
+    }
+
+    // Fit one series on the calling thread (callers already running on a
+    // pool worker, e.g. per-site backtests)
+    template <typename T>
+    void fit(const T* series, size_t length, HoltWintersModel& model) const {
+        if (length < 2 * (size_t)config.period) {
+            throw std::invalid_argument("HoltWinters::fit: series must cover at least two periods");
+        }
+        Workspace ws;
+        std::vector<HoltWintersModel> models(1);
+        fitRange(series, 0, 1, length, ws, models);
+        model = models[0];
+    }
+
+    // Advance a fitted model over n further samples at its fitted smoothing
+    // parameters; one-step errors are added to model.sse
+    template <typename T>
+    void update(HoltWintersModel& model, const T* y, size_t n) const {
+        const double k_base = model.alpha * (1.0 + model.beta), k_trend = model.alpha * model.beta;
+        const double k_season = config.season == HW_ADDITIVE ? model.gamma * (1.0 - model.alpha) : model.gamma;
+        const double floor = HW_SEASON_FLOOR;
+        const size_t m = model.seasonal.size();
+        // Same recursion as the fitting kernels, in double on the model state
+        double base = model.level + model.trend, trend = model.trend;
+        for (size_t t = 0; t < n; t++) {
+            double yt = (double)y[t], s = model.seasonal[0], d, next;
+            if (config.season == HW_ADDITIVE) {
+                d = yt - s - base;
+                model.sse += d * d;
+                next = s + k_season * d;
+            } else {
+                d = yt / s - base;
+                model.sse += (d * s) * (d * s);
+                double level = std::max(floor, base + model.alpha * d);
+                next = std::max(floor, s + k_season * (yt / level - s));
+            }
+            base += trend + k_base * d;
+            trend += k_trend * d;
+            for (size_t k = 1; k < m; k++) model.seasonal[k - 1] = model.seasonal[k];
+            model.seasonal[m - 1] = next;
+        }
+        model.trend = trend;
+        model.level = base - trend;
+    }
+
+    // h = 1..horizon steps past the end of the fitted series
+    void forecast(const HoltWintersModel& model, int horizon, double* out) const {
+        int m = (int)model.seasonal.size();
+        for (int h = 1; h <= horizon; h++) {
+            double base = model.level + h * model.trend, s = model.seasonal[(h - 1) % m];
+            out[h - 1] = config.season == HW_ADDITIVE ? base + s : base * s;
+        }
+    }
+};
+
+#endif
@@ -0,0 +1,308 @@
+/**
+ * Kalman Nowcaster
+ * Streaming state-space nowcast of capacity factors between hourly forecasts
+ *
+ * Per site, a local level plus HARMONICS trigonometric seasonal pairs:
+ *
+ *   y_t = level_t + sum_j g_j,t + eps_t                 eps ~ N(0, R)
+ *   level_t+1 = level_t + eta                           eta ~ N(0, q_level)
+ *   [g_j; g*_j]_t+1 = rot(2 pi j / period) [g_j; g*_j]_t + omega   omega ~ N(0, q_season I)
+ *
+ * Every tick runs one predict + update per site in constant time. The state
+ * dimension 1 + 2 HARMONICS is a template parameter, so the small-matrix work
+ * (rotating P by the block-diagonal transition, the rank-one update) is
+ * fully unrolled. The observation vector selects the level and the cosine of
+ * each pair, and the transition only rotates within pairs, so neither is
+ * stored as a matrix.
+ *
+ * Sites are stored in blocks of NOWCAST_LANES, one site per SIMD lane, with
+ * the packed upper triangle of P laid out [block][element][lane]. A NaN
+ * sample is treated as missing: the site is predicted but not updated.
+ */
+
+#ifndef KALMAN_NOWCAST_H
+#define KALMAN_NOWCAST_H
+
+#include <vector>
+#include <cmath>
+#include <cstddef>
+#include <limits>
+#include <stdexcept>
+#include <algorithm>
+
+#include "aligned_buffer.h"
+#include "thread_pool.h"
+
+#if defined(__AVX2__) && defined(__FMA__)
+#include <immintrin.h>
+#define KALMAN_NOWCAST_AVX2 1
+#endif
+
+const int NOWCAST_LANES = 4;
+const int NOWCAST_MAX_HARMONICS = 6;
+
+struct NowcastConfig {
+    double period;                              // samples per seasonal cycle (ticks per day)
+    double observation_variance;                // R
+    double level_variance;                      // q_level per tick
+    double season_variance;                     // q_season per tick, per seasonal state
+    double initial_level, initial_variance;     // prior on every site's level; seasonal states start at 0
+    double z;                                   // band half-width in standard deviations
+    double lower, upper;                        // clamp of estimates and bands (capacity factors: 0, 1)
+};
+
+inline NowcastConfig defaultNowcastConfig() {
+    // Hourly ticks; 90% bands
+    NowcastConfig c = { 24.0, 0.003, 1e-4, 1e-5, 0.5, 1.0, 1.645, -std::numeric_limits<double>::infinity(),
+                        std::numeric_limits<double>::infinity() };
+    return c;
+}
+
+// Capacity factors sampled every tick_seconds: one seasonal cycle per day,
+// the hourly process noise of the defaults spread over the ticks of an hour
+inline NowcastConfig capacityNowcastConfig(double tick_seconds, double observation_variance) {
+    NowcastConfig c = defaultNowcastConfig();
+    double per_hour = tick_seconds / 3600.0;
+    c.period = 86400.0 / tick_seconds;
+    c.observation_variance = observation_variance;
+    c.level_variance *= per_hour;
+    c.season_variance *= per_hour;
+    c.lower = 0.0;
+    c.upper = 1.0;
+    return c;
+}
+
+// Published every tick, one entry per site
+struct NowcastFrame {
+    std::vector<double> estimate;               // filtered level + seasonal
+    std::vector<double> lower, upper;           // estimate -/+ z sd of the filtered signal
+    std::vector<double> innovation;             // sample - one-step prediction (0 if missing)
+    std::vector<double> innovation_sd;          // sd of the one-step prediction of the sample
+
+    void resize(size_t sites) {
+        estimate.resize(sites);
+        lower.resize(sites);
+        upper.resize(sites);
+        innovation.resize(sites);
+        innovation_sd.resize(sites);
+    }
+};
+
+// NOWCAST_LANES doubles with the few operations the filter needs
+struct NowcastVec {
+#ifdef KALMAN_NOWCAST_AVX2
+    __m256d v;
+
+    static NowcastVec broadcast(double a) { NowcastVec r; r.v = _mm256_set1_pd(a); return r; }
+    static NowcastVec load(const double* p) { NowcastVec r; r.v = _mm256_load_pd(p); return r; }
+    void store(double* p) const { _mm256_store_pd(p, v); }
+    friend NowcastVec operator+(NowcastVec a, NowcastVec b) { a.v = _mm256_add_pd(a.v, b.v); return a; }
+    friend NowcastVec operator-(NowcastVec a, NowcastVec b) { a.v = _mm256_sub_pd(a.v, b.v); return a; }
+    friend NowcastVec operator*(NowcastVec a, NowcastVec b) { a.v = _mm256_mul_pd(a.v, b.v); return a; }
+    // a * b + c, a * b - c, c - a * b
+    static NowcastVec fma(NowcastVec a, NowcastVec b, NowcastVec c) {
+        a.v = _mm256_fmadd_pd(a.v, b.v, c.v);
+        return a;
+    }
+    static NowcastVec fms(NowcastVec a, NowcastVec b, NowcastVec c) {
+        a.v = _mm256_fmsub_pd(a.v, b.v, c.v);
+        return a;
+    }
+    static NowcastVec fnma(NowcastVec a, NowcastVec b, NowcastVec c) {
+        a.v = _mm256_fnmadd_pd(a.v, b.v, c.v);
+        return a;
+    }
+    // Lanes holding a number (not NaN) take `a`, the others 0
+    static NowcastVec ifNumber(NowcastVec test, NowcastVec a) {
+        a.v = _mm256_and_pd(a.v, _mm256_cmp_pd(test.v, test.v, _CMP_ORD_Q));
+        return a;
+    }
+    static NowcastVec reciprocal(NowcastVec a) { a.v = _mm256_div_pd(_mm256_set1_pd(1.0), a.v); return a; }
+#else
+    double v[NOWCAST_LANES];
+
+    static NowcastVec broadcast(double a) {
+        NowcastVec r;
+        std::fill(r.v, r.v + NOWCAST_LANES, a);
+        return r;
+    }
+    static NowcastVec load(const double* p) { NowcastVec r; std::copy(p, p + NOWCAST_LANES, r.v); return r; }
+    void store(double* p) const { std::copy(v, v + NOWCAST_LANES, p); }
+    friend NowcastVec operator+(NowcastVec a, NowcastVec b) {
+        for (int l = 0; l < NOWCAST_LANES; l++) a.v[l] += b.v[l];
+        return a;
+    }
+    friend NowcastVec operator-(NowcastVec a, NowcastVec b) {
+        for (int l = 0; l < NOWCAST_LANES; l++) a.v[l] -= b.v[l];
+        return a;
+    }
+    friend NowcastVec operator*(NowcastVec a, NowcastVec b) {
+        for (int l = 0; l < NOWCAST_LANES; l++) a.v[l] *= b.v[l];
+        return a;
+    }
+    static NowcastVec fma(NowcastVec a, NowcastVec b, NowcastVec c) { return a * b + c; }
+    static NowcastVec fms(NowcastVec a, NowcastVec b, NowcastVec c) { return a * b - c; }
+    static NowcastVec fnma(NowcastVec a, NowcastVec b, NowcastVec c) { return c - a * b; }
+    static NowcastVec ifNumber(NowcastVec test, NowcastVec a) {
+        for (int l = 0; l < NOWCAST_LANES; l++) a.v[l] = test.v[l] == test.v[l] ? a.v[l] : 0.0;
+        return a;
+    }
+    static NowcastVec reciprocal(NowcastVec a) {
+        for (int l = 0; l < NOWCAST_LANES; l++) a.v[l] = 1.0 / a.v[l];
+        return a;
+    }
+#endif
+};
+
+template <int HARMONICS>
+class KalmanNowcaster {
+public:
+    static const int STATE = 1 + 2 * HARMONICS;
+    static const int PACKED = STATE * (STATE + 1) / 2;
+
+private:
+    NowcastConfig config;
+    size_t sites, blocks;
+    AlignedBuffer<double> x;                    // [block][STATE][lane]
+    AlignedBuffer<double> P;                    // [block][PACKED][lane], upper triangle by rows
+    double rot_cos[HARMONICS > 0 ? HARMONICS : 1], rot_sin[HARMONICS > 0 ? HARMONICS : 1];
+
+    static int packedIndex(int i, int j) { return i * STATE - i * (i - 1) / 2 + (j - i); }
+
+    // One tick for sites [NOWCAST_LANES * b, +NOWCAST_LANES); y holds the
+    // block's samples (NaN = missing); writes estimate, band variance,
+    // innovation and its variance per lane
+    void filterBlock(size_t b, const double* y, double* estimate, double* variance, double* innovation,
+                     double* innovation_var) {
+        typedef NowcastVec V;
+        double* xb = x.data() + b * STATE * NOWCAST_LANES;
+        double* Pb = P.data() + b * PACKED * NOWCAST_LANES;
+
+        V s[STATE], M[STATE][STATE];
+        for (int i = 0; i < STATE; i++) {
+            s[i] = V::load(xb + i * NOWCAST_LANES);
+            for (int j = i; j < STATE; j++) {
+                M[i][j] = V::load(Pb + packedIndex(i, j) * NOWCAST_LANES);
+                M[j][i] = M[i][j];
+            }
+        }
+
+        // Predict: rotate each seasonal pair in the state, the rows and the columns of P
+        for (int h = 0; h < HARMONICS; h++) {
+            const int a = 1 + 2 * h, c = a + 1;
+            const V cs = V::broadcast(rot_cos[h]), sn = V::broadcast(rot_sin[h]);
+            V sa = s[a], sc = s[c];
+            s[a] = V::fma(cs, sa, sn * sc);
+            s[c] = V::fms(cs, sc, sn * sa);
+            for (int k = 0; k < STATE; k++) {
+                V ra = M[a][k], rc = M[c][k];
+                M[a][k] = V::fma(cs, ra, sn * rc);
+                M[c][k] = V::fms(cs, rc, sn * ra);
+            }
+            for (int k = 0; k < STATE; k++) {
+                V ca = M[k][a], cc = M[k][c];
+                M[k][a] = V::fma(cs, ca, sn * cc);
+                M[k][c] = V::fms(cs, cc, sn * ca);
+            }
+        }
+        M[0][0] = M[0][0] + V::broadcast(config.level_variance);
+        for (int i = 1; i < STATE; i++) M[i][i] = M[i][i] + V::broadcast(config.season_variance);
+
+        // Innovation; PH = P H' sums the level column and every cosine column
+        V prediction = s[0], PH[STATE];
+        for (int h = 0; h < HARMONICS; h++) prediction = prediction + s[1 + 2 * h];
+        for (int i = 0; i < STATE; i++) {
+            PH[i] = M[i][0];
+            for (int h = 0; h < HARMONICS; h++) PH[i] = PH[i] + M[i][1 + 2 * h];
+        }
+        V signal_var = PH[0];
+        for (int h = 0; h < HARMONICS; h++) signal_var = signal_var + PH[1 + 2 * h];
+        V S = signal_var + V::broadcast(config.observation_variance);
+        V sample = V::load(y);
+        V v = V::ifNumber(sample, sample - prediction);
+        V gain = V::ifNumber(sample, V::reciprocal(S));
+
+        // Update: x += PH v / S, P -= PH PH' / S
+        V scaled = v * gain;
+        for (int i = 0; i < STATE; i++) {
+            (V::fma(PH[i], scaled, s[i])).store(xb + i * NOWCAST_LANES);
+            V row = PH[i] * gain;
+            for (int j = i; j < STATE; j++) {
+                V::fnma(row, PH[j], M[i][j]).store(Pb + packedIndex(i, j) * NOWCAST_LANES);
+            }
+        }
+
+        // H x and H P H' after the update, without another pass over P
+        V::fma(signal_var, scaled, prediction).store(estimate);
+        V::fnma(signal_var * gain, signal_var, signal_var).store(variance);
+        v.store(innovation);
+        S.store(innovation_var);
+    }
+
+    void filterRange(size_t begin, size_t end, const double* y, NowcastFrame& out) {
+        alignas(32) double sample[NOWCAST_LANES], estimate[NOWCAST_LANES], variance[NOWCAST_LANES];
+        alignas(32) double innovation[NOWCAST_LANES], innovation_var[NOWCAST_LANES];
+        for (size_t b = begin; b < end; b++) {
+            size_t first = b * NOWCAST_LANES, lanes = std::min((size_t)NOWCAST_LANES, sites - first);
+            for (size_t l = 0; l < NOWCAST_LANES; l++) {
+                sample[l] = l < lanes ? y[first + l] : std::numeric_limits<double>::quiet_NaN();
+            }
+            filterBlock(b, sample, estimate, variance, innovation, innovation_var);
+            for (size_t l = 0; l < lanes; l++) {
+                double band = config.z * std::sqrt(std::max(0.0, variance[l]));
+                out.estimate[first + l] = std::max(config.lower, std::min(config.upper, estimate[l]));
+                out.lower[first + l] = std::max(config.lower, std::min(config.upper, estimate[l] - band));
+                out.upper[first + l] = std::max(config.lower, std::min(config.upper, estimate[l] + band));
+                out.innovation[first + l] = innovation[l];
+                out.innovation_sd[first + l] = std::sqrt(innovation_var[l]);
+            }
+        }
+    }
+
+public:
+    KalmanNowcaster(size_t n_sites, const NowcastConfig& c = defaultNowcastConfig())
+        : config(c), sites(n_sites), blocks((n_sites + NOWCAST_LANES - 1) / NOWCAST_LANES) {
+        if (HARMONICS < 0 || HARMONICS > NOWCAST_MAX_HARMONICS || !(c.period > 2.0 * HARMONICS) ||
+            !(c.observation_variance > 0.0) || !(c.level_variance >= 0.0) || !(c.season_variance >= 0.0) ||
+            !(c.initial_variance > 0.0)) {
+            throw std::invalid_argument("KalmanNowcaster: HARMONICS <= NOWCAST_MAX_HARMONICS, period > 2 HARMONICS, "
+                                        "positive variances");
+        }
+        const double pi = 3.14159265358979323846;
+        for (int h = 0; h < HARMONICS; h++) {
+            rot_cos[h] = std::cos(2 * pi * (h + 1) / c.period);
+            rot_sin[h] = std::sin(2 * pi * (h + 1) / c.period);
+        }
+        x.resize(blocks * STATE * NOWCAST_LANES);
+        P.resize(blocks * PACKED * NOWCAST_LANES);
+        for (size_t s = 0; s < blocks * NOWCAST_LANES; s++) reset(s, c.initial_level);
+    }
+
+    const NowcastConfig& settings() const { return config; }
+    size_t siteCount() const { return sites; }
+
+    // Back to the prior (level given, seasonal states 0), e.g. after an outage
+    void reset(size_t site, double level) {
+        size_t b = site / NOWCAST_LANES, l = site % NOWCAST_LANES;
+        for (int i = 0; i < STATE; i++) {
+            x[(b * STATE + i) * NOWCAST_LANES + l] = i == 0 ? level : 0.0;
+            for (int j = i; j < STATE; j++) {
+                P[(b * PACKED + packedIndex(i, j)) * NOWCAST_LANES + l] =
+                    i == j ? config.initial_variance : 0.0;
+            }
+        }
+    }
+
+    // One tick: y[site] is the new sample (NaN if missing)
+    void update(const double* y, NowcastFrame& out) {
+        out.resize(sites);
+        filterRange(0, blocks, y, out);
+    }
+
+    void update(ThreadPool& pool, const double* y, NowcastFrame& out) {
+        out.resize(sites);
+        pool.parallelFor(blocks, 64, [&](size_t begin, size_t end, size_t) { filterRange(begin, end, y, out); });
+    }
+};
+
+#endif
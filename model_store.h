@@ -0,0 +1,291 @@
+/**
+ * Binary Model Store
+ * Versioned on-disk format for trained site models, loaded with mmap
+ * Lets a forecasting process start serving thousands of models in milliseconds
+ *
+ * Layout (native little-endian):
+ *   ModelStoreHeader                      64 bytes
+ *   ModelRecord[model_count]              sorted by (site_id, target)
+ * Records are fixed-size so lookups are a binary search over the mapping and
+ * coefficients are read in place without parsing or copying.
+ */
+
+#ifndef MODEL_STORE_H
+#define MODEL_STORE_H
+
+#include <vector>
+#include <string>
+#include <iostream>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <cstddef>
+#include <cstdint>
+#include <ctime>
+#include <algorithm>
+#include <stdexcept>
+
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+
+#include "energy_data.h"
+#include "beta_regression.h"
+
+const char MODEL_STORE_MAGIC[8] = { 'E', 'G', 'F', 'M', 'O', 'D', 'E', 'L' };
+const uint32_t MODEL_STORE_VERSION = 1;
+const uint32_t MODEL_STORE_MAX_FEATURES = 32;
+
+struct ModelStoreHeader {
+    char magic[8];
+    uint32_t version;
+    uint32_t header_size;
+    uint32_t record_size;
+    uint32_t model_count;
+    uint64_t created_at;
+    uint64_t checksum;           // FNV-1a over the record section
+    uint8_t reserved[24];
+};
+
+struct ModelRecord {
+    int32_t site_id;
+    int32_t target;
+    uint32_t n_features;
+    int32_t fourier_order;
+    double fourier_period;
+    double temperature_scale;
+    double wind_speed_scale;
+    double annual_period;
+    double phi;
+    double trained_at;
+    double coefficients[MODEL_STORE_MAX_FEATURES];
+};
+
+static_assert(sizeof(ModelStoreHeader) == 64, "ModelStoreHeader layout changed");
+static_assert(sizeof(ModelRecord) == 64 + 8 * MODEL_STORE_MAX_FEATURES, "ModelRecord layout changed");
+
+// In-memory form of one trained model, used when writing a store
+struct StoredModel {
+    int site_id;
+    int target;
+    FeatureSpec spec;
+    double phi;
+    double trained_at;
+    std::vector<double> coefficients;
+};
+
+inline uint64_t fnv1a(const void* data, size_t length) {
+    const unsigned char* bytes = static_cast<const unsigned char*>(data);
+    uint64_t hash = 1469598103934665603ULL;
+    for (size_t i = 0; i < length; i++) {
+        hash ^= bytes[i];
+        hash *= 1099511628211ULL;
+    }
+    return hash;
+}
+
+inline FeatureSpec recordFeatureSpec(const ModelRecord& record) {
+    FeatureSpec spec;
+    spec.fourier_order = record.fourier_order;
+    spec.fourier_period = record.fourier_period;
+    spec.temperature_scale = record.temperature_scale;
+    spec.wind_speed_scale = record.wind_speed_scale;
+    spec.annual_period = record.annual_period;
+    return spec;
+}
+
+// n_features fits the record and matches its feature spec; records in a
+// corrupt or truncated store (unchecked unless opened with verify) may not
+inline bool recordValid(const ModelRecord& record) {
+    const int max_order = ((int)MODEL_STORE_MAX_FEATURES - 6) / 2;
+    if (record.fourier_order < 0 || record.fourier_order > max_order) return false;
+    return record.n_features > 0 && record.n_features <= MODEL_STORE_MAX_FEATURES &&
+           record.n_features == featureCount(recordFeatureSpec(record));
+}
+
+// Rebuild a BetaRegression (for predict/predictQuantiles) from a stored record
+inline BetaRegression recordModel(const ModelRecord& record) {
+    if (!recordValid(record)) {
+        throw std::invalid_argument("recordModel: feature count does not match the record's spec");
+    }
+    BetaRegression model;
+    model.setParameters(std::vector<double>(record.coefficients,
+                                            record.coefficients + record.n_features),
+                        record.phi);
+    return model;
+}
+
+inline bool recordLess(const ModelRecord& a, const ModelRecord& b) {
+    return a.site_id != b.site_id ? a.site_id < b.site_id : a.target < b.target;
+}
+
+// Write models to path atomically and durably (unique temp file, fsync, rename)
+inline bool writeModelStore(const std::string& path, const std::vector<StoredModel>& models) {
+    std::vector<ModelRecord> records(models.size());
+    for (size_t i = 0; i < models.size(); i++) {
+        const StoredModel& m = models[i];
+        if (m.coefficients.size() > MODEL_STORE_MAX_FEATURES) {
+            std::cerr << "Error: Model for site " << m.site_id << " has "
+                      << m.coefficients.size() << " features (max "
+                      << MODEL_STORE_MAX_FEATURES << ")" << std::endl;
+            return false;
+        }
+        ModelRecord& r = records[i];
+        std::memset(&r, 0, sizeof(r));
+        r.site_id = m.site_id;
+        r.target = m.target;
+        r.n_features = (uint32_t)m.coefficients.size();
+        r.fourier_order = m.spec.fourier_order;
+        r.fourier_period = m.spec.fourier_period;
+        r.temperature_scale = m.spec.temperature_scale;
+        r.wind_speed_scale = m.spec.wind_speed_scale;
+        r.annual_period = m.spec.annual_period;
+        r.phi = m.phi;
+        r.trained_at = m.trained_at;
+        std::copy(m.coefficients.begin(), m.coefficients.end(), r.coefficients);
+    }
+    std::sort(records.begin(), records.end(), recordLess);
+
+    ModelStoreHeader header;
+    std::memset(&header, 0, sizeof(header));
+    std::memcpy(header.magic, MODEL_STORE_MAGIC, sizeof(header.magic));
+    header.version = MODEL_STORE_VERSION;
+    header.header_size = sizeof(ModelStoreHeader);
+    header.record_size = sizeof(ModelRecord);
+    header.model_count = (uint32_t)records.size();
+    header.created_at = (uint64_t)std::time(0);
+    header.checksum = records.empty() ? 0 : fnv1a(&records[0], records.size() * sizeof(ModelRecord));
+
+    // Unique temporary file beside the store, flushed to disk before it
+    // replaces the store, so concurrent writers cannot clobber each other's
+    // file and a crash leaves either the old or the new store
+    std::vector<char> tmp_path(path.begin(), path.end());
+    const char suffix[] = ".XXXXXX";
+    tmp_path.insert(tmp_path.end(), suffix, suffix + sizeof(suffix));
+    int fd = mkstemp(&tmp_path[0]);
+    FILE* file = fd >= 0 ? fdopen(fd, "wb") : 0;
+    if (!file) {
+        std::cerr << "Error: Cannot create temporary file for " << path << std::endl;
+        if (fd >= 0) {
+            ::close(fd);
+            std::remove(&tmp_path[0]);
+        }
+        return false;
+    }
+    bool ok = fchmod(fd, 0644) == 0;
+    ok = ok && std::fwrite(&header, sizeof(header), 1, file) == 1;
+    if (ok && !records.empty()) {
+        ok = std::fwrite(&records[0], sizeof(ModelRecord), records.size(), file) == records.size();
+    }
+    ok = ok && std::fflush(file) == 0 && fsync(fd) == 0;
+    ok = (std::fclose(file) == 0) && ok;
+    if (!ok || std::rename(&tmp_path[0], path.c_str()) != 0) {
+        std::cerr << "Error: Failed to write model store " << path << std::endl;
+        std::remove(&tmp_path[0]);
+        return false;
+    }
+
+    // Persist the rename itself
+    size_t slash = path.rfind('/');
+    std::string dir = slash == std::string::npos ? std::string(".") : path.substr(0, slash == 0 ? 1 : slash);
+    int dir_fd = ::open(dir.c_str(), O_RDONLY | O_DIRECTORY);
+    if (dir_fd < 0 || fsync(dir_fd) != 0) {
+        std::cerr << "Error: Cannot sync directory " << dir << " of model store " << path << std::endl;
+        if (dir_fd >= 0) ::close(dir_fd);
+        return false;
+    }
+    ::close(dir_fd);
+    return true;
+}
+
+class MappedModelStore {
+private:
+    void* base;
+    size_t length;
+    const ModelStoreHeader* header;
+    const ModelRecord* records;
+
+    MappedModelStore(const MappedModelStore&);
+    MappedModelStore& operator=(const MappedModelStore&);
+
+public:
+    MappedModelStore() : base(0), length(0), header(0), records(0) {}
+    ~MappedModelStore() { close(); }
+
+    // Map a store read-only; verify = true also checks the record checksum
+    bool open(const std::string& path, bool verify = false) {
+        close();
+        int fd = ::open(path.c_str(), O_RDONLY);
+        if (fd < 0) {
+            std::cerr << "Error: Cannot open file " << path << std::endl;
+            return false;
+        }
+        struct stat st;
+        if (fstat(fd, &st) != 0 || (size_t)st.st_size < sizeof(ModelStoreHeader)) {
+            std::cerr << "Error: Model store " << path << " is truncated" << std::endl;
+            ::close(fd);
+            return false;
+        }
+        void* mapped = mmap(0, st.st_size, PROT_READ, MAP_SHARED, fd, 0);
+        ::close(fd);
+        if (mapped == MAP_FAILED) {
+            std::cerr << "Error: Cannot map model store " << path << std::endl;
+            return false;
+        }
+
+        const ModelStoreHeader* h = static_cast<const ModelStoreHeader*>(mapped);
+        const char* problem = 0;
+        if (std::memcmp(h->magic, MODEL_STORE_MAGIC, sizeof(h->magic)) != 0) {
+            problem = "bad magic";
+        } else if (h->version != MODEL_STORE_VERSION) {
+            problem = "unsupported version";
+        } else if (h->header_size != sizeof(ModelStoreHeader) || h->record_size != sizeof(ModelRecord)) {
+            problem = "record layout mismatch";
+        } else if ((size_t)st.st_size < h->header_size + (size_t)h->model_count * h->record_size) {
+            problem = "truncated record section";
+        } else if (verify && h->model_count > 0 &&
+                   fnv1a(static_cast<const char*>(mapped) + h->header_size,
+                         (size_t)h->model_count * h->record_size) != h->checksum) {
+            problem = "checksum mismatch";
+        }
+        if (problem) {
+            std::cerr << "Error: Model store " << path << ": " << problem << std::endl;
+            munmap(mapped, st.st_size);
+            return false;
+        }
+
+        base = mapped;
+        length = st.st_size;
+        header = h;
+        records = reinterpret_cast<const ModelRecord*>(static_cast<const char*>(mapped) + h->header_size);
+        return true;
+    }
+
+    void close() {
+        if (base) munmap(base, length);
+        base = 0;
+        length = 0;
+        header = 0;
+        records = 0;
+    }
+
+    bool isOpen() const { return base != 0; }
+    size_t size() const { return header ? header->model_count : 0; }
+    uint64_t createdAt() const { return header ? header->created_at : 0; }
+    const ModelRecord& record(size_t i) const { return records[i]; }
+
+    // Binary search by (site_id, target); null when absent or invalid
+    const ModelRecord* find(int site_id, int target) const {
+        if (!header) return 0;
+        ModelRecord key;
+        key.site_id = site_id;
+        key.target = target;
+        const ModelRecord* end = records + header->model_count;
+        const ModelRecord* it = std::lower_bound(records, end, key, recordLess);
+        if (it == end || it->site_id != site_id || it->target != target) return 0;
+        return recordValid(*it) ? it : 0;
+    }
+};
+
+#endif
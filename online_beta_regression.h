@@ -0,0 +1,161 @@
+/**
+ * Online Beta Regression
+ * Incremental model updates over a bounded window of recent observations
+ * Warm-started Fisher-scoring refreshes plus constant-time streaming steps
+ */
+
+#ifndef ONLINE_BETA_REGRESSION_H
+#define ONLINE_BETA_REGRESSION_H
+
+#include <vector>
+#include <cmath>
+#include <cstring>
+#include <cstddef>
+#include <algorithm>
+#include <stdexcept>
+
+#include "beta_regression.h"
+
+class OnlineBetaRegression {
+private:
+    BetaRegression model;
+    size_t p;
+    size_t capacity;
+
+    // Sliding window stored contiguously: live rows are [head, head + count)
+    // inside a buffer of 2 * capacity rows, compacted when the tail is reached
+    std::vector<double> X_window;
+    std::vector<double> y_window;
+    size_t head, count;
+    size_t total_seen;
+    bool fitted;
+
+    // Streaming state: averaged per-observation information in (beta, log phi)
+    double stream_rate;
+    std::vector<double> avg_info, factor, direction, row_score, row_info, beta_step;
+
+    // Score and information of one observation at the current parameters
+    void observation(const double* x, double y, double* score, double* info) const {
+        const std::vector<double>& beta = model.getCoefficients();
+        double ph = model.getPhi();
+        size_t m = p + 1;
+
+        double e = 0.0;
+        for (size_t j = 0; j < p; j++) e += x[j] * beta[j];
+        double mu = std::min(1.0 - 1e-12, std::max(1e-12, 1.0 / (1.0 + std::exp(-e))));
+        double yi = std::min(1.0 - 1e-6, std::max(1e-6, y));
+        double a = mu * ph, b = (1.0 - mu) * ph;
+
+        BetaRowTerms t = betaRowTerms(mu, ph, std::log(yi), std::log1p(-yi),
+                                      digamma(a), digamma(b), trigamma(a), trigamma(b),
+                                      digamma(ph), trigamma(ph));
+        for (size_t j = 0; j < p; j++) {
+            score[j] = t.u_beta * x[j];
+            for (size_t k = 0; k <= j; k++) info[j * m + k] = t.w * x[j] * x[k];
+            info[p * m + j] = t.c * x[j];
+        }
+        score[p] = t.u_phi;
+        info[p * m + p] = t.d;
+    }
+
+    // Average information over the window, seeding the streaming updates
+    void rebuildInformation() {
+        size_t m = p + 1;
+        std::fill(avg_info.begin(), avg_info.end(), 0.0);
+        for (size_t i = 0; i < count; i++) {
+            size_t r = head + i;
+            observation(&X_window[r * p], y_window[r], &row_score[0], &row_info[0]);
+            for (size_t j = 0; j < m; j++) {
+                for (size_t k = 0; k <= j; k++) avg_info[j * m + k] += row_info[j * m + k];
+            }
+        }
+        for (size_t j = 0; j < m * m; j++) avg_info[j] /= std::max<size_t>(count, 1);
+    }
+
+public:
+    // window_rows bounds the refresh cost; rate = 0 uses 1 / window_rows
+    OnlineBetaRegression(size_t n_features, size_t window_rows, double rate = 0.0)
+        : p(n_features), capacity(window_rows), head(0), count(0), total_seen(0), fitted(false),
+          stream_rate(rate > 0.0 ? rate : 1.0 / window_rows) {
+        if (p == 0 || capacity == 0) {
+            throw std::invalid_argument("OnlineBetaRegression: empty feature set or window");
+        }
+        size_t m = p + 1;
+        X_window.resize(2 * capacity * p);
+        y_window.resize(2 * capacity);
+        avg_info.assign(m * m, 0.0);
+        factor.assign(m * m, 0.0);
+        direction.assign(m, 0.0);
+        row_score.assign(m, 0.0);
+        row_info.assign(m * m, 0.0);
+    }
+
+    // Add observations (row-major X, rows x p); the oldest rows fall out of the window
+    void append(const double* X, const double* y, size_t rows) {
+        for (size_t i = 0; i < rows; i++) {
+            if (head + count == 2 * capacity) {
+                std::memmove(&X_window[0], &X_window[head * p], count * p * sizeof(double));
+                std::memmove(&y_window[0], &y_window[head], count * sizeof(double));
+                head = 0;
+            }
+            size_t r = head + count;
+            std::memcpy(&X_window[r * p], X + i * p, p * sizeof(double));
+            y_window[r] = y[i];
+            if (count == capacity) head++;
+            else count++;
+        }
+        total_seen += rows;
+    }
+
+    // Refit on the window: a full fit the first time, then at most max_steps
+    // warm-started Fisher-scoring iterations from the current coefficients
+    bool refresh(int max_steps = 3) {
+        if (count == 0) return false;
+        int saved = model.getMaxIterations();
+        if (fitted) model.setMaxIterations(max_steps);
+        model.fit(&X_window[head * p], &y_window[head], count, p, fitted);
+        model.setMaxIterations(saved);
+        fitted = true;
+        rebuildInformation();
+        return model.hasConverged();
+    }
+
+    // One natural-gradient step on a new observation, O(p^3) regardless of
+    // history: theta += rate * avg_info^{-1} * score, with avg_info tracked
+    // as an exponentially weighted average of per-observation information
+    void streamingUpdate(const double* x, double y) {
+        append(x, &y, 1);
+        if (!fitted) return;
+
+        size_t m = p + 1;
+        observation(x, y, &row_score[0], &row_info[0]);
+        for (size_t j = 0; j < m; j++) {
+            for (size_t k = 0; k <= j; k++) {
+                avg_info[j * m + k] = (1.0 - stream_rate) * avg_info[j * m + k]
+                                    + stream_rate * row_info[j * m + k];
+            }
+        }
+
+        for (size_t j = 0; j < m; j++) {
+            for (size_t k = 0; k <= j; k++) {
+                factor[j * m + k] = avg_info[j * m + k];
+                factor[k * m + j] = avg_info[j * m + k];
+            }
+        }
+        if (!choleskyDecompose(factor, m)) return;
+        direction = row_score;
+        choleskySolve(factor, m, direction);
+
+        beta_step = model.getCoefficients();
+        for (size_t j = 0; j < p; j++) beta_step[j] += stream_rate * direction[j];
+        double phi = model.getPhi() * std::exp(stream_rate * direction[p]);
+        model.setParameters(beta_step, phi);
+    }
+
+    const BetaRegression& getModel() const { return model; }
+    size_t windowRows() const { return count; }
+    size_t totalObservations() const { return total_seen; }
+    bool isFitted() const { return fitted; }
+};
+
+#endif
@@ -0,0 +1,315 @@
+/**
+ * Quantile Regression
+ * Frisch-Newton interior-point solver for the linear quantile regression LP
+ * Fits several quantile levels (e.g. P10/P50/P90) together in O(n * p) memory
+ *
+ * For each level tau the dual problem
+ *     max y'a  s.t.  X'a = (1 - tau) X'1,  0 <= a <= 1
+ * is solved with Mehrotra predictor-corrector steps. Every step needs only the
+ * p x p normal matrix X' Q X (Q diagonal), so no n x n matrix is ever formed.
+ * The least-squares starting point is shared by all levels, each iteration
+ * accumulates the normal matrices of all levels in a single pass over X, and
+ * the predictor's Cholesky factor is reused by the corrector.
+ */
+
+#ifndef QUANTILE_REGRESSION_H
+#define QUANTILE_REGRESSION_H
+
+#include <vector>
+#include <cmath>
+#include <cstddef>
+#include <algorithm>
+#include <stdexcept>
+
+#include "weighted_gram.h"
+
+class QuantileRegression {
+private:
+    // Per-level interior-point state: primal x (= a) and s = 1 - x, dual y
+    // (= -beta) and slacks z, w with X y + z - w = -response
+    struct Level {
+        double tau;
+        std::vector<double> x, s, z, w;
+        std::vector<double> y;
+        std::vector<double> q, g;          // step weights and dual residual per row
+        std::vector<double> gram, rhs, dy;
+        std::vector<double> coefficients;
+        double check_loss;
+        int iterations;
+        bool converged;
+    };
+
+    std::vector<Level> levels;
+    size_t p;
+    int max_iterations;
+    double tolerance;
+    std::vector<double> dx, dz, dw, dx_aff, dz_aff, dw_aff, weighted;
+    WeightedGram gram_kernel;
+    ThreadPool* gram_pool;
+    std::vector<double> gram_scratch;
+
+    static double dot(const double* a, const double* b, size_t m) {
+        double s = 0.0;
+        for (size_t j = 0; j < m; j++) s += a[j] * b[j];
+        return s;
+    }
+
+    // Largest step in (0, 1] keeping v + step * dv strictly positive
+    static double stepLength(const std::vector<double>& v, const std::vector<double>& dv, double limit) {
+        double step = 1e20;
+        for (size_t i = 0; i < v.size(); i++) {
+            if (dv[i] < 0.0) step = std::min(step, -v[i] / dv[i]);
+        }
+        return std::min(limit, 0.99995 * step);
+    }
+
+    // Refresh q and g (= -response - X y) and weighted = q * g for rows [begin, end)
+    void refreshRows(const double* X, const double* response, Level& L, size_t begin, size_t end) {
+        for (size_t i = begin; i < end; i++) {
+            L.q[i] = 1.0 / (L.z[i] / L.x[i] + L.w[i] / L.s[i]);
+            L.g[i] = -response[i] - dot(X + i * p, &L.y[0], p);
+            weighted[i] = L.q[i] * L.g[i];
+        }
+    }
+
+    // One pass over X: normal matrix X' Q X and right-hand side X' Q g for
+    // every active level, with q and g refreshed per row. Each tile of X is
+    // loaded once and shared by all levels; with a pool and a long history
+    // each level instead takes its own pass split across the workers.
+    void accumulateNormal(const double* X, const double* response, size_t n) {
+        for (size_t l = 0; l < levels.size(); l++) {
+            if (levels[l].converged) continue;
+            std::fill(levels[l].gram.begin(), levels[l].gram.end(), 0.0);
+            std::fill(levels[l].rhs.begin(), levels[l].rhs.end(), 0.0);
+        }
+        if (splitsWeightedGram(gram_pool, n)) {
+            for (size_t l = 0; l < levels.size(); l++) {
+                Level& L = levels[l];
+                if (L.converged) continue;
+                gram_pool->parallelFor(n, PARALLEL_GRAM_CHUNK_ROWS, [&](size_t begin, size_t end, size_t) {
+                    refreshRows(X, response, L, begin, end);
+                });
+                const double* qg = &weighted[0];
+                accumulateWeightedGram(gram_pool, gram_kernel, X, n, &L.q[0], &qg, 1, &L.gram[0], p, &L.rhs[0],
+                                       gram_scratch);
+            }
+            return;
+        }
+        size_t tile = gram_kernel.tileRows();
+        for (size_t start = 0; start < n; start += tile) {
+            size_t len = std::min(tile, n - start);
+            gram_kernel.loadTile(X + start * p, len);
+            for (size_t l = 0; l < levels.size(); l++) {
+                Level& L = levels[l];
+                if (L.converged) continue;
+                refreshRows(X, response, L, start, start + len);
+                const double* qg = &weighted[start];
+                gram_kernel.accumulateTile(&L.q[start], &qg, 1, &L.gram[0], p, &L.rhs[0]);
+            }
+        }
+    }
+
+    // X' (q * v) for one level
+    void weightedProduct(const double* X, size_t n, const Level& L,
+                         const std::vector<double>& v, std::vector<double>& out) {
+        for (size_t i = 0; i < n; i++) weighted[i] = L.q[i] * v[i];
+        const double* qv = &weighted[0];
+        std::fill(out.begin(), out.end(), 0.0);
+        accumulateWeightedGram(gram_pool, gram_kernel, X, n, 0, &qv, 1, 0, p, &out[0], gram_scratch);
+    }
+
+    void finishLevel(const double* X, const double* response, size_t n, Level& L) {
+        L.coefficients.resize(p);
+        for (size_t j = 0; j < p; j++) L.coefficients[j] = -L.y[j];
+        double loss = 0.0;
+        for (size_t i = 0; i < n; i++) {
+            double r = response[i] - dot(X + i * p, &L.coefficients[0], p);
+            loss += r >= 0.0 ? L.tau * r : (L.tau - 1.0) * r;
+        }
+        L.check_loss = loss;
+    }
+
+    // Predictor-corrector iteration for one level; returns the duality gap
+    double step(const double* X, size_t n, Level& L) {
+        choleskyDecomposeRegularized(&L.gram[0], p);
+
+        // Affine-scaling (predictor) direction
+        L.dy = L.rhs;
+        choleskySolve(L.gram, p, L.dy);
+        for (size_t i = 0; i < n; i++) {
+            dx_aff[i] = L.q[i] * (dot(X + i * p, &L.dy[0], p) - L.g[i]);
+            dz_aff[i] = -L.z[i] - L.z[i] * dx_aff[i] / L.x[i];
+            dw_aff[i] = -L.w[i] + L.w[i] * dx_aff[i] / L.s[i];
+        }
+        for (size_t i = 0; i < n; i++) dx[i] = -dx_aff[i];
+        double primal = std::min(stepLength(L.x, dx_aff, 1.0), stepLength(L.s, dx, 1.0));
+        double dual = std::min(stepLength(L.z, dz_aff, 1.0), stepLength(L.w, dw_aff, 1.0));
+
+        // Centering from the predicted complementarity (Mehrotra)
+        double mu = 0.0, mu_aff = 0.0;
+        for (size_t i = 0; i < n; i++) {
+            mu += L.x[i] * L.z[i] + L.s[i] * L.w[i];
+            mu_aff += (L.x[i] + primal * dx_aff[i]) * (L.z[i] + dual * dz_aff[i])
+                    + (L.s[i] - primal * dx_aff[i]) * (L.w[i] + dual * dw_aff[i]);
+        }
+        double sigma_mu = (primal < 1.0 || dual < 1.0)
+            ? mu / (2.0 * n) * std::pow(mu_aff / mu, 3.0) : 0.0;
+
+        // Corrector: same factor, second-order and centering terms added to g
+        for (size_t i = 0; i < n; i++) {
+            double r_xz = sigma_mu - L.x[i] * L.z[i] - dx_aff[i] * dz_aff[i];
+            double r_sw = sigma_mu - L.s[i] * L.w[i] + dx_aff[i] * dw_aff[i];
+            double r_dual = L.g[i] - L.z[i] + L.w[i];
+            dz[i] = r_xz;
+            dw[i] = r_sw;
+            dx[i] = r_dual - r_xz / L.x[i] + r_sw / L.s[i];
+        }
+        weightedProduct(X, n, L, dx, L.dy);
+        choleskySolve(L.gram, p, L.dy);
+        for (size_t i = 0; i < n; i++) {
+            double r_xz = dz[i], r_sw = dw[i];
+            double step_x = L.q[i] * (dot(X + i * p, &L.dy[0], p) - dx[i]);
+            dx[i] = step_x;
+            dz[i] = (r_xz - L.z[i] * step_x) / L.x[i];
+            dw[i] = (r_sw + L.w[i] * step_x) / L.s[i];
+        }
+        for (size_t i = 0; i < n; i++) dx_aff[i] = -dx[i];
+        primal = std::min(stepLength(L.x, dx, 1.0), stepLength(L.s, dx_aff, 1.0));
+        dual = std::min(stepLength(L.z, dz, 1.0), stepLength(L.w, dw, 1.0));
+
+        double gap = 0.0;
+        for (size_t i = 0; i < n; i++) {
+            L.x[i] += primal * dx[i];
+            L.s[i] -= primal * dx[i];
+            L.z[i] += dual * dz[i];
+            L.w[i] += dual * dw[i];
+            gap += L.x[i] * L.z[i] + L.s[i] * L.w[i];
+        }
+        for (size_t j = 0; j < p; j++) L.y[j] += dual * L.dy[j];
+        return gap;
+    }
+
+public:
+    QuantileRegression(int max_iter = 50, double tol = 1e-9)
+        : p(0), max_iterations(max_iter), tolerance(tol), gram_pool(0) {}
+
+    // Split the passes over X of long fits across pool (null = single thread)
+    void setThreadPool(ThreadPool* pool) { gram_pool = pool; }
+
+    // Fit all levels in taus (each in (0, 1)) on row-major X (n x n_features).
+    // Levels are stored in ascending order. Returns true if every level converged.
+    bool fit(const double* X, const double* response, size_t n, size_t n_features,
+             const double* taus, size_t n_levels) {
+        if (n == 0 || n_features == 0 || n_levels == 0) {
+            throw std::invalid_argument("QuantileRegression: empty data or level set");
+        }
+        p = n_features;
+        std::vector<double> sorted(taus, taus + n_levels);
+        std::sort(sorted.begin(), sorted.end());
+        for (size_t l = 0; l < n_levels; l++) {
+            if (!(sorted[l] > 0.0 && sorted[l] < 1.0)) {
+                throw std::invalid_argument("QuantileRegression: levels must lie in (0, 1)");
+            }
+        }
+
+        // Least-squares start, shared by every level
+        gram_kernel.reset(p);
+        std::vector<double> gram(p * p, 0.0), y0(p, 0.0);
+        accumulateWeightedGram(gram_pool, gram_kernel, X, n, 0, &response, 1, &gram[0], p, &y0[0], gram_scratch);
+        for (size_t j = 0; j < p; j++) y0[j] = -y0[j];
+        choleskyDecomposeRegularized(&gram[0], p);
+        choleskySolve(gram, p, y0);
+
+        std::vector<double> resid(n);
+        double scale = 0.0;
+        for (size_t i = 0; i < n; i++) {
+            resid[i] = -response[i] - dot(X + i * p, &y0[0], p);
+            scale += std::fabs(resid[i]);
+        }
+        double offset = std::max(scale / n, 1e-8);
+
+        levels.assign(n_levels, Level());
+        for (size_t l = 0; l < n_levels; l++) {
+            Level& L = levels[l];
+            L.tau = sorted[l];
+            L.x.assign(n, 1.0 - L.tau);
+            L.s.assign(n, L.tau);
+            L.z.resize(n);
+            L.w.resize(n);
+            for (size_t i = 0; i < n; i++) {
+                L.z[i] = std::max(resid[i], 0.0) + offset;
+                L.w[i] = std::max(-resid[i], 0.0) + offset;
+            }
+            L.y = y0;
+            L.q.resize(n);
+            L.g.resize(n);
+            L.gram.resize(p * p);
+            L.rhs.resize(p);
+            L.dy.resize(p);
+            L.iterations = 0;
+            L.converged = false;
+        }
+        dx.resize(n);
+        dz.resize(n);
+        dw.resize(n);
+        dx_aff.resize(n);
+        dz_aff.resize(n);
+        dw_aff.resize(n);
+        weighted.resize(n);
+
+        size_t active = n_levels;
+        for (int iter = 0; iter < max_iterations && active > 0; iter++) {
+            accumulateNormal(X, response, n);
+            for (size_t l = 0; l < n_levels; l++) {
+                Level& L = levels[l];
+                if (L.converged) continue;
+                double gap = step(X, n, L);
+                L.iterations++;
+                double objective = 0.0;
+                for (size_t i = 0; i < n; i++) objective -= response[i] * L.x[i];
+                if (gap <= tolerance * (1.0 + std::fabs(objective))) {
+                    L.converged = true;
+                    active--;
+                }
+            }
+        }
+
+        bool all_converged = true;
+        for (size_t l = 0; l < n_levels; l++) {
+            finishLevel(X, response, n, levels[l]);
+            all_converged = all_converged && levels[l].converged;
+        }
+        return all_converged;
+    }
+
+    bool fit(const std::vector<double>& X, const std::vector<double>& response,
+             size_t n_features, const std::vector<double>& taus) {
+        return fit(&X[0], &response[0], response.size(), n_features, &taus[0], taus.size());
+    }
+
+    // Quantiles for n rows into out (n x levels, ascending). Each row is sorted
+    // so bands never cross, which can otherwise happen away from the data.
+    void predict(const double* X, size_t n, double* out) const {
+        size_t k = levels.size();
+        for (size_t i = 0; i < n; i++) {
+            double* dst = out + i * k;
+            for (size_t l = 0; l < k; l++) dst[l] = dot(X + i * p, &levels[l].coefficients[0], p);
+            std::sort(dst, dst + k);
+        }
+    }
+
+    std::vector<double> predict(const std::vector<double>& X) const {
+        std::vector<double> out(X.size() / p * levels.size());
+        predict(&X[0], X.size() / p, &out[0]);
+        return out;
+    }
+
+    size_t levelCount() const { return levels.size(); }
+    double getLevel(size_t l) const { return levels[l].tau; }
+    const std::vector<double>& getCoefficients(size_t l) const { return levels[l].coefficients; }
+    double getCheckLoss(size_t l) const { return levels[l].check_loss; }
+    int getIterations(size_t l) const { return levels[l].iterations; }
+    bool hasConverged(size_t l) const { return levels[l].converged; }
+};
+
+#endif
@@ -9,12 +9,20 @@ const cors = require('cors');
 const { spawn } = require('child_process');
 const fs = require('fs').promises;
 const path = require('path');
+const ForecastClient = require('./forecast_client');
 
 const app = express();
 const PORT = process.env.PORT || 3000;
 
+// Bulk recommendation bodies (columnar JSON or packed float64 columns) are
+// far larger than the default JSON limit; parse them before the global parser
+const BATCH_BODY_LIMIT = '128mb';
+
 // Middleware
 app.use(cors());
+app.use('/api/grid/recommend/batch',
+  express.json({ limit: BATCH_BODY_LIMIT }),
+  express.raw({ type: 'application/octet-stream', limit: BATCH_BODY_LIMIT }));
 app.use(express.json());
 app.use(express.static('public'));
 
@@ -28,12 +36,38 @@ let currentGridState = {
   lastUpdated: new Date().toISOString()
 };
 
+// Native forecast daemon (see forecast_daemon.cpp); Python is the fallback
+const forecastClient = new ForecastClient(process.env.FORECAST_SOCKET || '/tmp/energy_forecast.sock');
+
+// In-process native engine (see energy_addon.cpp), used first when built
+let energyAddon = null;
+let nativeEngine = null;
+let nativeEngineReady = null;
+try {
+  energyAddon = require('./energy_addon.node');
+  nativeEngine = new energyAddon.ForecastEngine();
+  nativeEngineReady = (process.env.FORECAST_MODELS
+    ? nativeEngine.loadStore(process.env.FORECAST_MODELS)
+    : nativeEngine.train(0, 90)
+  ).catch((error) => {
+    console.warn(`Native forecast engine unavailable (${error.message})`);
+    nativeEngine = null;
+  });
+} catch (error) {
+  // Addon not built; forecasts go to the daemon
+}
+
 let forecastCache = {
   data: null,
   timestamp: null,
-  ttl: 300000 // 5 minutes
+  lastRequest: null, // last time getForecast() served a caller
+  ttl: 300000, // 5 minutes
+  refreshAhead: 0.8 // refresh hot forecasts at 80% of the TTL
 };
 
+// In-flight refresh shared by every request that needs one (single-flight)
+let forecastRefresh = null;
+
 // Utility: Run Python script
 async function runPythonScript(scriptPath, args = []) {
   return new Promise((resolve, reject) => {
@@ -59,6 +93,74 @@ async function runPythonScript(scriptPath, args = []) {
   });
 }
 
+// Utility: Day of year (1-366) as used by the forecasting models
+function dayOfYear(date) {
+  const start = new Date(date.getFullYear(), 0, 0);
+  return Math.floor((date - start) / 86400000);
+}
+
+// Utility: Produce a fresh 24-hour forecast
+async function generateForecast() {
+  const now = new Date();
+  if (nativeEngine) {
+    await nativeEngineReady;
+    if (nativeEngine) return JSON.parse(await nativeEngine.forecastJson(0, now.getHours(), dayOfYear(now)));
+  }
+  try {
+    return await forecastClient.forecast(0, now.getHours(), dayOfYear(now));
+  } catch (error) {
+    console.warn(`Forecast daemon unavailable (${error.message}), falling back to Python`);
+  }
+
+  const scriptPath = path.join(__dirname, 'beta_regression.py');
+  await runPythonScript(scriptPath);
+  const forecastPath = path.join(__dirname, 'forecast_output.json');
+  const forecastData = await fs.readFile(forecastPath, 'utf8');
+  return JSON.parse(forecastData);
+}
+
+// Utility: Refresh the cached forecast, coalescing concurrent callers
+function refreshForecast() {
+  if (!forecastRefresh) {
+    forecastRefresh = generateForecast()
+      .then((forecast) => {
+        forecastCache.data = forecast;
+        forecastCache.timestamp = Date.now();
+        return forecast;
+      })
+      .finally(() => {
+        forecastRefresh = null;
+      });
+  }
+  return forecastRefresh;
+}
+
+// Utility: Cached forecast, stale-while-revalidate. Expired data is returned
+// immediately while a refresh runs; only a cold cache waits for one.
+async function getForecast() {
+  forecastCache.lastRequest = Date.now();
+  if (!forecastCache.data) {
+    return { data: await refreshForecast(), cached: false };
+  }
+  const age = Date.now() - forecastCache.timestamp;
+  if (age >= forecastCache.ttl) {
+    refreshForecast().catch((error) => console.error('Forecast refresh error:', error.message));
+  }
+  return { data: forecastCache.data, cached: true, stale: age >= forecastCache.ttl };
+}
+
+// SSE responses subscribed to /api/stream/state
+const stateSubscribers = new Set();
+
+// Utility: Advance the grid once and send the same serialized event to every subscriber
+function broadcastGridState() {
+  generateRealtimeData();
+  const event = `data: ${JSON.stringify(currentGridState)}\n\n`;
+  for (const res of stateSubscribers) {
+    res.write(event);
+  }
+}
+
 // Utility: Generate synthetic real-time data
 function generateRealtimeData() {
   const hour = new Date().getHours();
@@ -135,35 +237,13 @@ app.post('/api/grid/state', (req, res) => {
 // Get 24-hour forecast
 app.get('/api/forecast/24h', async (req, res) => {
   try {
-    // Check cache
-    if (forecastCache.data && forecastCache.timestamp) {
-      const age = Date.now() - forecastCache.timestamp;
-      if (age < forecastCache.ttl) {
-        return res.json({
-          success: true,
-          cached: true,
-          data: forecastCache.data
-        });
-      }
-    }
-    
-    // Run Python forecasting script
-    const scriptPath = path.join(__dirname, 'beta_regression.py');
-    await runPythonScript(scriptPath);
-    
-    // Read forecast output
-    const forecastPath = path.join(__dirname, 'forecast_output.json');
-    const forecastData = await fs.readFile(forecastPath, 'utf8');
-    const forecast = JSON.parse(forecastData);
-    
-    // Update cache
-    forecastCache.data = forecast;
-    forecastCache.timestamp = Date.now();
+    const forecast = await getForecast();
     
     res.json({
       success: true,
-      cached: false,
-      data: forecast
+      cached: forecast.cached,
+      stale: Boolean(forecast.stale),
+      data: forecast.data
     });
   } catch (error) {
     console.error('Forecast error:', error);
@@ -189,16 +269,7 @@ app.get('/api/forecast/quantile/:metric', async (req, res) => {
     }
     
     // Get cached or fresh forecast
-    let forecast = forecastCache.data;
-    if (!forecast) {
-      const scriptPath = path.join(__dirname, 'beta_regression.py');
-      await runPythonScript(scriptPath);
-      const forecastPath = path.join(__dirname, 'forecast_output.json');
-      const forecastData = await fs.readFile(forecastPath, 'utf8');
-      forecast = JSON.parse(forecastData);
-      forecastCache.data = forecast;
-      forecastCache.timestamp = Date.now();
-    }
+    const forecast = (await getForecast()).data;
     
     const quantileKey = `p${Math.round(parseFloat(quantile) * 100)}`;
     
@@ -273,6 +344,112 @@ app.post('/api/grid/recommend', (req, res) => {
   });
 });
 
+// Bulk recommendations: the rules above over many scenarios per request.
+// Native kernel (grid_recommend.h via energy_addon.node) when built.
+const GRID_ACTIONS = ['NOMINAL_OPERATION', 'DISCHARGE_BATTERY', 'ACTIVATE_BACKUP', 'CHARGE_BATTERY', 'CURTAIL_GENERATION'];
+const RECOMMEND_COLUMNS = ['solarForecast', 'windForecast', 'demand', 'batteryLevel'];
+
+// Columnar JSON ({ solarForecast: [...], ... }) or application/octet-stream
+// holding the four columns back to back as float64 (native byte order)
+function parseRecommendColumns(body) {
+  const columns = {};
+  if (Buffer.isBuffer(body)) {
+    if (body.length % 32 !== 0) {
+      throw new Error('Binary body must be 4 float64 columns of equal length');
+    }
+    const n = body.length / 32;
+    // Copy into an aligned buffer; a Buffer may start at any pool offset
+    const values = new Float64Array(n * 4);
+    new Uint8Array(values.buffer).set(body);
+    RECOMMEND_COLUMNS.forEach((name, k) => { columns[name] = values.subarray(k * n, (k + 1) * n); });
+    return columns;
+  }
+  for (const name of RECOMMEND_COLUMNS) {
+    if (!body || !Array.isArray(body[name])) {
+      throw new Error(`Missing required column arrays: ${RECOMMEND_COLUMNS.join(', ')}`);
+    }
+    columns[name] = Float64Array.from(body[name], Number);
+    if (columns[name].length !== columns.solarForecast.length) {
+      throw new Error('Columns must have equal length');
+    }
+  }
+  return columns;
+}
+
+// Same rules and packed result layout as grid_recommend.h: action codes
+// padded to 8 bytes, then the deficit and surplus float64 columns
+function recommendBatchJs(columns) {
+  const { solarForecast: solar, windForecast: wind, demand, batteryLevel: battery } = columns;
+  const n = solar.length;
+  const actionBytes = Math.ceil(n / 8) * 8;
+  const buffer = new ArrayBuffer(actionBytes + 16 * n);
+  const action = new Uint8Array(buffer, 0, n);
+  const deficit = new Float64Array(buffer, actionBytes, n);
+  const surplus = new Float64Array(buffer, actionBytes + 8 * n, n);
+  const counts = Object.fromEntries(GRID_ACTIONS.map((name) => [name, 0]));
+
+  for (let i = 0; i < n; i++) {
+    const totalRenewable = solar[i] + wind[i];
+    let code = 0;
+    if (totalRenewable < demand[i] * 0.85) {
+      code = battery[i] > 0.3 ? 1 : 2;
+    } else if (totalRenewable > demand[i] * 1.15) {
+      code = battery[i] < 0.9 ? 3 : 4;
+    }
+    const gap = demand[i] - totalRenewable;
+    action[i] = code;
+    deficit[i] = gap > 0 ? gap : 0;
+    surplus[i] = gap < 0 ? -gap : 0;
+    counts[GRID_ACTIONS[code]]++;
+  }
+  return { action, deficit, surplus, counts, buffer };
+}
+
+app.post('/api/grid/recommend/batch', async (req, res) => {
+  let columns;
+  try {
+    columns = parseRecommendColumns(req.body);
+  } catch (error) {
+    return res.status(400).json({ success: false, error: error.message });
+  }
+
+  try {
+    const rows = columns.solarForecast.length;
+    const result = energyAddon ? await energyAddon.recommend({
+      solar: columns.solarForecast,
+      wind: columns.windForecast,
+      demand: columns.demand,
+      battery: columns.batteryLevel
+    }) : recommendBatchJs(columns);
+
+    if (req.accepts(['json', 'application/octet-stream']) === 'application/octet-stream') {
+      // Packed layout as-is; X-Rows gives the column length
+      res.set('Content-Type', 'application/octet-stream');
+      res.set('X-Rows', String(rows));
+      return res.send(Buffer.from(result.buffer, 0, Math.ceil(rows / 8) * 8 + 16 * rows));
+    }
+
+    res.json({
+      success: true,
+      rows,
+      actions: GRID_ACTIONS,
+      counts: result.counts,
+      columns: {
+        action: Array.from(result.action),
+        deficit: Array.from(result.deficit),
+        surplus: Array.from(result.surplus)
+      }
+    });
+  } catch (error) {
+    console.error('Batch recommendation error:', error);
+    res.status(500).json({
+      success: false,
+      error: 'Failed to evaluate recommendations',
+      message: error.message
+    });
+  }
+});
+
 // System logs endpoint
 app.get('/api/logs', (req, res) => {
   const logs = [
@@ -293,13 +470,12 @@ app.get('/api/stream/state', (req, res) => {
   res.setHeader('Cache-Control', 'no-cache');
   res.setHeader('Connection', 'keep-alive');
   
-  const interval = setInterval(() => {
-    generateRealtimeData();
-    res.write(`data: ${JSON.stringify(currentGridState)}\n\n`);
-  }, 3000);
+  // Fed by the single state tick below; see grid_stream_server.cpp for the
+  // native front end that scales this to tens of thousands of subscribers
+  stateSubscribers.add(res);
   
   req.on('close', () => {
-    clearInterval(interval);
+    stateSubscribers.delete(res);
   });
 });
 
@@ -329,12 +505,23 @@ app.listen(PORT, () => {
   console.log('  GET  /api/forecast/24h');
   console.log('  GET  /api/forecast/quantile/:metric');
   console.log('  POST /api/grid/recommend');
+  console.log('  POST /api/grid/recommend/batch');
   console.log('  GET  /api/logs');
   console.log('  GET  /api/stream/state');
   console.log('========================================');
   
-  // Initialize real-time data generation
-  setInterval(generateRealtimeData, 3000);
+  // Initialize real-time data generation (one state tick for all stream subscribers)
+  setInterval(broadcastGridState, 3000);
+  
+  // Refresh-ahead: keep a hot forecast (requested within the last TTL) warm so
+  // requests never wait on a recompute; cold fills are left to getForecast()
+  setInterval(() => {
+    const now = Date.now();
+    if (!forecastCache.timestamp || !forecastCache.lastRequest) return;
+    if (now - forecastCache.lastRequest >= forecastCache.ttl) return;
+    if (now - forecastCache.timestamp < forecastCache.ttl * forecastCache.refreshAhead) return;
+    refreshForecast().catch((error) => console.error('Forecast refresh error:', error.message));
+  }, forecastCache.ttl * (1 - forecastCache.refreshAhead));
 });
 
 module.exports = app;
\ No newline at end of file
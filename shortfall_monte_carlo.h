@@ -0,0 +1,328 @@
+/**
+ * Shortfall Monte Carlo
+ * Probability of renewable shortfall, backup activation and curtailment per
+ * forecast hour, sampled from the Beta predictive distributions of every site
+ *
+ * Replaces counting the hours in which summed P10/P50/P90 bands fall below
+ * demand (quantile_regression.m), which is not a probability and treats
+ * solar, wind and all sites as perfectly correlated. Each sample path draws
+ * solar and wind for every site and hour from Beta(mu * phi, (1 - mu) * phi),
+ * optionally coupled across sites by a Gaussian copula, and runs the grid
+ * rules of grid_recommend.h hour by hour with the battery carried forward as
+ * in generateRealtimeData(). Estimates come with binomial standard errors.
+ *
+ * Draws use tabulated inverse CDFs (quantile_levels points per site, hour and
+ * target, linear in between) fed by Philox uniforms (counter_rng.h), so every
+ * path is reproducible from (seed, path) whatever the thread count. The first
+ * and last bins are tabulated again at log-spaced levels, halving towards 0
+ * and 1, so the tails carry no more than 2^-SHORTFALL_TAIL_LEVELS / levels of
+ * interpolated mass and exceedance probabilities stay unbiased.
+ */
+
+#ifndef SHORTFALL_MONTE_CARLO_H
+#define SHORTFALL_MONTE_CARLO_H
+
+#include <vector>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <stdexcept>
+#include <algorithm>
+
+#include "forecast_service.h"
+#include "special_functions.h"
+#include "beta_quantile.h"
+#include "weighted_gram.h"
+#include "counter_rng.h"
+#include "grid_recommend.h"
+#include "thread_pool.h"
+
+#if defined(__AVX2__)
+#include <immintrin.h>
+#define SHORTFALL_AVX2 1
+#endif
+
+struct ShortfallConfig {
+    size_t samples;                             // sample paths
+    uint64_t seed;
+    double initial_battery;                     // state of charge at the first hour
+    double battery_rate;                        // charge per unit of (generation - demand) per hour
+    int quantile_levels;                        // inverse-CDF table resolution
+};
+
+const int SHORTFALL_TAIL_LEVELS = 24;           // log-spaced levels per tail bin
+
+inline ShortfallConfig defaultShortfallConfig() {
+    // Battery start and rate as the real-time simulator in server.js
+    ShortfallConfig c = { 100000, 42, 0.82, 0.02, 256 };
+    return c;
+}
+
+// Per forecast hour; a 95% interval is estimate +/- 1.96 standard errors
+struct ShortfallEstimate {
+    size_t samples;
+    std::vector<double> shortfall, shortfall_se;        // generation < demand
+    std::vector<double> backup, backup_se;              // ACTIVATE_BACKUP
+    std::vector<double> curtailment, curtailment_se;    // CURTAIL_GENERATION
+    std::vector<double> expected_deficit;               // E[max(0, demand - generation)]
+};
+
+// Doubles per table row: q[0..levels] at u = k / levels, then the lower and
+// upper tail tables
+inline size_t quantileTableWidth(int levels) {
+    return (size_t)levels + 1 + 2 * (SHORTFALL_TAIL_LEVELS + 1);
+}
+
+// Tail table t[k] at r = 2^-k (k <= SHORTFALL_TAIL_LEVELS), r = distance to
+// the end in units of one bin, in [0, 1]; linear between levels, and to
+// `end` below the last one
+inline double tailQuantile(const double* t, double end, double r) {
+    const double smallest = std::ldexp(1.0, -SHORTFALL_TAIL_LEVELS);
+    if (r >= 1.0) return t[0];
+    if (r < smallest) return end + r / smallest * (t[SHORTFALL_TAIL_LEVELS] - end);
+    int e;
+    double m = std::frexp(r, &e);               // r in [2^-(k + 1), 2^-k) with k = -e
+    int k = -e;
+    return t[k + 1] + (2.0 * m - 1.0) * (t[k] - t[k + 1]);
+}
+
+inline double tabulatedQuantile(const double* q, int levels, double u) {
+    double pos = u * levels;
+    int j = std::min((int)pos, levels - 1);
+    if (j == 0) return tailQuantile(q + levels + 1, 0.0, pos);
+    if (j == levels - 1) return tailQuantile(q + levels + 2 + SHORTFALL_TAIL_LEVELS, 1.0, (1.0 - u) * levels);
+    return q[j] + (pos - j) * (q[j + 1] - q[j]);
+}
+
+// acc[i] += tabulatedQuantile(q, levels, u[i]) for i < n
+inline void accumulateQuantiles(const double* q, int levels, const double* u, double* acc, size_t n) {
+    size_t i = 0;
+#ifdef SHORTFALL_AVX2
+    const __m256d scale = _mm256_set1_pd(levels);
+    const __m128i first = _mm_setzero_si128();
+    const __m128i last = _mm_set1_epi32(levels - 1);
+    const __m256d all = _mm256_castsi256_pd(_mm256_set1_epi64x(-1));
+    const __m256d zero = _mm256_setzero_pd();
+    for (; i + 4 <= n; i += 4) {
+        __m256d pos = _mm256_mul_pd(_mm256_loadu_pd(u + i), scale);
+        __m128i j = _mm_min_epi32(_mm256_cvttpd_epi32(pos), last);
+        // A draw in an end bin sends the group down the scalar tail lookup
+        __m128i ends = _mm_or_si128(_mm_cmpeq_epi32(j, first), _mm_cmpeq_epi32(j, last));
+        if (_mm_movemask_epi8(ends)) {
+            for (size_t k = i; k < i + 4; k++) acc[k] += tabulatedQuantile(q, levels, u[k]);
+            continue;
+        }
+        __m256d lo = _mm256_mask_i32gather_pd(zero, q, j, all, 8);
+        __m256d hi = _mm256_mask_i32gather_pd(zero, q + 1, j, all, 8);
+        __m256d frac = _mm256_sub_pd(pos, _mm256_cvtepi32_pd(j));
+        __m256d value = _mm256_add_pd(lo, _mm256_mul_pd(frac, _mm256_sub_pd(hi, lo)));
+        _mm256_storeu_pd(acc + i, _mm256_add_pd(_mm256_loadu_pd(acc + i), value));
+    }
+#endif
+    for (; i < n; i++) acc[i] += tabulatedQuantile(q, levels, u[i]);
+}
+
+class ShortfallSimulator {
+private:
+    enum { PATHS_PER_BLOCK = 256 };
+
+    std::vector<PredictiveShapes24h> sites;
+    double demand[FORECAST_HOURS];
+    std::vector<double> copula;                 // lower Cholesky factor, empty if independent
+
+    // Per-block sums: shortfall, backup and curtailment counts, deficit
+    enum { SUM_SHORTFALL, SUM_BACKUP, SUM_CURTAIL, SUM_DEFICIT, SUM_COUNT };
+
+    struct Workspace {
+        std::vector<double> draws;              // [target][site][path]
+        std::vector<double> generation[2];      // summed over sites, [path]
+        std::vector<double> demand, battery, deficit, surplus;
+        std::vector<uint8_t> action;
+    };
+
+    // Table row of (target, site, hour)
+    size_t tableRow(int target, size_t site, int hour) const {
+        return ((size_t)target * sites.size() + site) * FORECAST_HOURS + hour;
+    }
+
+    void buildTables(ThreadPool& pool, int levels, std::vector<double>& tables) const {
+        const int T = SHORTFALL_TAIL_LEVELS;
+        size_t rows = 2 * sites.size() * FORECAST_HOURS;
+        size_t width = quantileTableWidth(levels);
+        // One ascending solve per row: lower tail 2^-T / levels .. 2^-1 / levels,
+        // the grid 1 / levels .. (levels - 1) / levels, then the upper tail
+        std::vector<double> probabilities;
+        for (int k = T; k >= 1; k--) probabilities.push_back(std::ldexp(1.0, -k) / levels);
+        for (int k = 1; k < levels; k++) probabilities.push_back((double)k / levels);
+        for (int k = 1; k <= T; k++) probabilities.push_back(1.0 - std::ldexp(1.0, -k) / levels);
+        tables.assign(rows * width, 0.0);
+        pool.parallelFor(rows, 16, [&](size_t begin, size_t end, size_t) {
+            std::vector<double> solved(probabilities.size());
+            for (size_t r = begin; r < end; r++) {
+                size_t hour = r % FORECAST_HOURS, site = (r / FORECAST_HOURS) % sites.size();
+                int target = (int)(r / (FORECAST_HOURS * sites.size()));
+                betaQuantiles(&sites[site].alpha[target][hour], &sites[site].beta[target][hour], 1,
+                              &probabilities[0], probabilities.size(), &solved[0]);
+                double* q = &tables[r * width];
+                double* lower = q + levels + 1;
+                double* upper = lower + T + 1;
+                q[0] = 0.0;
+                q[levels] = 1.0;
+                std::copy(&solved[T], &solved[T] + (levels - 1), q + 1);
+                for (int k = 0; k <= T; k++) {
+                    lower[k] = k == 0 ? q[1] : solved[T - k];
+                    upper[k] = k == 0 ? q[levels - 1] : solved[T + levels - 2 + k];
+                }
+            }
+        });
+    }
+
+    // Paths [first, first + n) of block `block`; sums is SUM_COUNT x FORECAST_HOURS
+    void simulateBlock(const ShortfallConfig& config, const std::vector<double>& tables, size_t block,
+                       size_t n, Workspace& w, double* sums) const {
+        const CounterRng rng(config.seed);
+        size_t n_sites = sites.size();
+        size_t width = quantileTableWidth(config.quantile_levels);
+        w.draws.resize(2 * n_sites * n);
+        for (int t = 0; t < 2; t++) w.generation[t].resize(n);
+        w.demand.resize(n);
+        w.deficit.resize(n);
+        w.surplus.resize(n);
+        w.action.resize(n);
+        w.battery.assign(n, config.initial_battery);
+
+        for (int h = 0; h < FORECAST_HOURS; h++) {
+            uint64_t stream = (uint64_t)block * FORECAST_HOURS + h;
+            if (copula.empty()) {
+                rng.uniforms(stream, 0, &w.draws[0], w.draws.size());
+            } else {
+                // Correlate the normals across sites (in place, last site first),
+                // then map back to uniforms
+                rng.normals(stream, 0, &w.draws[0], w.draws.size());
+                for (int t = 0; t < 2; t++) {
+                    double* z = &w.draws[(size_t)t * n_sites * n];
+                    for (size_t s = n_sites; s-- > 0;) {
+                        double* zs = z + s * n;
+                        double diagonal = copula[s * n_sites + s];
+                        for (size_t p = 0; p < n; p++) zs[p] *= diagonal;
+                        for (size_t k = 0; k < s; k++) {
+                            double l = copula[s * n_sites + k];
+                            const double* zk = z + k * n;
+                            for (size_t p = 0; p < n; p++) zs[p] += l * zk[p];
+                        }
+                        normalCdfArray(zs, zs, n);
+                    }
+                }
+            }
+
+            for (int t = 0; t < 2; t++) {
+                std::fill(w.generation[t].begin(), w.generation[t].end(), 0.0);
+                for (size_t s = 0; s < n_sites; s++) {
+                    accumulateQuantiles(&tables[tableRow(t, s, h) * width], config.quantile_levels,
+                                        &w.draws[((size_t)t * n_sites + s) * n], &w.generation[t][0], n);
+                }
+                double mean = 1.0 / n_sites;
+                for (size_t p = 0; p < n; p++) w.generation[t][p] *= mean;
+            }
+
+            std::fill(w.demand.begin(), w.demand.end(), demand[h]);
+            RecommendationInputs in = { &w.generation[0][0], &w.generation[1][0], &w.demand[0],
+                                        &w.battery[0], n };
+            recommendRange(in, 0, n, &w.action[0], &w.deficit[0], &w.surplus[0]);
+
+            double shortfall = 0.0, backup = 0.0, curtail = 0.0, deficit = 0.0;
+            for (size_t p = 0; p < n; p++) {
+                shortfall += w.deficit[p] > 0.0;
+                backup += w.action[p] == ACTION_ACTIVATE_BACKUP;
+                curtail += w.action[p] == ACTION_CURTAIL_GENERATION;
+                deficit += w.deficit[p];
+                double level = w.battery[p] + (w.surplus[p] - w.deficit[p]) * config.battery_rate;
+                w.battery[p] = std::min(1.0, std::max(0.0, level));
+            }
+            sums[SUM_SHORTFALL * FORECAST_HOURS + h] = shortfall;
+            sums[SUM_BACKUP * FORECAST_HOURS + h] = backup;
+            sums[SUM_CURTAIL * FORECAST_HOURS + h] = curtail;
+            sums[SUM_DEFICIT * FORECAST_HOURS + h] = deficit;
+        }
+    }
+
+public:
+    // demand: per forecast hour, in units of one site's solar + wind capacity
+    // factor (generation is averaged over sites, as grid_load in GridState)
+    ShortfallSimulator(const std::vector<PredictiveShapes24h>& site_shapes, const double* hourly_demand)
+        : sites(site_shapes) {
+        if (sites.empty()) {
+            throw std::invalid_argument("ShortfallSimulator: no sites");
+        }
+        std::copy(hourly_demand, hourly_demand + FORECAST_HOURS, demand);
+    }
+
+    size_t siteCount() const { return sites.size(); }
+
+    // Gaussian copula with the given site correlation matrix (row-major,
+    // sites x sites); an empty matrix makes sites independent again
+    void setCorrelation(const std::vector<double>& correlation) {
+        size_t n = sites.size();
+        if (correlation.empty()) {
+            copula.clear();
+            return;
+        }
+        if (correlation.size() != n * n) {
+            throw std::invalid_argument("ShortfallSimulator::setCorrelation: matrix must be sites x sites");
+        }
+        std::vector<double> factor(correlation);
+        if (!choleskyDecompose(factor, n)) {
+            throw std::invalid_argument("ShortfallSimulator::setCorrelation: matrix is not positive definite");
+        }
+        for (size_t i = 0; i < n; i++) {
+            for (size_t j = i + 1; j < n; j++) factor[i * n + j] = 0.0;
+        }
+        copula.swap(factor);
+    }
+
+    ShortfallEstimate run(ThreadPool& pool, const ShortfallConfig& config) const {
+        if (config.samples == 0 || config.quantile_levels < 2) {
+            throw std::invalid_argument("ShortfallSimulator::run: need samples and at least 2 quantile levels");
+        }
+        std::vector<double> tables;
+        buildTables(pool, config.quantile_levels, tables);
+
+        size_t n_blocks = (config.samples + PATHS_PER_BLOCK - 1) / PATHS_PER_BLOCK;
+        std::vector<double> sums(n_blocks * SUM_COUNT * FORECAST_HOURS);
+        std::vector<Workspace> workspaces(pool.size());
+        pool.parallelFor(n_blocks, 1, [&](size_t begin, size_t end, size_t worker) {
+            for (size_t b = begin; b < end; b++) {
+                size_t n = std::min((size_t)PATHS_PER_BLOCK, config.samples - b * PATHS_PER_BLOCK);
+                simulateBlock(config, tables, b, n, workspaces[worker], &sums[b * SUM_COUNT * FORECAST_HOURS]);
+            }
+        });
+
+        // Reduce in block order so the estimate is independent of scheduling
+        std::vector<double> total(SUM_COUNT * FORECAST_HOURS, 0.0);
+        for (size_t b = 0; b < n_blocks; b++) {
+            for (size_t k = 0; k < total.size(); k++) total[k] += sums[b * total.size() + k];
+        }
+
+        ShortfallEstimate e;
+        e.samples = config.samples;
+        double n = (double)config.samples;
+        std::vector<double>* estimates[3] = { &e.shortfall, &e.backup, &e.curtailment };
+        std::vector<double>* errors[3] = { &e.shortfall_se, &e.backup_se, &e.curtailment_se };
+        for (int k = 0; k < 3; k++) {
+            estimates[k]->resize(FORECAST_HOURS);
+            errors[k]->resize(FORECAST_HOURS);
+            for (int h = 0; h < FORECAST_HOURS; h++) {
+                double p = total[k * FORECAST_HOURS + h] / n;
+                (*estimates[k])[h] = p;
+                (*errors[k])[h] = std::sqrt(p * (1.0 - p) / n);
+            }
+        }
+        e.expected_deficit.resize(FORECAST_HOURS);
+        for (int h = 0; h < FORECAST_HOURS; h++) {
+            e.expected_deficit[h] = total[SUM_DEFICIT * FORECAST_HOURS + h] / n;
+        }
+        return e;
+    }
+};
+
+#endif
@@ -0,0 +1,173 @@
+/**
+ * Thread Pool
+ * Fixed set of worker threads shared by the native batch engines
+ * Tasks receive the index of the worker running them for per-worker workspaces
+ */
+
+#ifndef THREAD_POOL_H
+#define THREAD_POOL_H
+
+#include <vector>
+#include <deque>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <functional>
+#include <atomic>
+#include <exception>
+#include <memory>
+#include <algorithm>
+#include <cstddef>
+
+class ThreadPool {
+private:
+    std::vector<std::thread> workers;
+    std::deque<std::function<void(size_t)>> tasks;
+    std::mutex mutex;
+    std::condition_variable task_ready;
+    std::condition_variable all_done;
+    size_t pending;
+    bool stopping;
+    std::exception_ptr first_error;
+
+    // Shared by the tasks of one parallelFor call
+    struct LoopState {
+        std::atomic<size_t> next;
+        size_t n;
+        size_t running;
+        std::mutex mutex;
+        std::condition_variable done;
+        std::exception_ptr error;
+        explicit LoopState(size_t count) : next(0), n(count), running(0) {}
+    };
+
+    // Pool and worker index of the calling thread, if it is a pool worker
+    static ThreadPool*& currentPool() {
+        static thread_local ThreadPool* pool = 0;
+        return pool;
+    }
+
+    static size_t& currentIndex() {
+        static thread_local size_t index = 0;
+        return index;
+    }
+
+    size_t currentWorker() const {
+        return currentPool() == this ? currentIndex() : workers.size();
+    }
+
+    static void runChunks(LoopState& state, size_t chunk,
+                          const std::function<void(size_t, size_t, size_t)>& body, size_t worker) {
+        {
+            std::lock_guard<std::mutex> lock(state.mutex);
+            state.running++;
+        }
+        try {
+            for (;;) {
+                size_t begin = state.next.fetch_add(chunk);
+                if (begin >= state.n) break;
+                body(begin, std::min(state.n, begin + chunk), worker);
+            }
+        } catch (...) {
+            state.next = state.n;
+            std::lock_guard<std::mutex> lock(state.mutex);
+            if (!state.error) state.error = std::current_exception();
+        }
+        std::lock_guard<std::mutex> lock(state.mutex);
+        if (--state.running == 0) state.done.notify_all();
+    }
+
+    void workerLoop(size_t worker) {
+        currentPool() = this;
+        currentIndex() = worker;
+        for (;;) {
+            std::function<void(size_t)> task;
+            {
+                std::unique_lock<std::mutex> lock(mutex);
+                task_ready.wait(lock, [this] { return stopping || !tasks.empty(); });
+                if (tasks.empty()) return;
+                task = std::move(tasks.front());
+                tasks.pop_front();
+            }
+
+            try {
+                task(worker);
+            } catch (...) {
+                std::lock_guard<std::mutex> lock(mutex);
+                if (!first_error) first_error = std::current_exception();
+            }
+
+            std::lock_guard<std::mutex> lock(mutex);
+            if (--pending == 0) all_done.notify_all();
+        }
+    }
+
+public:
+    // n_threads = 0 uses every hardware thread
+    explicit ThreadPool(size_t n_threads = 0) : pending(0), stopping(false) {
+        if (n_threads == 0) n_threads = std::max(1u, std::thread::hardware_concurrency());
+        for (size_t i = 0; i < n_threads; i++) {
+            workers.push_back(std::thread(&ThreadPool::workerLoop, this, i));
+        }
+    }
+
+    ~ThreadPool() {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            stopping = true;
+        }
+        task_ready.notify_all();
+        for (size_t i = 0; i < workers.size(); i++) workers[i].join();
+    }
+
+    size_t size() const { return workers.size(); }
+
+    void submit(std::function<void(size_t)> task) {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            tasks.push_back(std::move(task));
+            pending++;
+        }
+        task_ready.notify_one();
+    }
+
+    // Block until every submitted task has finished; rethrows the first task
+    // error. Waits for the whole pool, so never call it from a pool task.
+    void wait() {
+        std::unique_lock<std::mutex> lock(mutex);
+        all_done.wait(lock, [this] { return pending == 0; });
+        if (first_error) {
+            std::exception_ptr error = first_error;
+            first_error = std::exception_ptr();
+            std::rethrow_exception(error);
+        }
+    }
+
+    // Run body(begin, end, worker) over [0, n) in chunks claimed dynamically.
+    // Completion is tracked per call, so other work on the pool does not
+    // delay it. Called from one of this pool's workers (a nested loop), the
+    // caller claims chunks itself under its own worker index, so the call
+    // finishes even when every other worker is busy. The first error stops
+    // further chunks and is rethrown here.
+    void parallelFor(size_t n, size_t chunk,
+                     const std::function<void(size_t, size_t, size_t)>& body) {
+        if (n == 0) return;
+        if (chunk == 0) chunk = 1;
+        std::shared_ptr<LoopState> state(new LoopState(n));
+        size_t n_chunks = (n + chunk - 1) / chunk;
+        size_t self = currentWorker();
+        bool nested = self < workers.size();
+        size_t n_tasks = std::min(workers.size(), n_chunks);
+        if (nested) n_tasks = std::min(workers.size() - 1, n_chunks - 1);
+        for (size_t t = 0; t < n_tasks; t++) {
+            submit([state, chunk, &body](size_t worker) { runChunks(*state, chunk, body, worker); });
+        }
+        if (nested) runChunks(*state, chunk, body, self);
+
+        std::unique_lock<std::mutex> lock(state->mutex);
+        state->done.wait(lock, [&state] { return state->running == 0 && state->next >= state->n; });
+        if (state->error) std::rethrow_exception(state->error);
+    }
+};
+
+#endif
@@ -0,0 +1,135 @@
+/**
+ * Multi-Site Training Scheduler
+ * Fits Beta regression models for many (site, target) pairs on a thread pool
+ * Each worker owns its fitting workspace; fits warm-start from the last run
+ */
+
+#ifndef TRAINING_SCHEDULER_H
+#define TRAINING_SCHEDULER_H
+
+#include <vector>
+#include <map>
+#include <utility>
+#include <chrono>
+#include <cstddef>
+
+#include "thread_pool.h"
+#include "beta_regression.h"
+
+enum ForecastTarget {
+    TARGET_SOLAR = 0,
+    TARGET_WIND = 1
+};
+
+// One model to fit: row-major X (n x p) and response y, owned by the caller
+struct TrainingJob {
+    int site_id;
+    int target;
+    const double* X;
+    const double* y;
+    size_t n;
+    size_t p;
+};
+
+struct FitResult {
+    int site_id;
+    int target;
+    std::vector<double> coefficients;
+    double phi;
+    double loglik;
+    int iterations;
+    bool converged;
+    bool warm_started;
+    double fit_ms;
+};
+
+struct TrainingStats {
+    size_t fits;
+    size_t converged;
+    size_t warm_started;
+    double wall_seconds;
+    double fits_per_second;
+    double mean_iterations;
+};
+
+class TrainingScheduler {
+private:
+    ThreadPool pool;
+    std::vector<BetaRegression> workspaces;
+    std::map<std::pair<int, int>, std::pair<std::vector<double>, double> > previous;
+    bool warm_start;
+
+public:
+    explicit TrainingScheduler(size_t n_threads = 0, bool use_warm_start = true)
+        : pool(n_threads), workspaces(pool.size()), warm_start(use_warm_start) {}
+
+    size_t threadCount() const { return pool.size(); }
+
+    // Seed warm-start parameters, e.g. yesterday's coefficients loaded from disk
+    void setPreviousParameters(int site_id, int target,
+                               const std::vector<double>& coefficients, double phi) {
+        previous[std::make_pair(site_id, target)] = std::make_pair(coefficients, phi);
+    }
+
+    // Fit every job concurrently; results are returned in job order
+    std::vector<FitResult> run(const std::vector<TrainingJob>& jobs, TrainingStats* stats = 0) {
+        std::vector<FitResult> results(jobs.size());
+        auto wall_start = std::chrono::steady_clock::now();
+
+        pool.parallelFor(jobs.size(), 1, [&](size_t begin, size_t end, size_t worker) {
+            BetaRegression& model = workspaces[worker];
+            for (size_t j = begin; j < end; j++) {
+                const TrainingJob& job = jobs[j];
+                FitResult& r = results[j];
+                auto start = std::chrono::steady_clock::now();
+
+                r.warm_started = false;
+                if (warm_start) {
+                    auto it = previous.find(std::make_pair(job.site_id, job.target));
+                    if (it != previous.end() && it->second.first.size() == job.p) {
+                        model.setParameters(it->second.first, it->second.second);
+                        r.warm_started = true;
+                    }
+                }
+
+                model.fit(job.X, job.y, job.n, job.p, r.warm_started);
+
+                r.site_id = job.site_id;
+                r.target = job.target;
+                r.coefficients = model.getCoefficients();
+                r.phi = model.getPhi();
+                r.loglik = model.getLogLikelihood();
+                r.iterations = model.getIterations();
+                r.converged = model.hasConverged();
+                r.fit_ms = std::chrono::duration<double, std::milli>(
+                    std::chrono::steady_clock::now() - start).count();
+            }
+        });
+
+        // Remember this run's parameters for the next warm start
+        for (size_t j = 0; j < results.size(); j++) {
+            const FitResult& r = results[j];
+            previous[std::make_pair(r.site_id, r.target)] = std::make_pair(r.coefficients, r.phi);
+        }
+
+        if (stats) {
+            double wall = std::chrono::duration<double>(std::chrono::steady_clock::now() - wall_start).count();
+            stats->fits = results.size();
+            stats->converged = 0;
+            stats->warm_started = 0;
+            double total_iterations = 0.0;
+            for (size_t j = 0; j < results.size(); j++) {
+                if (results[j].converged) stats->converged++;
+                if (results[j].warm_started) stats->warm_started++;
+                total_iterations += results[j].iterations;
+            }
+            stats->wall_seconds = wall;
+            stats->fits_per_second = wall > 0.0 ? results.size() / wall : 0.0;
+            stats->mean_iterations = results.empty() ? 0.0 : total_iterations / results.size();
+        }
+
+        return results;
+    }
+};
+
+#endif
@@ -0,0 +1,308 @@
+/**
+ * Weighted Gram Kernel
+ * X' W X and X' v accumulation for tall, skinny row-major X (W diagonal)
+ * plus the small Cholesky solver used by every regression's normal equations
+ *
+ * X is streamed through a cache-resident tile that is transposed once, so each
+ * Gram entry is a contiguous dot product over the tile (AVX2+FMA when
+ * available). Only the lower triangle is computed; several weight vectors can
+ * be applied to one loaded tile, and parallelWeightedGram splits rows across
+ * a ThreadPool with a fixed partition so results do not depend on scheduling.
+ * accumulateWeightedGram picks between the two for the regressions' fits.
+ */
+
+#ifndef WEIGHTED_GRAM_H
+#define WEIGHTED_GRAM_H
+
+#include <vector>
+#include <cmath>
+#include <cstring>
+#include <cstddef>
+#include <algorithm>
+
+#include "aligned_buffer.h"
+#include "thread_pool.h"
+
+#if defined(__AVX2__) && defined(__FMA__)
+#include <immintrin.h>
+#define WEIGHTED_GRAM_AVX2 1
+#endif
+
+const size_t SMALL_CHOLESKY_MAX = 64;
+
+// Smallest row range parallelWeightedGram hands to one task
+const size_t PARALLEL_GRAM_CHUNK_ROWS = 4096;
+
+// In-place Cholesky of a symmetric positive-definite m x m matrix (row-major,
+// only the lower triangle is read); returns false if not positive definite
+inline bool choleskyDecompose(double* A, size_t m) {
+    for (size_t j = 0; j < m; j++) {
+        double* row_j = A + j * m;
+        double d = row_j[j];
+        for (size_t k = 0; k < j; k++) d -= row_j[k] * row_j[k];
+        if (d <= 0.0) return false;
+        d = std::sqrt(d);
+        row_j[j] = d;
+        for (size_t i = j + 1; i < m; i++) {
+            double* row_i = A + i * m;
+            double s = row_i[j];
+            for (size_t k = 0; k < j; k++) s -= row_i[k] * row_j[k];
+            row_i[j] = s / d;
+        }
+    }
+    return true;
+}
+
+inline bool choleskyDecompose(std::vector<double>& A, size_t m) {
+    return choleskyDecompose(&A[0], m);
+}
+
+// Solve L L' x = b given the factor from choleskyDecompose (b overwritten with x)
+inline void choleskySolve(const double* L, size_t m, double* b) {
+    for (size_t i = 0; i < m; i++) {
+        double s = b[i];
+        for (size_t k = 0; k < i; k++) s -= L[i * m + k] * b[k];
+        b[i] = s / L[i * m + i];
+    }
+    for (size_t i = m; i-- > 0;) {
+        double s = b[i];
+        for (size_t k = i + 1; k < m; k++) s -= L[k * m + i] * b[k];
+        b[i] = s / L[i * m + i];
+    }
+}
+
+inline void choleskySolve(const std::vector<double>& L, size_t m, std::vector<double>& b) {
+    choleskySolve(&L[0], m, &b[0]);
+}
+
+// Cholesky that adds a growing ridge to the diagonal until the factorization
+// succeeds (rank-deficient designs, degenerate IRLS weights). Returns the ridge used.
+inline double choleskyDecomposeRegularized(double* A, size_t m) {
+    double stack_copy[SMALL_CHOLESKY_MAX * SMALL_CHOLESKY_MAX];
+    std::vector<double> heap_copy;
+    double* saved = stack_copy;
+    if (m > SMALL_CHOLESKY_MAX) {
+        heap_copy.resize(m * m);
+        saved = &heap_copy[0];
+    }
+    std::memcpy(saved, A, m * m * sizeof(double));
+
+    double trace = 0.0;
+    for (size_t j = 0; j < m; j++) trace += A[j * m + j];
+    double ridge = 0.0;
+    double next = 1e-12 * std::max(trace / m, 1e-300);
+    while (!choleskyDecompose(A, m)) {
+        std::memcpy(A, saved, m * m * sizeof(double));
+        ridge = next;
+        for (size_t j = 0; j < m; j++) A[j * m + j] += ridge;
+        next *= 100.0;
+    }
+    return ridge;
+}
+
+// Copy the lower triangle of G (leading dimension ldg) to the upper triangle
+inline void symmetrizeLower(double* G, size_t p, size_t ldg) {
+    for (size_t j = 0; j < p; j++) {
+        for (size_t k = 0; k < j; k++) G[k * ldg + j] = G[j * ldg + k];
+    }
+}
+
+class WeightedGram {
+private:
+    size_t p;
+    size_t capacity;      // tile rows, a multiple of 4
+    size_t rows;          // rows in the loaded tile
+    AlignedBuffer<double> xt, wxt, padded;   // p x capacity (column-major tile)
+
+#ifdef WEIGHTED_GRAM_AVX2
+    static double horizontalSum(__m256d v) {
+        __m128d lo = _mm256_castpd256_pd128(v);
+        __m128d hi = _mm256_extractf128_pd(v, 1);
+        lo = _mm_add_pd(lo, hi);
+        return _mm_cvtsd_f64(_mm_add_sd(lo, _mm_unpackhi_pd(lo, lo)));
+    }
+#endif
+
+    // out[c] += sum_i a[i] * b_c[i] for four columns b_c = b + c * capacity
+    void dot4(const double* a, const double* b, double* out) const {
+#ifdef WEIGHTED_GRAM_AVX2
+        __m256d s0 = _mm256_setzero_pd(), s1 = _mm256_setzero_pd();
+        __m256d s2 = _mm256_setzero_pd(), s3 = _mm256_setzero_pd();
+        const double* b1 = b + capacity;
+        const double* b2 = b1 + capacity;
+        const double* b3 = b2 + capacity;
+        for (size_t i = 0; i < capacity; i += 4) {
+            __m256d av = _mm256_load_pd(a + i);
+            s0 = _mm256_fmadd_pd(av, _mm256_load_pd(b + i), s0);
+            s1 = _mm256_fmadd_pd(av, _mm256_load_pd(b1 + i), s1);
+            s2 = _mm256_fmadd_pd(av, _mm256_load_pd(b2 + i), s2);
+            s3 = _mm256_fmadd_pd(av, _mm256_load_pd(b3 + i), s3);
+        }
+        out[0] += horizontalSum(s0);
+        out[1] += horizontalSum(s1);
+        out[2] += horizontalSum(s2);
+        out[3] += horizontalSum(s3);
+#else
+        for (size_t c = 0; c < 4; c++) out[c] += dot(a, b + c * capacity);
+#endif
+    }
+
+    double dot(const double* a, const double* b) const {
+#ifdef WEIGHTED_GRAM_AVX2
+        __m256d s0 = _mm256_setzero_pd(), s1 = _mm256_setzero_pd();
+        for (size_t i = 0; i < capacity; i += 8) {
+            s0 = _mm256_fmadd_pd(_mm256_load_pd(a + i), _mm256_load_pd(b + i), s0);
+            s1 = _mm256_fmadd_pd(_mm256_load_pd(a + i + 4), _mm256_load_pd(b + i + 4), s1);
+        }
+        return horizontalSum(_mm256_add_pd(s0, s1));
+#else
+        double s0 = 0.0, s1 = 0.0, s2 = 0.0, s3 = 0.0;
+        for (size_t i = 0; i < capacity; i += 4) {
+            s0 += a[i] * b[i];
+            s1 += a[i + 1] * b[i + 1];
+            s2 += a[i + 2] * b[i + 2];
+            s3 += a[i + 3] * b[i + 3];
+        }
+        return (s0 + s1) + (s2 + s3);
+#endif
+    }
+
+public:
+    explicit WeightedGram(size_t n_features = 0) : p(0), capacity(0), rows(0) {
+        if (n_features > 0) reset(n_features);
+    }
+
+    // Size the tile for p features: about 16 KB per transposed copy
+    void reset(size_t n_features) {
+        if (n_features == p && capacity > 0) return;
+        p = n_features;
+        capacity = std::max<size_t>(8, (2048 / std::max<size_t>(p, 1)) & ~size_t(7));
+        xt.resize(p * capacity);
+        wxt.resize(p * capacity);
+        padded.resize(capacity);
+        rows = 0;
+    }
+
+    size_t features() const { return p; }
+    size_t tileRows() const { return capacity; }
+
+    // Load rows (<= tileRows()) of row-major X into the transposed tile
+    void loadTile(const double* X, size_t n_rows) {
+        rows = n_rows;
+        for (size_t j = 0; j < p; j++) {
+            double* col = xt.data() + j * capacity;
+            for (size_t i = 0; i < n_rows; i++) col[i] = X[i * p + j];
+            for (size_t i = n_rows; i < capacity; i++) col[i] = 0.0;
+        }
+    }
+
+    // G += X_tile' diag(w) X_tile (lower triangle, leading dimension ldg) and
+    // products[t * p + j] += sum_i vectors[t][i] * X_tile(i, j); w and each
+    // vector hold one value per tile row. w = 0 means unit weights.
+    void accumulateTile(const double* w, const double* const* vectors, size_t n_vectors,
+                        double* G, size_t ldg, double* products) {
+        const double* weighted = xt.data();
+        if (w) {
+            for (size_t j = 0; j < p; j++) {
+                const double* col = xt.data() + j * capacity;
+                double* dst = wxt.data() + j * capacity;
+                for (size_t i = 0; i < rows; i++) dst[i] = w[i] * col[i];
+                for (size_t i = rows; i < capacity; i++) dst[i] = 0.0;
+            }
+            weighted = wxt.data();
+        }
+
+        if (G) {
+            for (size_t j = 0; j < p; j++) {
+                const double* a = weighted + j * capacity;
+                double* g_row = G + j * ldg;
+                size_t k = 0;
+                for (; k + 4 <= j + 1; k += 4) dot4(a, xt.data() + k * capacity, g_row + k);
+                for (; k <= j; k++) g_row[k] += dot(a, xt.data() + k * capacity);
+            }
+        }
+
+        for (size_t t = 0; t < n_vectors; t++) {
+            std::memcpy(padded.data(), vectors[t], rows * sizeof(double));
+            for (size_t i = rows; i < capacity; i++) padded[i] = 0.0;
+            double* out = products + t * p;
+            for (size_t j = 0; j < p; j++) out[j] += dot(padded.data(), xt.data() + j * capacity);
+        }
+    }
+
+    // Stream all n rows of X through the tile (same outputs as accumulateTile)
+    void accumulate(const double* X, size_t n, const double* w,
+                    const double* const* vectors, size_t n_vectors,
+                    double* G, size_t ldg, double* products) {
+        std::vector<const double*> offsets(n_vectors);
+        for (size_t start = 0; start < n; start += capacity) {
+            size_t len = std::min(capacity, n - start);
+            loadTile(X + start * p, len);
+            for (size_t t = 0; t < n_vectors; t++) offsets[t] = vectors[t] + start;
+            accumulateTile(w ? w + start : 0, n_vectors ? &offsets[0] : 0, n_vectors,
+                           G, ldg, products);
+        }
+    }
+};
+
+// G = X' diag(w) X (full symmetric, p x p) and products = X' v_t over all n rows,
+// split across the pool in fixed row ranges reduced in order (deterministic)
+inline void parallelWeightedGram(ThreadPool& pool, const double* X, size_t n, size_t p,
+                                 const double* w, const double* const* vectors, size_t n_vectors,
+                                 double* G, double* products) {
+    size_t chunks = std::max<size_t>(1, std::min(pool.size() * 4, n / PARALLEL_GRAM_CHUNK_ROWS));
+    size_t chunk_rows = (n + chunks - 1) / chunks;
+    size_t stride = p * p + n_vectors * p;
+    std::vector<double> partial(chunks * stride, 0.0);
+
+    pool.parallelFor(chunks, 1, [&](size_t begin, size_t end, size_t) {
+        WeightedGram kernel(p);
+        for (size_t c = begin; c < end; c++) {
+            size_t lo = c * chunk_rows;
+            size_t hi = std::min(n, lo + chunk_rows);
+            if (lo >= hi) continue;
+            std::vector<const double*> offsets(n_vectors);
+            for (size_t t = 0; t < n_vectors; t++) offsets[t] = vectors[t] + lo;
+            double* out = &partial[c * stride];
+            kernel.accumulate(X + lo * p, hi - lo, w ? w + lo : 0,
+                              n_vectors ? &offsets[0] : 0, n_vectors, out, p, out + p * p);
+        }
+    });
+
+    std::fill(G, G + p * p, 0.0);
+    std::fill(products, products + n_vectors * p, 0.0);
+    for (size_t c = 0; c < chunks; c++) {
+        const double* out = &partial[c * stride];
+        for (size_t j = 0; j < p * p; j++) G[j] += out[j];
+        for (size_t j = 0; j < n_vectors * p; j++) products[j] += out[p * p + j];
+    }
+    symmetrizeLower(G, p, p);
+}
+
+// True when a pass over n rows is worth splitting across pool (may be null)
+inline bool splitsWeightedGram(const ThreadPool* pool, size_t n) {
+    return pool && pool->size() > 1 && n >= 2 * PARALLEL_GRAM_CHUNK_ROWS;
+}
+
+// kernel.accumulate(X, n, w, vectors, n_vectors, G, ldg, products), run as
+// parallelWeightedGram when splitsWeightedGram(pool, n). Both paths add into
+// G (lower triangle; may be null) and products.
+inline void accumulateWeightedGram(ThreadPool* pool, WeightedGram& kernel, const double* X, size_t n,
+                                   const double* w, const double* const* vectors, size_t n_vectors,
+                                   double* G, size_t ldg, double* products, std::vector<double>& scratch) {
+    if (!splitsWeightedGram(pool, n)) {
+        kernel.accumulate(X, n, w, vectors, n_vectors, G, ldg, products);
+        return;
+    }
+    size_t p = kernel.features();
+    scratch.resize(p * p + n_vectors * p);
+    parallelWeightedGram(*pool, X, n, p, w, vectors, n_vectors, &scratch[0], &scratch[p * p]);
+    if (G) {
+        for (size_t j = 0; j < p; j++) {
+            for (size_t k = 0; k <= j; k++) G[j * ldg + k] += scratch[j * p + k];
+        }
+    }
+    for (size_t j = 0; j < n_vectors * p; j++) products[j] += scratch[p * p + j];
+}
+
+#endif